@@ -0,0 +1,571 @@
+
+#ifndef AGG_TEST_H
+#define AGG_TEST_H
+
+#include "MyDB_AttType.h"
+#include "MyDB_BufferManager.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_Record.h"
+#include "MyDB_Table.h"
+#include "MyDB_TableReaderWriter.h"
+#include "MyDB_Schema.h"
+#include "KeyHash.h"
+#include "QUnit.h"
+#include "Aggregate.h"
+#include "GroupTable.h"
+#include "HyperLogLog.h"
+#include "OrderedAggregate.h"
+#include "ParallelAggregate.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Each of the tests below runs one of the aggregations, usually with a buffer pool that is small enough
+// that the groups do not all fit, and then checks its output against aggregates that are computed with a
+// std::map over the generated records, so that nothing in the check is shared with the code being tested.
+
+// one of the records in a test table
+struct TestRec {
+	int key;
+	int val;
+	string name;
+};
+
+// writes a text file for a table with four atts: a key (from 0 up to numKeys - 1), a value (from 0 up
+// to 999), a name (one of numNames), and some padding so that there are not too many records on a page.
+// If skewEvery is not zero, every skewEvery'th record gets the key 7, and if sorted is true, the records
+// are written in order of their keys.  Returns the records, so that the aggregates can be checked
+vector <TestRec> makeTable (string fileName, int numRecs, int numKeys, int numNames, int skewEvery, bool sorted,
+	int seed) {
+
+	srand (seed);
+	vector <TestRec> allRecs;
+	for (int i = 0; i < numRecs; i++) {
+		TestRec rec;
+		rec.key = (skewEvery != 0 && i % skewEvery == 0) ? 7 : rand () % numKeys;
+		rec.val = rand () % 1000;
+		rec.name = "name" + to_string (rand () % numNames);
+		allRecs.push_back (rec);
+	}
+
+	if (sorted)
+		stable_sort (allRecs.begin (), allRecs.end (), [] (const TestRec &lhs, const TestRec &rhs) {
+			return lhs.key < rhs.key;
+		});
+
+	ofstream out (fileName);
+	for (TestRec &rec : allRecs)
+		out << rec.key << "|" << rec.val << "|" << rec.name << "|padding" << string (40, 'x') << "|\n";
+	return allRecs;
+}
+
+// the schema for a table made by makeTable
+MyDB_SchemaPtr getInputSchema () {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair ("a_key", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("a_val", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("a_name", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair ("a_pad", make_shared <MyDB_StringAttType> ()));
+	return mySchema;
+}
+
+// loads up a table from a text file made by makeTable
+MyDB_TableReaderWriterPtr loadTable (string name, string fileName, MyDB_BufferManagerPtr myMgr) {
+	MyDB_TableReaderWriterPtr myTable = make_shared <MyDB_TableReaderWriter> (
+		make_shared <MyDB_Table> (name, name + ".bin", getInputSchema ()), myMgr);
+	myTable->loadFromTextFile (fileName);
+	return myTable;
+}
+
+// makes an empty table to hold the output of one of the aggregations, with atts of the given types
+MyDB_TableReaderWriterPtr makeOutputTable (string name, vector <MyDB_AttTypePtr> types, MyDB_BufferManagerPtr myMgr) {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	for (size_t i = 0; i < types.size (); i++)
+		mySchema->appendAtt (make_pair ("o_" + to_string (i), types[i]));
+	return make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (name, name + ".bin", mySchema), myMgr);
+}
+
+// computes the SUM, AVG, and COUNT of the values for each key, over the records that are accepted
+map <int, vector <double>> getExpected (vector <TestRec> &allRecs, function <bool (TestRec &)> accept) {
+	map <int, vector <double>> groups;
+	for (TestRec &rec : allRecs) {
+		if (!accept (rec))
+			continue;
+		vector <double> &aggs = groups[rec.key];
+		aggs.resize (3);
+		aggs[0] += rec.val;
+		aggs[2]++;
+	}
+	for (auto &p : groups)
+		p.second[1] = p.second[0] / p.second[2];
+	return groups;
+}
+
+// adds a group (the key, followed by the SUM, AVG, and COUNT) that was output by an aggregation to the map;
+// returns false if the key was already there
+bool addGroup (map <int, vector <double>> &groups, MyDB_RecordPtr rec) {
+	int key = rec->getAtt (0)->toInt ();
+	if (groups.count (key) > 0)
+		return false;
+	groups[key] = {rec->getAtt (1)->toDouble (), rec->getAtt (2)->toDouble (), rec->getAtt (3)->toDouble ()};
+	return true;
+}
+
+// reads all of the groups (each the key, followed by the SUM, AVG, and COUNT) that an aggregation wrote to a
+// table; if a key is output more than once, the result is empty
+map <int, vector <double>> getResult (MyDB_TableReaderWriterPtr fromMe) {
+	map <int, vector <double>> groups;
+	MyDB_RecordPtr rec = fromMe->getEmptyRecord ();
+	MyDB_RecordIteratorAltPtr myIter = fromMe->getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (rec);
+		if (!addGroup (groups, rec))
+			return map <int, vector <double>> ();
+	}
+	return groups;
+}
+
+// returns true if both maps have the same keys, with the same aggregates (averages only have to be close)
+bool sameGroups (map <int, vector <double>> &result, map <int, vector <double>> &expected) {
+	if (result.size () != expected.size ())
+		return false;
+	for (auto &p : expected) {
+		if (result.count (p.first) == 0)
+			return false;
+		vector <double> &aggs = result[p.first];
+		if (aggs[0] != p.second[0] || fabs (aggs[1] - p.second[1]) > 1e-9 * fabs (p.second[1]) ||
+			aggs[2] != p.second[2])
+			return false;
+	}
+	return true;
+}
+
+int main (int argc, char *argv[]) {
+
+	int start = 1;
+	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
+		start = argv[1][0] - '0';
+	}
+
+	QUnit::UnitTest qunit(cerr, QUnit::normal);
+	int countCorrect;
+
+	// most of the tests compute SUM, AVG, and COUNT, grouping by the key
+	vector <pair <MyDB_AggType, string>> aggsToCompute;
+	aggsToCompute.push_back (make_pair (MyDB_AggType :: Sum, "[a_val]"));
+	aggsToCompute.push_back (make_pair (MyDB_AggType :: Avg, "[a_val]"));
+	aggsToCompute.push_back (make_pair (MyDB_AggType :: Cnt, "int[0]"));
+	vector <string> groupings;
+	groupings.push_back ("[a_key]");
+	vector <MyDB_AttTypePtr> outputTypes;
+	outputTypes.push_back (make_shared <MyDB_IntAttType> ());
+	outputTypes.push_back (make_shared <MyDB_IntAttType> ());
+	outputTypes.push_back (make_shared <MyDB_DoubleAttType> ());
+	outputTypes.push_back (make_shared <MyDB_IntAttType> ());
+	auto acceptAll = [] (TestRec &) {return true;};
+
+	vector <TestRec> allRecs;
+
+	switch (start) {
+	case 1:
+	cout << endl << "Test 1: Group Table:" << endl << flush;
+	countCorrect = 0;
+	allRecs = makeTable ("aggIn.tbl", 20000, 5000, 100, 0, false, 1);
+
+	cout << "Add records.." << flush;
+	{
+		map <int, vector <double>> expected = getExpected (allRecs, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 64, "tempFile");
+		MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+		MyDB_SchemaPtr outSchema = makeOutputTable ("aggOut", outputTypes, myMgr)->getTable ()->getSchema ();
+
+		// set up everything that an Aggregate would
+		MyDB_RecordPtr inputRec = inTable->getEmptyRecord ();
+		vector <func> groupingComps;
+		groupingComps.push_back (inputRec->compileComputation ("[a_key]"));
+		function <size_t ()> groupingHash = buildKeyHasher (inputRec, groupings);
+		vector <func> aggComps;
+		aggComps.push_back (inputRec->compileComputation ("[a_val]"));
+		aggComps.push_back (inputRec->compileComputation ("[a_val]"));
+		aggComps.push_back (nullptr);
+
+		// one table gets all of the records, and the other two split them up
+		GroupTable allGroups (outSchema, aggsToCompute, inputRec);
+		GroupTable evenGroups (outSchema, aggsToCompute, inputRec);
+		GroupTable oddGroups (outSchema, aggsToCompute, inputRec);
+		MyDB_RecordIteratorAltPtr myIter = inTable->getIteratorAlt ();
+		for (int i = 0; myIter->advance (); i++) {
+			myIter->getCurrent (inputRec);
+			allGroups.add (groupingHash (), groupingComps, aggComps);
+			if (i % 2 == 0)
+				evenGroups.add (groupingHash (), groupingComps, aggComps);
+			else
+				oddGroups.add (groupingHash (), groupingComps, aggComps);
+		}
+
+		// check the groups
+		MyDB_RecordPtr outRec = make_shared <MyDB_Record> (outSchema);
+		map <int, vector <double>> result;
+		bool allOK = true;
+		for (size_t i = 0; i < allGroups.size (); i++) {
+			allGroups.getGroup (i, outRec);
+			allOK = allOK && addGroup (result, outRec);
+		}
+		if (allOK && sameGroups (result, expected))
+			countCorrect++;
+
+		cout << "Merge tables.." << flush;
+		evenGroups.merge (oddGroups);
+		map <int, vector <double>> merged;
+		allOK = true;
+		for (size_t i = 0; i < evenGroups.size (); i++) {
+			evenGroups.getGroup (i, outRec);
+			allOK = allOK && addGroup (merged, outRec);
+		}
+		if (allOK && sameGroups (merged, expected))
+			countCorrect++;
+
+		cout << "Clear a table.." << endl << flush;
+		size_t bytesUsed = allGroups.getBytesUsed ();
+		allGroups.clear ();
+		if (allGroups.size () == 0 && allGroups.getBytesUsed () < bytesUsed)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 3);
+	if (countCorrect == 3) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 2:
+	cout << endl << "Test 2: Aggregate:" << endl << flush;
+	countCorrect = 0;
+	allRecs = makeTable ("aggIn.tbl", 20000, 5000, 100, 0, false, 2);
+
+	cout << "Spill and re-aggregate the partitions.." << flush;
+	{
+		// there is only room for a few hundred groups, so the partitions are spilled, and then they are
+		// spilled again, until the last level, which has to keep all of its groups
+		map <int, vector <double>> expected = getExpected (allRecs, [] (TestRec &rec) {return rec.val < 900;});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", outputTypes, myMgr);
+		Aggregate myOp (inTable, outTable, aggsToCompute, groupings, "< ([a_val], int[900])");
+		myOp.run ();
+
+		map <int, vector <double>> result = getResult (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (sameGroups (result, expected))
+			countCorrect++;
+	}
+
+	cout << "Push records and spill.." << endl << flush;
+	{
+		// same thing, but the records are pushed in, rather than read from a table
+		map <int, vector <double>> expected = getExpected (allRecs, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", outputTypes, myMgr);
+		Aggregate myOp (getInputSchema (), outTable, aggsToCompute, groupings, "bool[true]");
+		MyDB_RecordPtr inputRec = myOp.open ();
+		MyDB_RecordIteratorAltPtr myIter = inTable->getIteratorAlt ();
+		while (myIter->advance ()) {
+			myIter->getCurrent (inputRec);
+			myOp.push ();
+		}
+		myOp.close ();
+
+		map <int, vector <double>> result = getResult (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (sameGroups (result, expected))
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 4);
+	if (countCorrect == 4) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 3:
+	cout << endl << "Test 3: Parallel Aggregate:" << endl << flush;
+	countCorrect = 0;
+	allRecs = makeTable ("aggIn.tbl", 20000, 5000, 100, 0, false, 3);
+
+	cout << "Merge the threads' groups.." << flush;
+	{
+		map <int, vector <double>> expected = getExpected (allRecs, [] (TestRec &rec) {return rec.val > 50;});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 1024, "tempFile");
+		MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", outputTypes, myMgr);
+		ParallelAggregate myOp (inTable, outTable, aggsToCompute, groupings, "> ([a_val], int[50])", 4);
+		myOp.run ();
+
+		map <int, vector <double>> result = getResult (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (sameGroups (result, expected))
+			countCorrect++;
+	}
+
+	cout << "Merge a single group.." << endl << flush;
+	{
+		// with no GROUP BY, every thread has the same group
+		vector <pair <MyDB_AggType, string>> noGroupAggs;
+		noGroupAggs.push_back (make_pair (MyDB_AggType :: Sum, "[a_val]"));
+		noGroupAggs.push_back (make_pair (MyDB_AggType :: Cnt, "int[0]"));
+		noGroupAggs.push_back (make_pair (MyDB_AggType :: Min, "[a_name]"));
+		noGroupAggs.push_back (make_pair (MyDB_AggType :: Max, "[a_name]"));
+		vector <MyDB_AttTypePtr> noGroupTypes;
+		noGroupTypes.push_back (make_shared <MyDB_IntAttType> ());
+		noGroupTypes.push_back (make_shared <MyDB_IntAttType> ());
+		noGroupTypes.push_back (make_shared <MyDB_StringAttType> ());
+		noGroupTypes.push_back (make_shared <MyDB_StringAttType> ());
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 1024, "tempFile");
+		MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", noGroupTypes, myMgr);
+		ParallelAggregate myOp (inTable, outTable, noGroupAggs, vector <string> (), "bool[true]", 4);
+		myOp.run ();
+
+		long sum = 0;
+		string minName = allRecs[0].name, maxName = allRecs[0].name;
+		for (TestRec &rec : allRecs) {
+			sum += rec.val;
+			minName = min (minName, rec.name);
+			maxName = max (maxName, rec.name);
+		}
+
+		vector <MyDB_RecordPtr> result;
+		MyDB_RecordIteratorAltPtr myIter = outTable->getIteratorAlt ();
+		while (myIter->advance ()) {
+			result.push_back (outTable->getEmptyRecord ());
+			myIter->getCurrent (result.back ());
+		}
+		if (result.size () == 1)
+			countCorrect++;
+		if (result.size () == 1 && result[0]->getAtt (0)->toInt () == sum &&
+			result[0]->getAtt (1)->toInt () == (int) allRecs.size () &&
+			result[0]->getAtt (2)->toString () == minName && result[0]->getAtt (3)->toString () == maxName)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 4);
+	if (countCorrect == 4) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 4:
+	cout << endl << "Test 4: Ordered Aggregate:" << endl << flush;
+	countCorrect = 0;
+
+	// a fifth of the records have key 7, so that group spans a lot of pages, while most of the
+	// other groups only have a few records
+	allRecs = makeTable ("aggInSorted.tbl", 20000, 5000, 100, 5, true, 4);
+
+	cout << "Aggregate a sorted table.." << flush;
+	{
+		// the selection throws out some records, including all of the records in some of the groups
+		map <int, vector <double>> expected = getExpected (allRecs, [] (TestRec &rec) {return rec.val > 300;});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggInSorted.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", outputTypes, myMgr);
+		OrderedAggregate myOp (inTable, outTable, aggsToCompute, groupings, "> ([a_val], int[300])", "[a_key]");
+		myOp.run ();
+
+		map <int, vector <double>> result = getResult (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (sameGroups (result, expected))
+			countCorrect++;
+	}
+
+	cout << "Aggregate a B+-Tree.." << endl << flush;
+	{
+		map <int, vector <double>> expected = getExpected (allRecs, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_BPlusTreeReaderWriterPtr inTree = make_shared <MyDB_BPlusTreeReaderWriter> ("a_key",
+			make_shared <MyDB_Table> ("aggInTree", "aggInTree.bin", getInputSchema ()), myMgr);
+		inTree->loadFromTextFile ("aggInSorted.tbl");
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", outputTypes, myMgr);
+		OrderedAggregate myOp (inTree, outTable, aggsToCompute, groupings, "bool[true]");
+		myOp.run ();
+
+		map <int, vector <double>> result = getResult (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (sameGroups (result, expected))
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 4);
+	if (countCorrect == 4) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 5:
+	cout << endl << "Test 5: MIN, MAX, and COUNT (DISTINCT):" << endl << flush;
+	countCorrect = 0;
+	allRecs = makeTable ("aggIn.tbl", 20000, 50, 5000, 0, false, 5);
+	{
+		vector <pair <MyDB_AggType, string>> distinctAggs;
+		distinctAggs.push_back (make_pair (MyDB_AggType :: Min, "[a_val]"));
+		distinctAggs.push_back (make_pair (MyDB_AggType :: Max, "[a_val]"));
+		distinctAggs.push_back (make_pair (MyDB_AggType :: Min, "[a_name]"));
+		distinctAggs.push_back (make_pair (MyDB_AggType :: Max, "[a_name]"));
+		distinctAggs.push_back (make_pair (MyDB_AggType :: CntDistinct, "[a_val]"));
+		distinctAggs.push_back (make_pair (MyDB_AggType :: CntDistinct, "[a_name]"));
+		distinctAggs.push_back (make_pair (MyDB_AggType :: ApproxCntDistinct, "[a_name]"));
+		vector <MyDB_AttTypePtr> distinctTypes;
+		distinctTypes.push_back (make_shared <MyDB_IntAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_IntAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_IntAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_StringAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_StringAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_IntAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_IntAttType> ());
+		distinctTypes.push_back (make_shared <MyDB_IntAttType> ());
+
+		// work out what the aggregates should be
+		map <int, set <int>> vals;
+		map <int, set <string>> names;
+		for (TestRec &rec : allRecs) {
+			vals[rec.key].insert (rec.val);
+			names[rec.key].insert (rec.name);
+		}
+
+		// checks that every key is output once, with the right aggregates; the approximate count has
+		// to be within 10% (the standard error is about 3%)
+		auto checkOutput = [&] (MyDB_TableReaderWriterPtr outTable) {
+			set <int> keysSeen;
+			MyDB_RecordPtr outRec = outTable->getEmptyRecord ();
+			MyDB_RecordIteratorAltPtr myIter = outTable->getIteratorAlt ();
+			while (myIter->advance ()) {
+				myIter->getCurrent (outRec);
+				int key = outRec->getAtt (0)->toInt ();
+				double approx = outRec->getAtt (7)->toInt ();
+				if (vals.count (key) == 0 || keysSeen.count (key) > 0 ||
+					outRec->getAtt (1)->toInt () != *vals[key].begin () ||
+					outRec->getAtt (2)->toInt () != *vals[key].rbegin () ||
+					outRec->getAtt (3)->toString () != *names[key].begin () ||
+					outRec->getAtt (4)->toString () != *names[key].rbegin () ||
+					outRec->getAtt (5)->toInt () != (int) vals[key].size () ||
+					outRec->getAtt (6)->toInt () != (int) names[key].size () ||
+					fabs (approx - names[key].size ()) > 0.1 * names[key].size ())
+					return false;
+				keysSeen.insert (key);
+			}
+			return keysSeen.size () == vals.size ();
+		};
+
+		cout << "Compute the aggregates.." << flush;
+		{
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (4096, 1024, "tempFile");
+			MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+			MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", distinctTypes, myMgr);
+			Aggregate myOp (inTable, outTable, distinctAggs, groupings, "bool[true]");
+			myOp.run ();
+			if (checkOutput (outTable))
+				countCorrect++;
+		}
+
+		cout << "Spill the distinct values.." << endl << flush;
+		{
+			// the distinct values for a few groups fill up the budget, so they have to be spilled
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+			MyDB_TableReaderWriterPtr inTable = loadTable ("aggIn", "aggIn.tbl", myMgr);
+			MyDB_TableReaderWriterPtr outTable = makeOutputTable ("aggOut", distinctTypes, myMgr);
+			Aggregate myOp (inTable, outTable, distinctAggs, groupings, "bool[true]");
+			myOp.run ();
+			if (checkOutput (outTable))
+				countCorrect++;
+		}
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 6:
+	cout << endl << "Test 6: HyperLogLog:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Estimate distinct counts.." << flush;
+	{
+		// the estimates have to be within 10% (the standard error is about 3%)
+		int numClose = 0;
+		for (int numDistinct : {10, 100, 1000, 10000, 100000, 1000000}) {
+			HyperLogLog mySketch;
+			for (int i = 0; i < numDistinct; i++) {
+				mySketch.add (hashInt (i));
+				mySketch.add (hashInt (i));
+			}
+			if (fabs (mySketch.estimate () - numDistinct) <= 0.1 * numDistinct)
+				numClose++;
+		}
+		HyperLogLog emptySketch;
+		if (numClose == 6 && emptySketch.estimate () == 0)
+			countCorrect++;
+	}
+
+	cout << "Merge sketches.." << endl << flush;
+	{
+		// two overlapping sketches, merged, have to be the same as one sketch over all of the values
+		HyperLogLog lowSketch, highSketch, allSketch;
+		for (int i = 0; i < 60000; i++)
+			lowSketch.add (hashInt (i));
+		for (int i = 40000; i < 100000; i++)
+			highSketch.add (hashInt (i));
+		for (int i = 0; i < 100000; i++)
+			allSketch.add (hashInt (i));
+		lowSketch.merge (highSketch);
+		if (lowSketch.estimate () == allSketch.estimate ())
+			countCorrect++;
+		if (fabs (lowSketch.estimate () - 100000) <= 0.1 * 100000)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 3);
+	if (countCorrect == 3) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+	default:
+		break;
+	}
+}
+
+#endif
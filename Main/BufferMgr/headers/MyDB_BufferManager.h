@@ -68,6 +68,15 @@ public:
 
     size_t getNumPages();
 
+	// returns the number of buffer pages that are not currently pinned (that is, those
+	// that are either empty or hold an unpinned page that can be kicked out)
+	size_t getNumUnpinnedPages ();
+
+	// asks the OS to start reading the page referenced by prefetchMe in the background,
+	// so that a later access to the page does not have to wait on the disk... this is
+	// just a hint; it does nothing if the page is already buffered
+	void prefetch (MyDB_PageHandle prefetchMe);
+
 private:
 
 	// tells us the LRU number of each of the pages
@@ -24,6 +24,24 @@ size_t MyDB_BufferManager ::getNumPages() {
     return numPages;
 }
 
+size_t MyDB_BufferManager :: getNumUnpinnedPages () {
+	return availableRam.size () + lastUsed.size ();
+}
+
+void MyDB_BufferManager :: prefetch (MyDB_PageHandle prefetchMe) {
+
+	MyDB_PagePtr page = prefetchMe->page;
+
+	// if the page is already buffered, there is nothing to do
+	if (page->bytes != nullptr)
+		return;
+
+	// otherwise, let the kernel start reading it in asynchronously
+	if (fds.count (page->myTable) > 0) {
+		posix_fadvise (fds[page->myTable], page->pos * pageSize, pageSize, POSIX_FADV_WILLNEED);
+	}
+}
+
 MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i) {
 		
 	// open the file, if it is not open
@@ -13,6 +13,7 @@
 #include "MyDB_RecordIteratorAlt.h"
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
+#include "RadixSort.h"
 
 // create a smart pointer for the catalog
 using namespace std;
@@ -37,9 +38,22 @@ public:
 	// return all records with a key value in the range [low, high], inclusive
         MyDB_RecordIteratorAltPtr getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high);
 	
+	// gets an iterator over all of the records in the tree, in sorted order; only the records that are
+	// accepted by the given selection predicate are returned.  Since the leaf pages are already in order,
+	// this only has to sort one page at a time
+	MyDB_RecordIteratorAltPtr getSortedIteratorAlt (string selectionPredicate);
+
 	// append a record to the B+-Tree
 	void append (MyDB_RecordPtr appendMe);
 
+	// fills leafPages with the page numbers of all of the leaf pages that might have a record with a
+	// key value in the range [low, high], inclusive, in key order... this is used by operations (such as
+	// the IndexNestedLoopJoin) that look up one key after another, and want to re-use pages between lookups
+	void discoverLeafPages (MyDB_AttValPtr low, MyDB_AttValPtr high, vector <int> &leafPages);
+
+	// returns the name of the attribute that the tree is ordered on
+	string getOrderingAttName ();
+
 	// print the contents of the tree to the screen
 	void printTree ();
 
@@ -50,6 +64,13 @@ private:
 	bool discoverPages (int whichPage, vector <MyDB_PageReaderWriter> &list,
         	MyDB_AttValPtr low, MyDB_AttValPtr high);
 
+	// gets all of the leaf pages under the given page, in order
+	void discoverAllPages (int whichPage, vector <MyDB_PageReaderWriter> &list);
+
+	// same as above, except that the page numbers of the leaf pages are returned
+	bool discoverPages (int whichPage, vector <int> &list,
+        	MyDB_AttValPtr low, MyDB_AttValPtr high);
+
 	// appends a record to the named page; if there is a split, then an MyDB_INRecordPtr is returned that
 	// points to the record holding the (key, ptr) pair pointing to the new page.  Note that the new page
 	// always holds the lower 1/2 of the records on the page; the upper 1/2 remains in the original page
@@ -74,6 +95,10 @@ private:
 	// only if the first record has a key value less than the second record
 	function <bool ()> buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
 
+	// constructs and returns the sort key for the given record (again, an IN or an LN record), so that
+	// pages of records can be radix sorted on the key when it has a fixed-width type
+	MyDB_SortKey getSortKey (MyDB_RecordPtr forMe);
+
 	// the location (page number) of the root in the tree
 	int rootLocation;
 
@@ -35,11 +35,16 @@ public:
 	MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUs);
 	~MyDB_PageListIteratorAlt ();
 
+	// like the above, except that if prefetchOrNot is true, then each time the iterator moves
+	// onto a new page, the page after it is prefetched
+	MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUs, bool prefetchOrNot);
+
 private:
 
 	MyDB_RecordIteratorAltPtr myIter;
 	vector <MyDB_PageReaderWriter> forUs;
 	int curPage;
+	bool prefetchOrNot;
 };
 
 #endif
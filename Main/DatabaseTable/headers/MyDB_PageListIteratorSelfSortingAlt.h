@@ -43,7 +43,7 @@ public:
 			} else {
 				curPage++;
 				if (sortOrNot)
-					forUs[curPage].sortInPlace (comparator, lhs, rhs);	
+					forUs[curPage].sortInPlace (comparator, lhs, rhs, sortKey);	
 				myIter = forUs[curPage].getIteratorAlt ();
 			}
 		}
@@ -52,7 +52,15 @@ public:
 	// destructor and contructor
 	MyDB_PageListIteratorSelfSortingAlt (vector <MyDB_PageReaderWriter> &forUsIn, MyDB_RecordPtr lhsIn, 
 		MyDB_RecordPtr rhsIn, function <bool ()> comparatorIn, MyDB_RecordPtr myRecIn, function <bool ()> lowComparatorIn, 
-		function <bool ()> highComparatorIn, bool sortOrNotIn) {
+		function <bool ()> highComparatorIn, bool sortOrNotIn) : MyDB_PageListIteratorSelfSortingAlt (forUsIn, 
+		lhsIn, rhsIn, comparatorIn, myRecIn, lowComparatorIn, highComparatorIn, sortOrNotIn, 
+		MyDB_SortKey (nullptr, nullptr)) {}
+
+	// like the above, except that sortKey (computed over lhs) is the key the comparator orders by,
+	// so that pages with a fixed-width key can be radix sorted
+	MyDB_PageListIteratorSelfSortingAlt (vector <MyDB_PageReaderWriter> &forUsIn, MyDB_RecordPtr lhsIn, 
+		MyDB_RecordPtr rhsIn, function <bool ()> comparatorIn, MyDB_RecordPtr myRecIn, function <bool ()> lowComparatorIn, 
+		function <bool ()> highComparatorIn, bool sortOrNotIn, MyDB_SortKey sortKeyIn) {
 
 		// just remember all of the parameters
 		lhs = lhsIn;
@@ -64,10 +72,11 @@ public:
 		myRec = myRecIn;
 		curPage = 0;
 		sortOrNot = sortOrNotIn;
+		sortKey = sortKeyIn;
 
 		// set up the first iterator, and we are ready to go!!
 		if (sortOrNot)
-			forUs[curPage].sortInPlace (comparator, lhs, rhs);	
+			forUs[curPage].sortInPlace (comparator, lhs, rhs, sortKey);	
 		myIter = forUsIn[curPage].getIteratorAlt ();
 	}
 
@@ -83,6 +92,7 @@ private:
 	function <bool ()> highComparator;
 	int curPage;
 	bool sortOrNot;
+	MyDB_SortKey sortKey;
 	MyDB_RecordPtr myRec;
 };
 
@@ -11,6 +11,7 @@
 #include "MyDB_RecordIterator.h"
 #include "MyDB_RecordIteratorAlt.h"
 #include "MyDB_TableReaderWriter.h"
+#include "RadixSort.h"
 
 using namespace std;
 class MyDB_PageReaderWriter;
@@ -76,14 +77,36 @@ public:
 	// like the above, except that the sorting is done in place, on the page
 	void sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs);
 
+	// like the two above, except that sortKey gives the key (computed over lhs) that the comparator
+	// orders by.  If the key is an int, a double, or a bool, then a radix sort is used instead of
+	// a comparison sort; otherwise, the comparator is used as usual
+	MyDB_PageReaderWriterPtr sort (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, 
+		MyDB_SortKey sortKey);
+	void sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, 
+		MyDB_SortKey sortKey);
+
+	// hints to the buffer manager that this page is going to be read soon, so
+	// that it can be brought in from disk in the background
+	void prefetch ();
+
 	// returns the page size
 	size_t getPageSize ();
 
 	// returns the actual bytes
 	void *getBytes ();
 
+	// returns the location of the first record on the page, and the location just past the
+	// last one.  While the page is pinned, the records can be read straight from there by
+	// repeatedly calling MyDB_Record.fromBinary (); since this does not go through the
+	// buffer manager, several threads can do it at the same time
+	pair <void *, void *> getRecordBytes ();
+
 private:
 
+	// sorts the list of positions of records on this page, using a radix sort if the key allows it
+	void sortPositions (vector <void *> &positions, function <bool ()> comparator, MyDB_RecordPtr lhs,  
+		MyDB_RecordPtr rhs, MyDB_SortKey &sortKey);
+
 	// this is the page that we are messing with
 	MyDB_PageHandle myPage;	
 	
@@ -0,0 +1,32 @@
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "MyDB_AttType.h"
+#include "MyDB_Record.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+// a sort key is a function that computes the key over a record, along with the type of the key...
+// sorting on the key is assumed to give the same order as a comparator built using buildRecordComparator
+// over the same computation (for example, via buildSortKey below)
+typedef pair <func, MyDB_AttTypePtr> MyDB_SortKey;
+
+// builds the sort key for the given computation over rec; the computation is encoded just as it is
+// for MyDB_Record.compileComputation () and buildRecordComparator ()
+MyDB_SortKey buildSortKey (MyDB_RecordPtr rec, string computation);
+
+// if the sort key has a fixed-width type (an int, a double, or a bool), this returns a function that
+// maps the key computed over the current contents of the record to an unsigned integer, such that the
+// unsigned integers sort in the same order as the keys.  If the key cannot be handled this way (it is a
+// string, for example) then a nullptr is returned
+function <uint64_t ()> buildNormalizedKey (MyDB_SortKey &sortKey);
+
+// sorts the list of record positions using a stable LSD radix sort over the normalized key.  To get the
+// key for each position, the record is read into rec, and then normalizedKey is called
+void radixSort (vector <void *> &positions, MyDB_RecordPtr rec, function <uint64_t ()> normalizedKey);
+
+#endif
@@ -0,0 +1,61 @@
+
+#ifndef RUN_ENTRY_COMP_H
+#define RUN_ENTRY_COMP_H
+
+#include "MyDB_Record.h"
+#include <cstdint>
+#include <functional>
+
+using namespace std;
+
+// an entry in the replacement selection heap... rec points to the record, which is located
+// on the (pinned) working set page whichPage, and run is the run that the record will be output in
+struct RunEntry {
+	int run;
+	int whichPage;
+	void *rec;
+	uint64_t key;
+};
+
+// used to order the replacement selection heap... entries from an earlier run always come
+// first; within a run, entries are ordered using the record comparator, or using the normalized
+// key in each entry (see RadixSort.h) if useKeys is true
+class RunEntryComparator {
+
+public:
+
+	RunEntryComparator (function <bool ()> comparatorIn, MyDB_RecordPtr lhsIn, MyDB_RecordPtr rhsIn) {
+		comparator = comparatorIn;
+		lhs = lhsIn;
+		rhs = rhsIn;
+		useKeys = false;
+	}
+
+	RunEntryComparator (function <bool ()> comparatorIn, MyDB_RecordPtr lhsIn, MyDB_RecordPtr rhsIn, bool useKeysIn) {
+		comparator = comparatorIn;
+		lhs = lhsIn;
+		rhs = rhsIn;
+		useKeys = useKeysIn;
+	}
+
+	// note that std::priority_queue is a max-heap, so this returns true if leftEntry
+	// should come out of the heap AFTER rightEntry
+	bool operator() (const RunEntry &leftEntry, const RunEntry &rightEntry) const {
+		if (leftEntry.run != rightEntry.run)
+			return leftEntry.run > rightEntry.run;
+		if (useKeys)
+			return rightEntry.key < leftEntry.key;
+		lhs->fromBinary (rightEntry.rec);
+		rhs->fromBinary (leftEntry.rec);
+		return comparator ();
+	}
+
+private:
+
+	function <bool ()> comparator;
+	MyDB_RecordPtr lhs;
+	MyDB_RecordPtr rhs;
+	bool useKeys;
+};
+
+#endif
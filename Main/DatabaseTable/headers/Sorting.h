@@ -16,7 +16,8 @@ void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &
 // Accepts the input file sortMe, and then uses the specified comparator over the records lhs 
 // and rhs to sort the file into a set of sorted runs of length at most runSize.  It then
 // constructs an iterator over those runs, that can be used to scan the data in sorted order
-// in the input file.
+// in the input file.  If there are more runs than can be merged at once using the available
+// buffer frames (at most runSize), intermediate merge passes are run over the smallest runs first.
 MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
         function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
 
@@ -25,6 +26,41 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
         function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred);
 
+// just like the above, except that if replacementSelection is true, the sorted runs are generated
+// using replacement selection: a heap is maintained over a working set of runSize pinned pages, and
+// the smallest record that can still extend the current run is repeatedly streamed out to the run.
+// On random input this gives runs about 2 * runSize pages long; on nearly-sorted input it typically
+// gives a single run, so that the final merge is much cheaper
+MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred,
+	bool replacementSelection);
+
+// just like the above, except that sortKey is the computation that the comparator orders by (the
+// same string that was given to buildRecordComparator).  If it gives an int, double, or bool, then
+// the in-memory sorting of the runs is done using a radix sort over the key, rather than the comparator
+MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred,
+	bool replacementSelection, string sortKey);
+
+// just like the above, except that filter is called on each input record (after it has been loaded
+// into lhs and has passed the selection predicate), and the record is not sorted unless it returns
+// true.  This is used to apply a join's runtime filter to the records before the runs are built
+MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred,
+	bool replacementSelection, string sortKey, function <bool ()> filter);
+
+// this is the first phase of buildItertorOverSortedRuns: it breaks the input file into sorted runs, but
+// does not merge them.  Each run is returned as a list of anonymous pages.  The parameters are the same
+// as for buildItertorOverSortedRuns, so this can be used to see how many runs a given sort produces
+vector <vector <MyDB_PageReaderWriter>> buildSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred,
+	bool replacementSelection);
+
+// same as above, but with the sort key and the filter
+vector <vector <MyDB_PageReaderWriter>> buildSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe,
+        function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string pred,
+	bool replacementSelection, string sortKey, function <bool ()> filter);
+
 // helper function.  Gets two iterators, leftIter and rightIter.  It is assumed that these are iterators over
 // sorted lists of records.  This function then merges all of those records into a list of anonymous pages,
 // and returns the list of anonymous pages to the caller.  The resulting list of anonymous pages is sorted.
@@ -46,7 +46,8 @@ MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getSortedRangeIteratorAl
 	function <bool ()> highComparator = buildComparator (hhigh, myRec);	
 
 	// and build the iterator
-	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, lowComparator, highComparator, true);	
+	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, lowComparator, highComparator, 
+		true, getSortKey (lhs));	
 }
 
 MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
@@ -76,16 +77,77 @@ MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getRangeIteratorAlt (MyD
 }
 
 
+MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getSortedIteratorAlt (string selectionPredicate) {
+
+	// this is the list of pages that we need to iterate over
+	vector <MyDB_PageReaderWriter> list;
+	discoverAllPages (rootLocation, list);
+
+	// for various comparisons
+	MyDB_RecordPtr lhs = getEmptyRecord ();
+	MyDB_RecordPtr rhs = getEmptyRecord ();
+	MyDB_RecordPtr myRec = getEmptyRecord ();
+	function <bool ()> comparator = buildComparator (lhs, rhs);
+
+	// there are no bounds, but the iterator skips anything that is "below the low bound", so we
+	// use that to skip the records that are not accepted by the predicate
+	func pred = myRec->compileComputation (selectionPredicate);
+	function <bool ()> rejected = [pred] {return !pred ()->toBool ();};
+	function <bool ()> neverAbove = [] {return false;};
+
+	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, rejected, neverAbove, 
+		true, getSortKey (lhs));	
+}
+
+void MyDB_BPlusTreeReaderWriter :: discoverAllPages (int whichPage, vector <MyDB_PageReaderWriter> &list) {
+
+	MyDB_PageReaderWriter pageToSearch = (*this)[whichPage];
+
+	// a leaf page
+	if (pageToSearch.getType () == MyDB_PageType :: RegularPage) {
+		list.push_back (pageToSearch);
+
+	// an internal node, so get all of the pages under each of the subtrees, in order
+	} else {
+		MyDB_RecordIteratorAltPtr temp = pageToSearch.getIteratorAlt ();
+		MyDB_INRecordPtr otherRec = getINRecord ();
+		while (temp->advance ()) {
+			temp->getCurrent (otherRec);
+			discoverAllPages (otherRec->getPtr (), list);
+		}
+	}
+}
+
+void MyDB_BPlusTreeReaderWriter :: discoverLeafPages (MyDB_AttValPtr low, MyDB_AttValPtr high, vector <int> &leafPages) {
+	discoverPages (rootLocation, leafPages, low, high);
+}
+
+string MyDB_BPlusTreeReaderWriter :: getOrderingAttName () {
+	return getTable ()->getSchema ()->getAtts ()[whichAttIsOrdering].first;
+}
+
 bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <MyDB_PageReaderWriter> &list,
 	MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
+	// find the leaf pages, and then get them
+	vector <int> pageNums;
+	bool returnVal = discoverPages (whichPage, pageNums, low, high);
+	for (int i : pageNums)
+		list.push_back ((*this)[i]);
+
+	return returnVal;
+}
+
+bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <int> &list,
+	MyDB_AttValPtr low, MyDB_AttValPtr high) {
+
 	// figure out the page to search
 	MyDB_PageReaderWriter pageToSearch = (*this)[whichPage];
 
 	// it is a regular page (data page)
 	if (pageToSearch.getType () == MyDB_PageType :: RegularPage) {
 
-		list.push_back (pageToSearch);
+		list.push_back (whichPage);
 		return true;
 		
 	// we have an internal node, so find the subtrees to seach
@@ -117,7 +179,7 @@ bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <MyDB_Pa
 			// see if the new key is less than the key in the directory record
 			if (lowEngaged && highEngaged) {
 				if (foundLeaf) {
-					list.push_back ((*this)[otherRec->getPtr ()]);
+					list.push_back (otherRec->getPtr ());
 
 				} else {
 					foundLeaf = discoverPages (otherRec->getPtr (), list, low, high);	
@@ -235,9 +297,15 @@ MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitM
 	andMe->toBinary (spaceForLastGuy);
 	positions.push_back (spaceForLastGuy);
 
-	// now sort
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::stable_sort (positions.begin (), positions.end (), myComparator);
+	// now sort, using a radix sort if the key allows it
+	MyDB_SortKey sortKey = getSortKey (lhs);
+	function <uint64_t ()> normalizedKey = buildNormalizedKey (sortKey);
+	if (normalizedKey != nullptr) {
+		radixSort (positions, lhs, normalizedKey);
+	} else {
+		RecordComparator myComparator (comparator, lhs, rhs);
+		std::stable_sort (positions.begin (), positions.end (), myComparator);
+	}
 
 	// get the record to return
 	MyDB_INRecordPtr returnVal = getINRecord ();
@@ -317,7 +385,7 @@ MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: append (int whichPage, MyDB_RecordP
 					if (pageToAddTo.append (res)) {
 						MyDB_INRecordPtr otherRec = getINRecord ();
 						function <bool ()> comparator = buildComparator (res, otherRec);	
-						pageToAddTo.sortInPlace (comparator, res, otherRec);
+						pageToAddTo.sortInPlace (comparator, res, otherRec, getSortKey (res));
 						return nullptr;
 					}
 
@@ -386,6 +454,22 @@ MyDB_AttValPtr MyDB_BPlusTreeReaderWriter :: getKey (MyDB_RecordPtr fromMe) {
 		return fromMe->getAtt (whichAttIsOrdering)->getCopy ();
 }
 
+MyDB_SortKey MyDB_BPlusTreeReaderWriter :: getSortKey (MyDB_RecordPtr forMe) {
+
+	MyDB_AttValPtr att;
+
+	// in this case, it is an IN record
+	if (forMe->getSchema () == nullptr) {
+		att = forMe->getAtt (0);	
+
+	// here, it is a regular data record
+	} else {
+		att = forMe->getAtt (whichAttIsOrdering);
+	}
+
+	return make_pair ([att] {return att;}, orderingAttType);
+}
+
 function <bool ()>  MyDB_BPlusTreeReaderWriter :: buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
 
 	MyDB_AttValPtr lhAtt, rhAtt;
@@ -20,6 +20,8 @@ bool MyDB_PageListIteratorAlt :: advance () {
 		return false;
 
 	curPage++;
+	if (prefetchOrNot && (size_t) curPage + 1 < forUs.size ())
+		forUs[curPage + 1].prefetch ();
 	myIter = forUs[curPage].getIteratorAlt ();
 	return advance ();
 }
@@ -31,6 +33,16 @@ void *MyDB_PageListIteratorAlt :: getCurrentPointer () {
 MyDB_PageListIteratorAlt :: MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUsIn) {
 	forUs = forUsIn;
 	curPage = 0;
+	prefetchOrNot = false;
+	myIter = forUsIn[curPage].getIteratorAlt ();		
+}
+
+MyDB_PageListIteratorAlt :: MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUsIn, bool prefetchOrNotIn) {
+	forUs = forUsIn;
+	curPage = 0;
+	prefetchOrNot = prefetchOrNotIn;
+	if (prefetchOrNot && forUs.size () > 1)
+		forUs[1].prefetch ();
 	myIter = forUsIn[curPage].getIteratorAlt ();		
 }
 
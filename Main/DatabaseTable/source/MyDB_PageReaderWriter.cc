@@ -105,9 +105,36 @@ bool MyDB_PageReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	return true;
 }
 
+void MyDB_PageReaderWriter :: sortPositions (vector <void *> &positions, function <bool ()> comparator, 
+	MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, MyDB_SortKey &sortKey) {
+
+	// see if we can do a radix sort
+	function <uint64_t ()> normalizedKey = buildNormalizedKey (sortKey);
+	if (normalizedKey != nullptr) {
+		radixSort (positions, lhs, normalizedKey);
+		return;
+	}
+
+	// if not, sort using the record contents to build a comparator
+	RecordComparator myComparator (comparator, lhs, rhs);
+	std::stable_sort (positions.begin (), positions.end (), myComparator);
+}
+
 void MyDB_PageReaderWriter :: 
 	sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs) {
 
+	sortInPlace (comparator, lhs, rhs, MyDB_SortKey (nullptr, nullptr));
+}
+
+MyDB_PageReaderWriterPtr MyDB_PageReaderWriter :: 
+	sort (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs) {
+
+	return sort (comparator, lhs, rhs, MyDB_SortKey (nullptr, nullptr));
+}
+
+void MyDB_PageReaderWriter :: 
+	sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, MyDB_SortKey sortKey) {
+
 	void *temp = malloc (pageSize);
 	memcpy (temp, myPage->getBytes (), pageSize);
 
@@ -123,9 +150,8 @@ void MyDB_PageReaderWriter ::
 		bytesConsumed += ((char *) nextPos) - ((char *) pos);
 	}
 
-	// and now we sort the vector of positions, using the record contents to build a comparator
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::stable_sort (positions.begin (), positions.end (), myComparator);
+	// and now we sort the vector of positions
+	sortPositions (positions, comparator, lhs, rhs, sortKey);
 
 	// and write the guys back
 	NUM_BYTES_USED = 2 * sizeof (size_t);
@@ -139,7 +165,7 @@ void MyDB_PageReaderWriter ::
 }
 
 MyDB_PageReaderWriterPtr MyDB_PageReaderWriter :: 
-	sort (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs) {
+	sort (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, MyDB_SortKey sortKey) {
 
 	// first, read in the positions of all of the records
 	vector <void *> positions;
@@ -153,9 +179,8 @@ MyDB_PageReaderWriterPtr MyDB_PageReaderWriter ::
 		bytesConsumed += ((char *) nextPos) - ((char *) pos);
 	}
 
-	// and now we sort the vector of positions, using the record contents to build a comparator
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::stable_sort (positions.begin (), positions.end (), myComparator);
+	// and now we sort the vector of positions
+	sortPositions (positions, comparator, lhs, rhs, sortKey);
 
 	// and now create the page to return
 	MyDB_PageReaderWriterPtr returnVal = make_shared <MyDB_PageReaderWriter> (myPage->getParent ());
@@ -170,6 +195,10 @@ MyDB_PageReaderWriterPtr MyDB_PageReaderWriter ::
 	return returnVal;
 }
 
+void MyDB_PageReaderWriter :: prefetch () {
+	myPage->getParent ().prefetch (myPage);
+}
+
 size_t MyDB_PageReaderWriter :: getPageSize () {
 	return pageSize;
 }
@@ -178,4 +207,9 @@ void *MyDB_PageReaderWriter :: getBytes () {
 	return myPage->getBytes ();
 }
 
+pair <void *, void *> MyDB_PageReaderWriter :: getRecordBytes () {
+	char *bytes = (char *) myPage->getBytes ();
+	return make_pair ((void *) (bytes + 2 * sizeof (size_t)), (void *) (bytes + NUM_BYTES_USED));
+}
+
 #endif
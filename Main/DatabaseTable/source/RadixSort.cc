@@ -0,0 +1,101 @@
+
+#ifndef RADIX_SORT_C
+#define RADIX_SORT_C
+
+#include <cstring>
+#include "RadixSort.h"
+
+using namespace std;
+
+MyDB_SortKey buildSortKey (MyDB_RecordPtr rec, string computation) {
+	return make_pair (rec->compileComputation (computation), rec->getType (computation));
+}
+
+function <uint64_t ()> buildNormalizedKey (MyDB_SortKey &sortKey) {
+
+	func key = sortKey.first;
+	MyDB_AttTypePtr keyType = sortKey.second;
+	if (key == nullptr || keyType == nullptr)
+		return nullptr;
+
+	// these are tested in the same order as in MyDB_Record.lt (), so that we get the same ordering...
+	// for an int, flipping the sign bit makes the negative values come first
+	if (keyType->promotableToInt ()) {
+		return [key] {
+			uint32_t val = (uint32_t) key ()->toInt ();
+			return (uint64_t) (val ^ 0x80000000u);
+		};
+
+	// for a double, flip the sign bit of a positive value, and all of the bits of a negative one
+	} else if (keyType->promotableToDouble ()) {
+		return [key] {
+			double val = key ()->toDouble ();
+			uint64_t bits;
+			memcpy (&bits, &val, sizeof (bits));
+			if (bits >> 63)
+				return ~bits;
+			return bits | (((uint64_t) 1) << 63);
+		};
+
+	// a bool is compared as a string, and "false" < "true"
+	} else if (keyType->isBool ()) {
+		return [key] {
+			return (uint64_t) (key ()->toBool () ? 1 : 0);
+		};
+	}
+
+	// anything else needs a comparison sort
+	return nullptr;
+}
+
+void radixSort (vector <void *> &positions, MyDB_RecordPtr rec, function <uint64_t ()> normalizedKey) {
+
+	// extract all of the keys
+	size_t numRecs = positions.size ();
+	vector <pair <uint64_t, void *>> sortMe (numRecs);
+	for (size_t i = 0; i < numRecs; i++) {
+		rec->fromBinary (positions[i]);
+		sortMe[i].first = normalizedKey ();
+		sortMe[i].second = positions[i];
+	}
+
+	// build the histograms for all eight bytes of the key in one go
+	vector <size_t> counts (8 * 256, 0);
+	for (auto &entry : sortMe) {
+		for (int i = 0; i < 8; i++) {
+			counts[i * 256 + ((entry.first >> (i * 8)) & 0xFF)]++;
+		}
+	}
+
+	// now, do a counting sort on each byte, from least to most significant
+	vector <pair <uint64_t, void *>> temp (numRecs);
+	for (int i = 0; i < 8; i++) {
+
+		size_t *myCounts = counts.data () + i * 256;
+
+		// if every key has the same value for this byte, this pass would not do anything
+		if (numRecs == 0 || myCounts[(sortMe[0].first >> (i * 8)) & 0xFF] == numRecs)
+			continue;
+
+		// turn the counts into offsets
+		size_t offset = 0;
+		for (int j = 0; j < 256; j++) {
+			size_t count = myCounts[j];
+			myCounts[j] = offset;
+			offset += count;
+		}
+
+		// and scatter everyone
+		for (auto &entry : sortMe) {
+			temp[myCounts[(entry.first >> (i * 8)) & 0xFF]++] = entry;
+		}
+		sortMe.swap (temp);
+	}
+
+	// write the positions back
+	for (size_t i = 0; i < numRecs; i++) {
+		positions[i] = sortMe[i].second;
+	}
+}
+
+#endif
@@ -3,12 +3,16 @@
 #define SORT_C
 
 #include <queue>
+#include <algorithm>
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_PageListIteratorAlt.h"
 #include "MyDB_TableRecIterator.h"
 #include "MyDB_TableRecIteratorAlt.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_RunQueueIteratorAlt.h"
 #include "IteratorComparator.h"
+#include "RunEntryComparator.h"
+#include "RadixSort.h"
 #include "Sorting.h"
 
 using namespace std;
@@ -108,20 +112,299 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
 	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred) {
 
+	return buildItertorOverSortedRuns (runSize, sortMe, comparator, lhs, rhs, lhsPred, false);
+}
+
+// builds an iterator that merges all of the sorted runs into a single sorted stream... each run
+// prefetches its next page as it is scanned, so that the merge is not stalled waiting on the disk
+MyDB_RecordIteratorAltPtr buildRunQueue (vector <vector <MyDB_PageReaderWriter>> &runs, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	MyDB_RunQueueIteratorAltPtr temp = make_shared <MyDB_RunQueueIteratorAlt> (comparator, lhs, rhs);
+
+	// load up the set
+	for (auto &run : runs) {
+		MyDB_RecordIteratorAltPtr m = make_shared <MyDB_PageListIteratorAlt> (run, true);
+		if (m->advance ()) {
+			temp->getQ ().push (m);
+		}
+	}
+
+	return temp;
+}
+
+// merges all of the runs in mergeMe into a single run, which is written to a list of anonymous pages
+vector <MyDB_PageReaderWriter> mergeRunsIntoList (MyDB_BufferManagerPtr parent, 
+	vector <vector <MyDB_PageReaderWriter>> &mergeMe, function <bool ()> comparator, 
+	MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	vector <MyDB_PageReaderWriter> returnVal;
+	MyDB_PageReaderWriter curPage (*parent);
+
+	// note that we need a separate record to hold the output, since the queue uses lhs and rhs
+	MyDB_RecordPtr outRec = make_shared <MyDB_Record> (lhs->getSchema ());
+	MyDB_RecordIteratorAltPtr myIter = buildRunQueue (mergeMe, comparator, lhs, rhs);
+	while (myIter->advance ()) {
+		myIter->getCurrent (outRec);
+		appendRecord (curPage, returnVal, outRec, parent);
+	}
+
+	returnVal.push_back (curPage);
+	return returnVal;
+}
+
+// merges the given set of sorted runs, and returns an iterator over the result.  If there are too
+// many runs to merge all at once without thrashing the buffer (each run in the final merge wants a
+// page for its current position plus one for the prefetched next page), then intermediate passes are
+// run first.  Each intermediate pass merges the smallest runs, and merges only enough of them so
+// that the remaining runs can go into a single full final merge
+MyDB_RecordIteratorAltPtr mergeRuns (int runSize, MyDB_BufferManagerPtr parent, 
+	vector <vector <MyDB_PageReaderWriter>> &allRuns, function <bool ()> comparator, 
+	MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	// figure out the fan-in: two frames per run, and one for the output
+	size_t numFrames = parent->getNumUnpinnedPages ();
+	if (runSize > 0 && (size_t) runSize < numFrames)
+		numFrames = runSize;
+	size_t fanIn = 2;
+	if (numFrames > 1 && (numFrames - 1) / 2 > fanIn)
+		fanIn = (numFrames - 1) / 2;
+
+	while (allRuns.size () > fanIn) {
+
+		// we want to end up with exactly fanIn runs after this merge if possible
+		size_t numToMerge = allRuns.size () - fanIn + 1;
+		if (numToMerge > fanIn)
+			numToMerge = fanIn;
+
+		// find the smallest runs, since merging them costs the least I/O
+		std :: sort (allRuns.begin (), allRuns.end (), [] (const vector <MyDB_PageReaderWriter> &a, 
+			const vector <MyDB_PageReaderWriter> &b) {return a.size () < b.size ();});
+
+		vector <vector <MyDB_PageReaderWriter>> mergeMe (allRuns.begin (), allRuns.begin () + numToMerge);
+		allRuns.erase (allRuns.begin (), allRuns.begin () + numToMerge);
+		allRuns.push_back (mergeRunsIntoList (parent, mergeMe, comparator, lhs, rhs));
+	}
+
+	return buildRunQueue (allRuns, comparator, lhs, rhs);
+}
+
+// uses replacement selection to break the (filtered) input file into a set of sorted runs,
+// each of which is a list of anonymous pages
+vector <vector <MyDB_PageReaderWriter>> buildRunsWithReplacementSelection (int runSize, 
+	MyDB_TableReaderWriter &sortMe, function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, 
+	string lhsPred, MyDB_SortKey &sortKey, function <bool ()> filter) {
+
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+
 	bool skipPred = false;
 	if (lhsPred == "bool[true]")
 		skipPred = true;
 
 	func f = lhs->compileComputation (lhsPred);
 
+	// this is the working set: a list of pinned pages, along with the number of records on each
+	// page that are still in the heap... a page can be re-used once all of its records are gone
+	if (runSize < 1)
+		runSize = 1;
+	vector <MyDB_PageReaderWriter> workingSet;
+	vector <int> numLive;
+	vector <int> freePages;
+	for (int i = 0; i < runSize; i++) {
+		workingSet.push_back (MyDB_PageReaderWriter (true, *parent));
+		numLive.push_back (0);
+		if (i != 0)
+			freePages.push_back (i);
+	}
+
+	// this is the working set page that incoming records are currently written to
+	int fillPage = 0;
+
+	// if the key is fixed-width, the heap orders records using their normalized keys, which
+	// saves de-serializing the records over and over again
+	function <uint64_t ()> normalizedKey = buildNormalizedKey (sortKey);
+	bool useKeys = (normalizedKey != nullptr);
+	uint64_t lastOutKey = 0;
+
+	// the heap over all of the records in the working set
+	priority_queue <RunEntry, vector <RunEntry>, RunEntryComparator> heap (RunEntryComparator (comparator, 
+		lhs, rhs, useKeys));
+
+	// all of the completed runs, as well as the one that we are writing right now
+	vector <vector <MyDB_PageReaderWriter>> allRuns;
+	vector <MyDB_PageReaderWriter> curRun;
+	MyDB_PageReaderWriter curPage (*parent);
+	int curRunNum = 0;
+
+	// the last record that was written to the current run, and the record that is being added
+	vector <char> lastOut;
+	vector <char> incoming;
+
+	// this removes the smallest record from the heap, and streams it out to the current run
+	auto popOne = [&] () {
+
+		RunEntry next = heap.top ();
+		heap.pop ();
+
+		// see if this guy starts a new run
+		if (next.run != curRunNum) {
+			curRun.push_back (curPage);
+			allRuns.push_back (curRun);
+			curRun.clear ();
+			curPage = MyDB_PageReaderWriter (*parent);
+			curRunNum = next.run;
+		}
+
+		// write him out, remembering him so we know which incoming records can still go in this run
+		char *nextPos = (char *) lhs->fromBinary (next.rec);
+		lastOut.assign ((char *) next.rec, nextPos);
+		lastOutKey = next.key;
+		appendRecord (curPage, curRun, lhs, parent);
+
+		// and free up his space in the working set
+		numLive[next.whichPage]--;
+		if (numLive[next.whichPage] == 0) {
+			if (next.whichPage == fillPage)
+				workingSet[fillPage].clear ();
+			else
+				freePages.push_back (next.whichPage);
+		}
+	};
+
+	// process the file 
+	for (int i = 0; i < sortMe.getNumPages (); i++) {
+		
+		if (sortMe[i].getType () != MyDB_PageType :: RegularPage)
+			continue;
+
+		MyDB_RecordIteratorAltPtr temp = sortMe[i].getIteratorAlt ();
+		while (temp->advance ()) {
+
+			temp->getCurrent (lhs);
+			if (!skipPred && !f ()->toBool ())
+				continue;
+
+			if (filter != nullptr && !filter ())
+				continue;
+
+			// remember the record, since making room for it in the working set uses lhs
+			incoming.resize (lhs->getBinarySize ());
+			lhs->toBinary (incoming.data ());
+
+			// find a spot for him in the working set, evicting records until there is room
+			void *loc;
+			while (true) {
+				lhs->fromBinary (incoming.data ());
+				loc = workingSet[fillPage].appendAndReturnLocation (lhs);
+				if (loc != nullptr)
+					break;
+
+				if (freePages.size () > 0) {
+					fillPage = freePages.back ();
+					freePages.pop_back ();
+					workingSet[fillPage].clear ();
+				} else if (heap.size () > 0) {
+					popOne ();
+				} else {
+					cout << "Can't fit a record into an empty page while sorting!!\n";
+					exit (1);
+				}
+			}
+			numLive[fillPage]++;
+
+			// if he is smaller than the last guy written out, he has to wait for the next run
+			RunEntry entry;
+			entry.run = curRunNum;
+			entry.whichPage = fillPage;
+			entry.rec = loc;
+			entry.key = 0;
+			if (useKeys) {
+				entry.key = normalizedKey ();
+				if (lastOut.size () > 0 && entry.key < lastOutKey)
+					entry.run++;
+			} else if (lastOut.size () > 0) {
+				rhs->fromBinary (lastOut.data ());
+				if (comparator ())
+					entry.run++;
+			}
+			heap.push (entry);
+		}
+	}
+
+	// empty out the heap
+	while (heap.size () > 0)
+		popOne ();
+
+	// and remember the last run
+	if (lastOut.size () > 0) {
+		curRun.push_back (curPage);
+		allRuns.push_back (curRun);
+	}
+
+	return allRuns;
+}
+
+MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred, 
+	bool replacementSelection) {
+
+	return buildItertorOverSortedRuns (runSize, sortMe, comparator, lhs, rhs, lhsPred, replacementSelection, "");
+}
+
+MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred, 
+	bool replacementSelection, string sortKeyComp) {
+
+	return buildItertorOverSortedRuns (runSize, sortMe, comparator, lhs, rhs, lhsPred, replacementSelection, 
+		sortKeyComp, nullptr);
+}
+
+MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred, 
+	bool replacementSelection, string sortKeyComp, function <bool ()> filter) {
+
+	// get the sorted runs, and then merge everything
+	vector <vector <MyDB_PageReaderWriter>> allRuns = buildSortedRuns (runSize, sortMe, comparator, lhs, rhs, 
+		lhsPred, replacementSelection, sortKeyComp, filter);
+	return mergeRuns (runSize, sortMe.getBufferMgr (), allRuns, comparator, lhs, rhs);
+}
+
+vector <vector <MyDB_PageReaderWriter>> buildSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred, 
+	bool replacementSelection) {
+
+	return buildSortedRuns (runSize, sortMe, comparator, lhs, rhs, lhsPred, replacementSelection, "", nullptr);
+}
+
+vector <vector <MyDB_PageReaderWriter>> buildSortedRuns (int runSize, MyDB_TableReaderWriter &sortMe, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs, string lhsPred, 
+	bool replacementSelection, string sortKeyComp, function <bool ()> filter) {
+
+	// if we know the key, we may be able to radix sort
+	MyDB_SortKey sortKey (nullptr, nullptr);
+	if (sortKeyComp != "")
+		sortKey = buildSortKey (lhs, sortKeyComp);
+
+	// replacement selection builds all of the runs in one pass over the file
+	if (replacementSelection) {
+		return buildRunsWithReplacementSelection (runSize, sortMe, comparator, lhs, rhs, lhsPred, sortKey, filter);
+	}
+
+	// this is the list of all of the runs
+	vector <vector <MyDB_PageReaderWriter>> allRuns;
+
+	// if there is no predicate and no filter, whole pages can be sorted as-is
+	bool skipPred = false;
+	if (lhsPred == "bool[true]" && filter == nullptr)
+		skipPred = true;
+
+	func f = lhs->compileComputation (lhsPred);
+
 	// this is the list of all of the pages in the file
 	vector <vector<MyDB_PageReaderWriter>> allPages;
 
 	// this is the pages making up the current run
 	vector <vector<MyDB_PageReaderWriter>> pagesToSort;
-
-	// this is the list of all of the iterators, with one for each run
-	vector <MyDB_RecordIteratorAltPtr> runIters;
 	
 	// process the file 
 	MyDB_PageReaderWriter tempPage (true, *sortMe.getBufferMgr ());
@@ -131,7 +414,7 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 
 			if (skipPred) {
 				vector <MyDB_PageReaderWriter> run;
-				run.push_back (*(sortMe[i].sort (comparator, lhs, rhs)));	
+				run.push_back (*(sortMe[i].sort (comparator, lhs, rhs, sortKey)));	
 				pagesToSort.push_back (run);
 			} else {
 				MyDB_RecordIteratorAltPtr temp = sortMe[i].getIteratorAlt ();
@@ -141,11 +424,14 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 					if (!f ()->toBool ())
 						continue;
 
+					if (filter != nullptr && !filter ())
+						continue;
+
 					if (!tempPage.append (lhs)) {
 	
 						// remember the old page
 						vector <MyDB_PageReaderWriter> run;
-						run.push_back (*(tempPage.sort (comparator, lhs, rhs)));
+						run.push_back (*(tempPage.sort (comparator, lhs, rhs, sortKey)));
 						pagesToSort.push_back (run);
 	
 						// get the new page
@@ -160,7 +446,7 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 		// if we are all done, remember the last page
 		if (i == sortMe.getNumPages () - 1) {
 			vector <MyDB_PageReaderWriter> run;
-			run.push_back (*(tempPage.sort (comparator, lhs, rhs)));
+			run.push_back (*(tempPage.sort (comparator, lhs, rhs, sortKey)));
 			pagesToSort.push_back (run);
 		}
 
@@ -199,24 +485,14 @@ MyDB_RecordIteratorAltPtr buildItertorOverSortedRuns (int runSize, MyDB_TableRea
 		}
 
 		
-		// now we have a single list, so create an iterator for it
-		runIters.push_back (getIteratorAlt (pagesToSort[0]));
+		// now we have a single list, so remember it
+		allRuns.push_back (pagesToSort[0]);
 
 		// and start over on the next run
 		pagesToSort.clear ();
 	}
 	
-	// and now, we are ready to merge everything
-	MyDB_RunQueueIteratorAltPtr temp = make_shared <MyDB_RunQueueIteratorAlt> (comparator, lhs, rhs);
-
-	// load up the set
-	for (MyDB_RecordIteratorAltPtr m : runIters) {
-		if (m->advance ()) {
-			temp->getQ ().push (m);
-		}
-	}
-
-	return temp;
+	return allRuns;
 }
 
 
@@ -3,13 +3,24 @@
 #define LOG_OP_H
 
 #include <algorithm>
+#include <functional>
 #include "MyDB_Stats.h"
 #include "MyDB_TableReaderWriter.h"
 #include "ExprTree.h"
 #include "RegularSelection.h"
+#include "BPlusSelection.h"
 #include "ScanJoin.h"
 #include "SortMergeJoin.h"
+#include "HybridHashJoin.h"
+#include "AdaptiveJoin.h"
+#include "IndexNestedLoopJoin.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "ParallelHashJoin.h"
+#include "ParallelSelection.h"
 #include "Aggregate.h"
+#include "ParallelAggregate.h"
+#include "OrderedAggregate.h"
+#include "TopK.h"
 
 
 
@@ -31,13 +42,33 @@ public:
 	// once this operation has been executed, delete the temporary tables associated with child operations
 	virtual MyDB_TableReaderWriterPtr execute () = 0;
 
+	// runs the plan, but rather than writing the output to a table, pushes each output record to the consumer:
+	// the record is written into intoMe (which has the output schema), and then consume is called.  By default,
+	// this executes the plan and reads its output back in, but a scan and a hash join push their records through
+	// without writing them out, so that a whole pipeline of them runs as one loop
+	virtual void produce (MyDB_RecordPtr intoMe, function <void ()> consume);
+
+	// returns true if produce () does not need to write out the output of this operation
+	virtual bool isPipelined () {return false;}
+
+	// estimates the average size, in bytes, of one of the output records, from the sizes of the records in the
+	// base tables under this operation; returns -1 if there is no estimate
+	virtual double estimateRecordSize () {return -1;}
+
+	// the schema of the output
+	virtual MyDB_SchemaPtr getOutputSchema () = 0;
+
 	virtual ~LogicalOp () {}
 };
 
 // a logical aggregation operation--in practice, this is going to be implemented using an Aggregate operation,
 // followed by a RegularSelection operation to de-scramble the output attributes (since the Aggregate always has
 // the grouping atts first, followed by the aggregates, and this might not be the order that is given in 
-// exprsToCompute)
+// exprsToCompute).  If the input is already sorted on one of the grouping atts (it is a scan over a B+-Tree
+// ordered on that att, or a join that ran as a SortMergeJoin on it), an OrderedAggregate is used instead.  If
+// the input is a simple scan, the base table is aggregated in place (in parallel, if the groups are sure to fit
+// in RAM).  Otherwise, if the input is too big to stay in the buffer pool, and it can be pipelined, its records
+// are pushed right into the Aggregate, and are never written out
 //
 class LogicalAggregate : public LogicalOp {
 
@@ -56,20 +87,26 @@ public:
 		vector <ExprTreePtr> &groupings, MyDB_BufferManagerPtr myMgr) : inputOp (inputOp), outputSpec (outputSpec), exprsToCompute (exprsToCompute),
 		groupings (groupings), myMgr(myMgr) {}
 	
-	// fill this out!  This should actually run the aggregation via an appropriate RelOp, and then it is going to
-	// have to unscramble the output attributes and compute exprsToCompute using an execution of the RegularSelection 
-	// operation (why?  Note that the aggregate always outputs all of the grouping atts followed by the agg atts.
-	// After, a selection is required to compute the final set of aggregate expressions)
-	//
-	// Note that after the subquery is executed (as well as any operations that produce temp data) any temporary 
-	// database tables should be deleted (via a kill to killTable () on the buffer manager)
+	// runs the aggregation, using an OrderedAggregate when the input is sorted on a grouping att, a
+	// ParallelAggregate when the groups are sure to fit in RAM, and an Aggregate otherwise; then a
+	// RegularSelection computes exprsToCompute from the grouping atts and agg atts that the aggregate outputs.
+	// Any temporary tables are deleted (via a call to killTable () on the buffer manager)
 	MyDB_TableReaderWriterPtr execute ();
 
-	// we don't really count the cost of the aggregate, so cost its subplan and return that
+	// costs the subplan, plus the number of groups that come out of the aggregate... this matters when the
+	// aggregate is run below a join (see SFWQuery), since the join input is then the groups
 	pair <double, MyDB_StatsPtr> cost ();
+
+	MyDB_SchemaPtr getOutputSchema () {return outputSpec->getSchema ();}
 	
 private:
 
+	// returns true if the output of inputOp is expected to fit in half of the buffer pool, and there is more
+	// than one thread to run it with... then it is better to execute the input (using the parallel operations)
+	// and aggregate it in parallel, than to push its records into the aggregate one at a time, since writing
+	// out the input costs little when its pages stay in RAM
+	bool inputFitsInRAM ();
+
 	LogicalOpPtr inputOp;
 	MyDB_TablePtr outputSpec;
 	vector <ExprTreePtr> exprsToCompute;
@@ -78,7 +115,44 @@ private:
 
 };
 	
-// a logical join operation---will be implemented with a ScanJoin or a SortMergeJoin
+// a logical ORDER BY/LIMIT operation---this is implemented using a TopK operation, which sorts the output of
+// the input operation (or just finds the first few records in the sort order, if there is a limit)
+class LogicalTopK : public LogicalOp {
+
+public:
+
+	//
+	// inputOp: this is the input operation that we are reading from
+	// outputSpec: this is the table (location) that we are going to create; it has the same schema as the
+	//    output of inputOp
+	// orderBy: the computations to sort on (over the output of inputOp), each with a flag that is true
+	//    if the sort is ascending
+	// limit: the number of records to output, or -1 if there is no limit
+	//
+	LogicalTopK (LogicalOpPtr inputOp, MyDB_TablePtr outputSpec, vector <pair <string, bool>> &orderBy, 
+		long limit, MyDB_BufferManagerPtr myMgr) : inputOp (inputOp), outputSpec (outputSpec), orderBy (orderBy), 
+		limit (limit), myMgr (myMgr) {}
+
+	// runs the input operation, and then sorts its output; the temporary table from the input is deleted
+	MyDB_TableReaderWriterPtr execute ();
+
+	// we don't count the cost of the sort, since every plan for the query has to do it
+	pair <double, MyDB_StatsPtr> cost ();
+
+	// the output has the same schema as the input
+	MyDB_SchemaPtr getOutputSchema () {return inputOp->getOutputSchema ();}
+
+private:
+
+	LogicalOpPtr inputOp;
+	MyDB_TablePtr outputSpec;
+	vector <pair <string, bool>> orderBy;
+	long limit;
+	MyDB_BufferManagerPtr myMgr;
+};
+
+// a logical join operation---will be implemented with a ParallelHashJoin or a HybridHashJoin, or (if one side
+// is a scan of a B+-Tree that is ordered on a join attribute) with an IndexNestedLoopJoin or a SortMergeJoin
 class LogicalJoin  : public LogicalOp {
 
 public:
@@ -104,15 +178,65 @@ public:
 	// the left and the right to cost the join itself
 	pair <double, MyDB_StatsPtr> cost ();
 	
-	// Fill this out!  This should recursively execute the left hand side, and then the right hand side, and then
-	// it should heuristically choose whether to do a scan join or a sort-merge join (if it chooses a scan join, it
-	// should use a heuristic to choose which input is to be hashed and which is to be scanned), and execute the join.
-	// Note that after the left and right hand sides have been executed, the temporary tables associated with the two 
-	// sides should be deleted (via a kill to killTable () on the buffer manager)
+	// executes the join: if one side is a B+-Tree ordered on a join attribute, it is joined as described for
+	// runWithTree.  Otherwise, a ParallelHashJoin is used if the smaller input fits in half of the buffer pool,
+	// and an AdaptiveJoin (which decides which side to hash, and whether to go to disk, as it reads the inputs)
+	// if not.  Temporary tables from the inputs are deleted (via a call to killTable () on the buffer manager)
 	MyDB_TableReaderWriterPtr execute ();
 
+	// if the output of the last call to execute () is sorted on one of its attributes (because it was
+	// produced by a SortMergeJoin), this returns that attribute (as in "[att]"); otherwise, it returns ""
+	string getOutputOrder ();
+
+	// if the join is going to be run as a hash join, it is run without writing out either input: the output
+	// of the side that is expected to be smaller is copied into pinned pages and hashed, and then the other
+	// side's records are pushed through the hash table.  If the side being hashed turns out not to fit in half of the buffer
+	// pool, it is written out, and the join is run with runHashJoin (whose output is then read back in)
+	void produce (MyDB_RecordPtr intoMe, function <void ()> consume);
+	bool isPipelined ();
+
+	// an output record is (at most) a record from each side, put together
+	double estimateRecordSize ();
+
+	MyDB_SchemaPtr getOutputSchema () {return outputSpec->getSchema ();}
+
 private:
 
+	// if innerOp is a table scan over a B+-Tree that is ordered on an attribute that one of the join predicates
+	// checks against an attribute on the other side, this returns the tree, and sets outerAtt to the other side's
+	// attribute; otherwise, it returns nullptr
+	MyDB_BPlusTreeReaderWriterPtr findOrderedTree (LogicalOpPtr innerOp, ExprTreePtr &outerAtt);
+
+	// runs the join when innerOp is a scan over a B+-Tree ordered on a join attribute (as found by findOrderedTree).
+	// The tree's order is useful here, since rather than running the scan, we can either probe the tree with the
+	// keys from outerOp (using an IndexNestedLoopJoin), or read the tree in order and merge it with the sorted
+	// output of outerOp (using a SortMergeJoin, which does not need to sort the tree).  These are costed against
+	// running the scan and using a hash join, and the cheapest is run
+	void runWithTree (LogicalOpPtr outerOp, LogicalOpPtr innerOp, ExprTreePtr outerAtt,
+		MyDB_TableReaderWriterPtr outputTable, string finalPredicate);
+
+	// gets the pairs of computations that the join predicates check for equality; the first in each pair is
+	// over leftTable
+	vector <pair <string, string>> getEqualityChecks (MyDB_TableReaderWriterPtr leftTable);
+	vector <pair <string, string>> getEqualityChecks (MyDB_SchemaPtr leftSchema);
+
+	// runs the join over the two (already executed) inputs, using one of the hash joins; leftPredicate and
+	// rightPredicate are run over the inputs as they are read, and leftEstimate and rightEstimate are the
+	// estimated numbers of records in the two inputs that are accepted by them
+	void runHashJoin (MyDB_TableReaderWriterPtr leftTable, MyDB_TableReaderWriterPtr rightTable,
+		MyDB_TableReaderWriterPtr outputTable, string finalPredicate, string leftPredicate, string rightPredicate,
+		double leftEstimate, double rightEstimate);
+
+	// gets one of the inputs to the join.  If op is a simple scan (see LogicalTableScan::isSimpleScan), it is
+	// not run; rather, its input table is returned, and selectionPredicate is set to the scan's predicate, so
+	// that the join runs the selection as it reads the table, and the scan's output is never written out.
+	// Since the join then sees all of the table's attributes, this is only done if none of them has the same
+	// name as one in otherSchema.  Otherwise, op is run, and selectionPredicate is set to "bool[true]"
+	MyDB_TableReaderWriterPtr getInput (LogicalOpPtr op, MyDB_SchemaPtr otherSchema, string &selectionPredicate);
+
+	// gets rid of a table returned by getInput (unless it is op's input table, and not a temp table)
+	void killInput (LogicalOpPtr op, MyDB_TableReaderWriterPtr input);
+
 	LogicalOpPtr leftInputOp;
 	LogicalOpPtr rightInputOp;
 	MyDB_TablePtr outputSpec;
@@ -120,6 +244,8 @@ private:
 	vector <string> exprsToCompute;
     MyDB_BufferManagerPtr myMgr;
 
+	// the attribute that the output of the last execute () is sorted on, if any
+	string outputOrder;
 };
 
 // a logical table scan operation---will be implemented with a BPlusSelection or a RegularSelection... note that
@@ -147,15 +273,42 @@ public:
 	// this costs the table scan returning the compute set of statistics for the output
 	pair <double, MyDB_StatsPtr> cost ();
 
-	// fill this out!  This should heuristically choose whether to use a B+-Tree (if appropriate) or just a regular
-	// table scan, and then execute the table scan using a relational selection.  Note that a desirable optimization
-	// is to somehow set things up so that if a B+-Tree is NOT used, that the table scan does not actually do anything,
-	// and the selection predicate is handled at the level of the parent (by filtering, for example, the data that is
-	// input into a join)
+	// executes the table scan using a relational selection... if the scan is over a B+-Tree, and the selection
+	// predicate bounds the tree's key tightly enough that looking up the range is cheaper than reading the whole
+	// tree, only that range is read.  Note that a join over a simple scan does not call this; it reads the input
+	// table itself, and runs the selection predicate as it goes
 	MyDB_TableReaderWriterPtr execute ();
 
+	// if the scan is over a B+-Tree, this returns the tree (otherwise, it returns nullptr)... this is used by
+	// a join over the scan, which may choose to probe the tree rather than running the scan
+	MyDB_BPlusTreeReaderWriterPtr getBPlusTree ();
+
+	// returns the selection predicate, with all of the disjunctions and-ed together
+	string getSelectionPredicate ();
+
+	// returns true if the scan is over a regular table (not a B+-Tree), and its output attributes are just some
+	// of the table's attributes, with the same names... in that case, a parent can read the table returned by
+	// getInputTable () in place of the scan's output, as long as it runs getSelectionPredicate () over it
+	bool isSimpleScan ();
+	MyDB_TableReaderWriterPtr getInputTable () {return inputSpec;}
+
+	// runs the scan, the selection predicate, and the projections in one loop, pushing each record
+	void produce (MyDB_RecordPtr intoMe, function <void ()> consume);
+	bool isPipelined () {return true;}
+
+	// the output records are (at most) as big as the input table's records
+	double estimateRecordSize ();
+
+	MyDB_SchemaPtr getOutputSchema () {return outputSpec->getSchema ();}
+
 private:
 
+	// if the scan is over a B+-Tree, this looks for the conjuncts in the selection predicate that check the tree's
+	// key against a constant (key = c, key < c, c > key, and so on), and puts the tightest bounds that they give
+	// into low and high (the bounds are inclusive, so the whole predicate still needs to be run over the range).
+	// Returns true if there is such a range, and the stats say that looking it up is cheaper than a full scan
+	bool getKeyRange (MyDB_AttValPtr &low, MyDB_AttValPtr &high);
+
 	MyDB_TableReaderWriterPtr inputSpec;
 	MyDB_TablePtr outputSpec;
 	MyDB_StatsPtr inputStats;
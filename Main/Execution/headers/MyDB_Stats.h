@@ -36,6 +36,9 @@ public:
 	// cost a selection predicte
 	MyDB_StatsPtr costSelection (vector <ExprTreePtr> &allDisjunctions);
 
+	// cost a GROUP BY; the output has one tuple per group, and only the grouping atts
+	MyDB_StatsPtr costGroupBy (vector <ExprTreePtr> &groupings);
+
 private:
 
 	vector <pair <double, string>> allAtts;
@@ -16,17 +16,78 @@ private:
 	vector <ExprTreePtr> allDisjunctions;
 	vector <ExprTreePtr> groupingClauses;
 
+	// the ORDER BY (each value has a flag that is true if the sort is ascending), and the LIMIT (-1 if none)
+	vector <pair <ExprTreePtr, bool>> orderingClauses;
+	long limit;
+
+	// if the aggregates are being computed eagerly (see buildEagerAggregate), this is the table that they are
+	// computed over (or -1 if none), and these are the attributes that hold the partial aggregates
+	int eagerTable;
+	vector <pair <string, MyDB_AttTypePtr>> eagerAtts;
+
+    // builds the plan for a query over two or more tables... the order in which the tables are joined is chosen
+    // using dynamic programming over all connected subsets of the tables (or greedily, if there are a lot of tables)
     LogicalOpPtr buildLogicalMultipleTablesPlan (map <string, MyDB_TablePtr> &allTables,
                                                  map <string, MyDB_TableReaderWriterPtr> &allTableReaderWriters, MyDB_BufferManagerPtr myMgr);
 
+    // a plan for joining a subset of the tables, along with its cost and output statistics
+    struct JoinPlan {
+        LogicalOpPtr op;
+        double cost;
+        MyDB_StatsPtr stats;
+        unsigned lhsMask;
+        unsigned rhsMask;
+    };
+
+    // finds the cheapest way to join all of the given plans (one for each table)
+    JoinPlan joinAllTables (map <string, MyDB_TablePtr> &allTables, vector <JoinPlan> &scans, MyDB_BufferManagerPtr myMgr);
+
+    // returns true if the aggregates can be computed eagerly over the given table, before it is joined with the
+    // others: every aggregate has to be a SUM, MIN or MAX over only that table, or a COUNT
+    bool canAggregateEagerly (int whichTable);
+
+    // puts an aggregate over the plan for the given table that groups on everything that the rest of the query
+    // needs from it, and computes a partial aggregate for each aggregate in the SELECT.  Since each partial
+    // aggregate is repeated once for every record that it is joined with, the final aggregates are just the
+    // SUM (for a SUM or a COUNT), MIN or MAX of the partial ones.  This sets eagerTable and eagerAtts, and
+    // changes valuesToSelect so that it computes the final aggregates
+    JoinPlan buildEagerAggregate (map <string, MyDB_TablePtr> &allTables, JoinPlan &scan, int whichTable,
+                                  MyDB_BufferManagerPtr myMgr);
+
+    // returns the set of tables (as a bit mask over tablesToProcess) referenced by the expression
+    unsigned getTableMask (ExprTreePtr forMe);
+
+    // gets the predicates that are applied by joining the tables in lhsMask with the tables in rhsMask; these
+    // are all of the ones that reference tables on both sides, and no tables on neither side
+    vector <ExprTreePtr> getJoinPredicates (unsigned lhsMask, unsigned rhsMask);
+
+    // fills in the schema and the computations for the output of a plan over the tables in mask... these are all
+    // of the attributes from those tables that are needed by the SELECT or GROUP BY clauses, or by a predicate
+    // that has not been applied yet (because it references a table outside of mask), plus the partial aggregates
+    // if mask has the eagerly aggregated table
+    void getNeededAtts (map <string, MyDB_TablePtr> &allTables, unsigned mask, MyDB_SchemaPtr schema, vector <string> &exprs);
+
+    // joins the two plans, costing the result.  If isTop is true, this is the last join, and so the output is
+    // the SELECT clause (or, if there is an aggregation, everything that the aggregation needs)
+    JoinPlan buildJoin (map <string, MyDB_TablePtr> &allTables, JoinPlan &lhs, JoinPlan &rhs, bool isTop,
+                        MyDB_BufferManagerPtr myMgr);
+
     LogicalOpPtr buildLogicalOneTableQueryPlan (map <string, MyDB_TablePtr> &allTables,
                                                 map <string, MyDB_TableReaderWriterPtr> &allTableReaderWriters, MyDB_BufferManagerPtr myMgr);
 
     LogicalOpPtr buildLogicalOneTableWithAggQueryPlan (map <string, MyDB_TablePtr> &allTables,
                                                        map <string, MyDB_TableReaderWriterPtr> &allTableReaderWriters, MyDB_BufferManagerPtr myMgr);
 
+    // puts an ORDER BY/LIMIT on top of the plan, if the query has one.  If outputIsSelectList is true, then the
+    // output of the plan has one attribute (att_0, att_1, ...) for each value in the SELECT clause; otherwise, it
+    // has the attributes of the base table.  Returns nullptr if the ORDER BY cannot be computed over the plan output
+    LogicalOpPtr addOrderByAndLimit (LogicalOpPtr plan, bool outputIsSelectList, MyDB_BufferManagerPtr myMgr);
+
 public:
-	SFWQuery () {}
+	SFWQuery () {
+		limit = -1;
+		eagerTable = -1;
+	}
 
 	SFWQuery (struct ValueList *selectClause, struct FromList *fromClause, 
 		struct CNF *cnf, struct ValueList *grouping);
@@ -2,19 +2,32 @@
 #ifndef LOG_OP_CC
 #define LOG_OP_CC
 
+#include "KeyHash.h"
 #include "MyDB_LogicalOps.h"
+#include "RecordHashTable.h"
+#include "TaskScheduler.h"
+#include <limits>
 
 using namespace std;
 
-// fill this out!  This should actually run the aggregation via an appropriate RelOp, and then it is going to
-// have to unscramble the output attributes and compute exprsToCompute using an execution of the RegularSelection 
-// operation (why?  Note that the aggregate always outputs all of the grouping atts followed by the agg atts.
-// After, a selection is required to compute the final set of aggregate expressions)
-//
-// Note that after the left and right hand sides have been executed, the temporary tables associated with the two 
-// sides should be deleted (via a kill to killFile () on the buffer manager)
+// by default, we just run the operation and read its output back in
+void LogicalOp :: produce (MyDB_RecordPtr intoMe, function <void ()> consume) {
+
+	MyDB_TableReaderWriterPtr outputTable = execute ();
+	MyDB_RecordIteratorAltPtr myIter = outputTable->getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (intoMe);
+		consume ();
+	}
+	outputTable->getBufferMgr ()->killTable (outputTable->getTable ());
+}
+
+// runs the aggregation with an OrderedAggregate if the input is a B+-Tree or a join output that is sorted on one
+// of the grouping atts, with a ParallelAggregate if the groups are sure to fit in RAM, and with an Aggregate
+// (which can spill groups to disk) otherwise.  The aggregate always outputs all of the grouping atts followed by
+// the agg atts, so a RegularSelection is then run over its output to compute exprsToCompute.  Any temporary
+// tables are killed once they have been read
 MyDB_TableReaderWriterPtr LogicalAggregate :: execute () {
-    MyDB_TableReaderWriterPtr selectionTable = inputOp->execute();
 
     vector <pair <MyDB_AggType, string>> aggsToCompute;
     vector <string> groups;
@@ -26,15 +39,70 @@ MyDB_TableReaderWriterPtr LogicalAggregate :: execute () {
         else if (a->isSum()) {
             aggsToCompute.push_back(make_pair(MyDB_AggType::Sum, a->getChild()->toString()));
         }
+        else if (a->isMin()) {
+            aggsToCompute.push_back(make_pair(MyDB_AggType::Min, a->getChild()->toString()));
+        }
+        else if (a->isMax()) {
+            aggsToCompute.push_back(make_pair(MyDB_AggType::Max, a->getChild()->toString()));
+        }
+        else if (a->isCount()) {
+            aggsToCompute.push_back(make_pair(MyDB_AggType::Cnt, a->getChild()->toString()));
+        }
+        else if (a->isCountDistinct()) {
+            aggsToCompute.push_back(make_pair(MyDB_AggType::CntDistinct, a->getChild()->toString()));
+        }
+        else if (a->isApproxCountDistinct()) {
+            aggsToCompute.push_back(make_pair(MyDB_AggType::ApproxCntDistinct, a->getChild()->toString()));
+        }
     }
 
     for (auto b : groupings) {
         groups.push_back(b->toString());
     }
 
+    // if the input is a scan over a B+-Tree that is ordered on one of the grouping atts, we don't run the
+    // scan; rather, we aggregate the tree's records in sorted order
+    shared_ptr <LogicalTableScan> inputScan = dynamic_pointer_cast <LogicalTableScan> (inputOp);
+    MyDB_BPlusTreeReaderWriterPtr inputTree = nullptr;
+    if (inputScan != nullptr && inputScan->getBPlusTree () != nullptr &&
+        find (groups.begin (), groups.end (), "[" + inputScan->getBPlusTree ()->getOrderingAttName () + "]") != groups.end ()) {
+        inputTree = inputScan->getBPlusTree ();
+    }
+
+    // otherwise, a simple scan is not run; rather, its base table is aggregated in place, and the scan's predicate
+    // is run as the table is read.  This is done unless the groups may not fit in RAM, and the selected records
+    // would fit (then the scan is run in parallel, so that its output can be aggregated in parallel)
+    //
+    // anything else is run, unless it can be pipelined and it is too big to stay in RAM... then its records are
+    // pushed right into the aggregate, so that they are never written out.  If the input is run, and it comes out
+    // sorted on one of the grouping atts, we can still use that
+    bool isPipelined = false;
+    bool isTempTable = false;
+    MyDB_TableReaderWriterPtr selectionTable = inputTree;
+    string selectionPredicate = "bool[true]";
+    string orderingKey = "";
+    if (inputTree == nullptr) {
+        if (inputScan != nullptr && inputScan->isSimpleScan () && (groups.size () == 0 ||
+            (size_t) inputScan->getInputTable ()->getNumPages () <= myMgr->getNumPages () / 2 || !inputFitsInRAM ())) {
+            selectionTable = inputScan->getInputTable ();
+            selectionPredicate = inputScan->getSelectionPredicate ();
+        }
+        else if (inputOp->isPipelined () && !inputFitsInRAM ()) {
+            isPipelined = true;
+        }
+        else {
+            selectionTable = inputOp->execute();
+            isTempTable = true;
+            shared_ptr <LogicalJoin> inputJoin = dynamic_pointer_cast <LogicalJoin> (inputOp);
+            if (inputJoin != nullptr && find (groups.begin (), groups.end (), inputJoin->getOutputOrder ()) != groups.end ()) {
+                orderingKey = inputJoin->getOutputOrder ();
+            }
+        }
+    }
+
     MyDB_SchemaPtr aggregateSchema = make_shared<MyDB_Schema>();
 
-    MyDB_RecordPtr myRec = selectionTable->getEmptyRecord();
+    MyDB_RecordPtr myRec = isPipelined ? make_shared<MyDB_Record>(inputOp->getOutputSchema()) : selectionTable->getEmptyRecord();
     for (string g : groups) {
         aggregateSchema->appendAtt(make_pair(g.substr(1, g.length() - 2), myRec->getType(g)));
     }
@@ -43,25 +111,58 @@ MyDB_TableReaderWriterPtr LogicalAggregate :: execute () {
         if (a->isAvg()) {
             aggregateSchema->appendAtt(make_pair(to_string(hash<string>()(a->toString())), make_shared <MyDB_DoubleAttType> ()));
         }
-        else if (a->isSum()) {
+        else if (a->isSum() || a->isMin() || a->isMax()) {
             aggregateSchema->appendAtt(make_pair(to_string(hash<string>()(a->toString())), myRec->getType(a->getChild()->toString())));
         }
+        else if (a->isAgg()) {
+            // the counts
+            aggregateSchema->appendAtt(make_pair(to_string(hash<string>()(a->toString())), make_shared <MyDB_IntAttType> ()));
+        }
     }
 
 
 
+    // the input may itself be running an aggregate while this one is, so the file is named for this operation
     MyDB_TableReaderWriterPtr aggregationTable = make_shared<MyDB_TableReaderWriter>(
-            make_shared<MyDB_Table>("aggregateTable", "aggregateLoc", aggregateSchema), myMgr);
+            make_shared<MyDB_Table>(outputSpec->getName() + "_aggregate", outputSpec->getStorageLoc() + "_aggregate", aggregateSchema), myMgr);
+
+    // when the input is sorted on a grouping att, the groups can be aggregated one run at a time, with no
+    // need to keep them all in RAM
+    if (inputTree != nullptr) {
+        OrderedAggregate aggOp(inputTree, aggregationTable, aggsToCompute, groups, inputScan->getSelectionPredicate ());
+        aggOp.run();
+    }
+    else if (isPipelined) {
+        Aggregate aggOp(inputOp->getOutputSchema(), aggregationTable, aggsToCompute, groups, "bool[true]");
+        MyDB_RecordPtr inputRec = aggOp.open();
+        if (inputRec != nullptr) {
+            inputOp->produce(inputRec, [&aggOp] () {aggOp.push();});
+            aggOp.close();
+        }
+    }
+    else if (orderingKey != "") {
+        OrderedAggregate aggOp(selectionTable, aggregationTable, aggsToCompute, groups, "bool[true]", orderingKey);
+        aggOp.run();
+    }
 
-    Aggregate aggOp(selectionTable, aggregationTable, aggsToCompute, groups, "bool[true]");
-    aggOp.run();
+    // there can't be more groups than input records, so if the input is not too big, the groups are sure
+    // to fit in RAM, and the threads can pre-aggregate it in parallel... the same goes with no GROUP BY
+    else if (groups.size() == 0 || (size_t) selectionTable->getNumPages() <= myMgr->getNumPages() / 2) {
+        ParallelAggregate aggOp(selectionTable, aggregationTable, aggsToCompute, groups, selectionPredicate);
+        aggOp.run();
+    }
+    else {
+        // otherwise, use an aggregation that can spill groups to disk
+        Aggregate aggOp(selectionTable, aggregationTable, aggsToCompute, groups, selectionPredicate);
+        aggOp.run();
+    }
 
     // regular selection from aggregate table
     MyDB_TableReaderWriterPtr outputTable = make_shared<MyDB_TableReaderWriter>(outputSpec, myMgr);
 
     vector<string> projections;
     for (auto a : exprsToCompute) {
-        if (a->isSum() || a->isAvg()) {
+        if (a->isAgg()) {
             projections.push_back("[" + to_string(hash<string>()(a->toString()))+ "]");
         }
         else {
@@ -72,47 +173,226 @@ MyDB_TableReaderWriterPtr LogicalAggregate :: execute () {
     RegularSelection rsOp(aggregationTable, outputTable, "bool[true]", projections);
     rsOp.run();
 
-    myMgr->killTable(selectionTable->getTable());
+    // a tree or a simple scan's table is a base table, so it stays
+    if (isTempTable)
+        myMgr->killTable(selectionTable->getTable());
     myMgr->killTable(aggregationTable->getTable());
 
     return outputTable;
 }
-// we don't really count the cost of the aggregate, so cost its subplan and return that
+
+bool LogicalAggregate :: inputFitsInRAM () {
+
+	// with one thread, there is nothing to gain from writing the input out
+	if (TaskScheduler :: getMaxThreads () < 2)
+		return false;
+
+	double recordSize = inputOp->estimateRecordSize ();
+	if (recordSize < 0)
+		return false;
+
+	double inputPages = inputOp->cost ().second->getTupleCount () * recordSize / myMgr->getPageSize ();
+	return inputPages <= myMgr->getNumPages () / 2;
+}
+
+// like a join, the cost of the aggregate is the number of tuples (groups) that it outputs
 pair <double, MyDB_StatsPtr> LogicalAggregate :: cost () {
-	return inputOp->cost ();
+	auto input = inputOp->cost ();
+	MyDB_StatsPtr outputStats = input.second->costGroupBy (groupings);
+	return make_pair (input.first + outputStats->getTupleCount (), outputStats);
 }
 	
+// runs the input plan, and then the ORDER BY/LIMIT over its output
+MyDB_TableReaderWriterPtr LogicalTopK :: execute () {
+
+	MyDB_TableReaderWriterPtr inputTable = inputOp->execute ();
+
+	// the output has the same schema as the input
+	MyDB_TableReaderWriterPtr outputTable = make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (
+		outputSpec->getName (), outputSpec->getStorageLoc (), inputTable->getTable ()->getSchema ()), myMgr);
+
+	TopK topKOp (inputTable, outputTable, orderBy, limit);
+	topKOp.run ();
+
+	myMgr->killTable (inputTable->getTable ());
+	return outputTable;
+}
+
+pair <double, MyDB_StatsPtr> LogicalTopK :: cost () {
+	return inputOp->cost ();
+}
+
 // this costs the entire query plan with the join at the top, returning the compute set of statistics for
 // the output.  Note that it recursively costs the left and then the right, before using the statistics from
 // the left and the right to cost the join itself
 pair <double, MyDB_StatsPtr> LogicalJoin :: cost () {
 	auto left = leftInputOp->cost ();
 	auto right = rightInputOp->cost ();
-	MyDB_StatsPtr outputStats = left.second->costJoin (outputSelectionPredicate, right.second);
+
+	// costing eats the list of predicates, so give it a copy
+	vector <ExprTreePtr> preds = outputSelectionPredicate;
+	MyDB_StatsPtr outputStats = left.second->costJoin (preds, right.second);
 	return make_pair (left.first + right.first + outputStats->getTupleCount (), outputStats);
 }
-	
-// Fill this out!  This should recursively execute the left hand side, and then the right hand side, and then
-// it should heuristically choose whether to do a scan join or a sort-merge join (if it chooses a scan join, it
-// should use a heuristic to choose which input is to be hashed and which is to be scanned), and execute the join.
-// Note that after the left and right hand sides have been executed, the temporary tables associated with the two 
-// sides should be deleted (via a kill to killFile () on the buffer manager)
-MyDB_TableReaderWriterPtr LogicalJoin :: execute () {
-	MyDB_TableReaderWriterPtr outputTable = make_shared<MyDB_TableReaderWriter>(outputSpec, myMgr);
 
-    MyDB_TableReaderWriterPtr leftTable = leftInputOp->execute();
-    MyDB_TableReaderWriterPtr rightTable = rightInputOp->execute();
+// ands together all of the predicates in the list
+static string buildConjunction (vector <ExprTreePtr> preds) {
 
-    int minPageNum = min (leftTable->getNumPages(), rightTable->getNumPages());
+	if (preds.size () == 0)
+		return "bool[true]";
+
+	string returnVal = preds.back ()->toString ();
+	preds.pop_back ();
+	while (preds.size () >= 1) {
+		returnVal = "&& (" + returnVal + ", " + preds.back ()->toString () + ")";
+		preds.pop_back ();
+	}
+	return returnVal;
+}
+
+// returns true if the computation is just one of the attributes in the schema
+static bool isAttOf (MyDB_SchemaPtr schema, string computation) {
+	for (auto &a : schema->getAtts ()) {
+		if ("[" + a.first + "]" == computation)
+			return true;
+	}
+	return false;
+}
+
+// a lookup in a B+-Tree is (about) one random page read, while scanning is all sequential reads, so
+// we count each lookup as this many pages
+#define INDEX_LOOKUP_COST 2.0
+
+MyDB_BPlusTreeReaderWriterPtr LogicalJoin :: findOrderedTree (LogicalOpPtr innerOp, ExprTreePtr &outerAtt) {
+
+	// the inner side has to be a scan over a B+-Tree
+	shared_ptr <LogicalTableScan> innerScan = dynamic_pointer_cast <LogicalTableScan> (innerOp);
+	if (innerScan == nullptr || innerScan->getBPlusTree () == nullptr)
+		return nullptr;
+
+	// and one of the join predicates has to check the tree's ordering attribute against an attribute on the outer side
+	MyDB_BPlusTreeReaderWriterPtr tree = innerScan->getBPlusTree ();
+	string innerKey = "[" + tree->getOrderingAttName () + "]";
+	outerAtt = nullptr;
+	for (auto &predicate : outputSelectionPredicate) {
+		if (!predicate->isEq () || !predicate->getLHS ()->isId () || !predicate->getRHS ()->isId ())
+			continue;
+
+		if (predicate->getLHS ()->toString () == innerKey) {
+			outerAtt = predicate->getRHS ();
+		} else if (predicate->getRHS ()->toString () == innerKey) {
+			outerAtt = predicate->getLHS ();
+		}
+	}
+
+	if (outerAtt == nullptr || outerAtt->toString () == innerKey)
+		return nullptr;
+
+	return tree;
+}
+
+void LogicalJoin :: runWithTree (LogicalOpPtr outerOp, LogicalOpPtr innerOp, ExprTreePtr outerAtt,
+	MyDB_TableReaderWriterPtr outputTable, string finalPredicate) {
+
+	shared_ptr <LogicalTableScan> innerScan = dynamic_pointer_cast <LogicalTableScan> (innerOp);
+	MyDB_BPlusTreeReaderWriterPtr tree = innerScan->getBPlusTree ();
+	string outerKey = outerAtt->toString ();
+	string outerPredicate;
+	MyDB_TableReaderWriterPtr outerTable = getInput (outerOp, tree->getTable ()->getSchema (), outerPredicate);
+
+	// if we probe or merge with the tree, the join is run over the tree's records, and not the scan's output,
+	// so it has all of the tree's attributes... we can only do this if none of them have the same name as
+	// an outer one
+	MyDB_SchemaPtr outerSchema = outerTable->getTable ()->getSchema ();
+	bool canUseTree = isAttOf (outerSchema, outerKey);
+	for (auto &a : tree->getTable ()->getSchema ()->getAtts ()) {
+		if (isAttOf (outerSchema, "[" + a.first + "]"))
+			canUseTree = false;
+	}
+
+	// cost everything in pages... all of the plans read the outer side, and the probing and
+	// merging plans need it sorted (if the outer side is a table that has not been selected yet,
+	// only the selected part of it is sorted)
+	MyDB_StatsPtr outerStats = outerOp->cost ().second;
+	double outerPages = outerTable->getNumPages ();
+	double outerSelectedPages = outerPages;
+	double outerTuples = outerTable->getTable ()->getTupleCount ();
+	if (outerPredicate != "bool[true]" && outerTuples > 0)
+		outerSelectedPages *= min (1.0, outerStats->getTupleCount () / outerTuples);
+	double treePages = tree->getNumPages ();
+	double bufferPages = myMgr->getNumPages () / 2;
+	double outerSortCost = outerSelectedPages <= bufferPages ? 0 : 2 * outerSelectedPages;
+
+	// to probe the tree, there is a lookup for each distinct key on the outer side, but since the lookups
+	// are done in sorted order, no leaf page is read more than once
+	double numLookups = outerStats->getTupleCount ();
+	double numKeys = outerStats->getAttVals (outerAtt->getId ());
+	if (numKeys > 0 && numKeys < numLookups)
+		numLookups = numKeys;
+	double probeCost = outerPages + outerSortCost + min (numLookups, treePages) * INDEX_LOOKUP_COST;
+
+	// to merge with the tree, we just read it in order
+	double mergeCost = outerPages + outerSortCost + treePages;
+
+	// to hash, we scan the tree, write out the result, and read it back in to join it (partitioning
+	// both sides if neither fits in RAM)
+	double treeTuples = tree->getTable ()->getTupleCount ();
+	double scanPages = treePages;
+	if (treeTuples > 0)
+		scanPages *= min (1.0, innerScan->cost ().second->getTupleCount () / treeTuples);
+	double hashCost = outerPages + treePages + 2 * scanPages;
+	if (min (outerSelectedPages, scanPages) > bufferPages)
+		hashCost += 2 * (outerSelectedPages + scanPages);
+
+	if (canUseTree && probeCost <= mergeCost && probeCost <= hashCost) {
+		IndexNestedLoopJoin indexJoin (outerTable, tree, outputTable, finalPredicate, exprsToCompute, outerKey,
+			outerPredicate, innerScan->getSelectionPredicate ());
+		indexJoin.run ();
+
+	} else if (canUseTree && mergeCost <= hashCost) {
+		vector <pair <string, string>> equalityChecks = getEqualityChecks (outerTable);
+		SortMergeJoin mergeJoin (outerTable, tree, outputTable, finalPredicate, exprsToCompute,
+			equalityChecks, outerPredicate, innerScan->getSelectionPredicate ());
+		mergeJoin.run ();
+
+		// the output comes out in the order that the join merged on... that is the tree's ordering attribute,
+		// unless the tree is too small to bother reading in order, in which case it is the first of the checks
+		pair <string, string> mergedOn = make_pair (outerKey, "[" + tree->getOrderingAttName () + "]");
+		if (tree->getNumPages () < 2)
+			mergedOn = equalityChecks[0];
+
+		// if the output has the attribute that was merged on, then the output is sorted on it
+		vector <pair <string, MyDB_AttTypePtr>> outputAtts = outputSpec->getSchema ()->getAtts ();
+		for (size_t i = 0; i < exprsToCompute.size () && i < outputAtts.size (); i++) {
+			if (exprsToCompute[i] == mergedOn.first || exprsToCompute[i] == mergedOn.second) {
+				outputOrder = "[" + outputAtts[i].first + "]";
+				break;
+			}
+		}
+
+	} else {
+		MyDB_TableReaderWriterPtr innerTable = innerOp->execute ();
+		runHashJoin (outerTable, innerTable, outputTable, finalPredicate, outerPredicate, "bool[true]",
+			outerStats->getTupleCount (), innerScan->cost ().second->getTupleCount ());
+		myMgr->killTable (innerTable->getTable ());
+	}
+
+	killInput (outerOp, outerTable);
+}
+
+vector <pair <string, string>> LogicalJoin :: getEqualityChecks (MyDB_TableReaderWriterPtr leftTable) {
+    return getEqualityChecks (leftTable->getTable()->getSchema());
+}
+
+vector <pair <string, string>> LogicalJoin :: getEqualityChecks (MyDB_SchemaPtr leftSchema) {
 
     vector<pair<string, string>> equalityChecks;
-    string finalPredicate;
     for (auto& predicate : outputSelectionPredicate) {
         if (predicate->isEq()) {
             string lhs = predicate->getLHS()->toString();
             string rhs = predicate->getRHS()->toString();
             // if LHS of equality is attribute of left table
-            if (leftTable->getTable()->getSchema()->getAttByName(lhs).first != -1) {
+            if (isAttOf (leftSchema, lhs)) {
                 equalityChecks.push_back(make_pair(lhs, rhs));
             }
             else {
@@ -120,66 +400,431 @@ MyDB_TableReaderWriterPtr LogicalJoin :: execute () {
             }
         }
     }
+    return equalityChecks;
+}
+
+void LogicalJoin :: runHashJoin (MyDB_TableReaderWriterPtr leftTable, MyDB_TableReaderWriterPtr rightTable,
+	MyDB_TableReaderWriterPtr outputTable, string finalPredicate, string leftPredicate, string rightPredicate,
+	double leftEstimate, double rightEstimate) {
+
+    int minPageNum = min (leftTable->getNumPages(), rightTable->getNumPages());
+    vector<pair<string, string>> equalityChecks = getEqualityChecks (leftTable);
 
-    if (outputSelectionPredicate.size() == 0) {
-        finalPredicate = "bool[true]";
+    if (minPageNum <= myMgr->getNumPages() / 2) {
+        ParallelHashJoin parallelHashJoin(leftTable, rightTable, outputTable, finalPredicate, exprsToCompute, equalityChecks, leftPredicate, rightPredicate);
+        parallelHashJoin.run();
     }
     else {
-        finalPredicate = outputSelectionPredicate.back()->toString();
-        outputSelectionPredicate.pop_back();
-        while (outputSelectionPredicate.size() >= 1) {
-            finalPredicate = "&& (" + finalPredicate + ", " + outputSelectionPredicate.back()->toString() + ")";
-            outputSelectionPredicate.pop_back();
-        }
+        // neither side is sure to fit in RAM, so let the join figure out what to do as it sees the data
+        AdaptiveJoin adaptiveJoin(leftTable, rightTable, outputTable, finalPredicate, exprsToCompute, equalityChecks,
+            leftPredicate, rightPredicate, leftEstimate, rightEstimate);
+        adaptiveJoin.run();
     }
+}
 
+MyDB_TableReaderWriterPtr LogicalJoin :: getInput (LogicalOpPtr op, MyDB_SchemaPtr otherSchema, string &selectionPredicate) {
+
+	shared_ptr <LogicalTableScan> scan = dynamic_pointer_cast <LogicalTableScan> (op);
+	if (scan != nullptr && scan->isSimpleScan ()) {
+		MyDB_TableReaderWriterPtr inputTable = scan->getInputTable ();
+		bool canUseTable = true;
+		for (auto &a : inputTable->getTable ()->getSchema ()->getAtts ()) {
+			if (isAttOf (otherSchema, "[" + a.first + "]"))
+				canUseTable = false;
+		}
+
+		if (canUseTable) {
+			selectionPredicate = scan->getSelectionPredicate ();
+			return inputTable;
+		}
+	}
+
+	selectionPredicate = "bool[true]";
+	return op->execute ();
+}
 
-    if (minPageNum <= myMgr->getNumPages() / 2) {
-        ScanJoin scanJoin(leftTable, rightTable, outputTable, finalPredicate, exprsToCompute, equalityChecks, "bool[true]", "bool[true]");
-        scanJoin.run();
+void LogicalJoin :: killInput (LogicalOpPtr op, MyDB_TableReaderWriterPtr input) {
+	shared_ptr <LogicalTableScan> scan = dynamic_pointer_cast <LogicalTableScan> (op);
+	if (scan == nullptr || scan->getInputTable () != input)
+		myMgr->killTable (input->getTable ());
+}
+	
+// runs the join.  If one side is a scan over a B+-Tree ordered on a join attribute, the tree is either probed or
+// merged with (see runWithTree).  Otherwise both inputs are gotten (see getInput), and they are joined with a
+// ParallelHashJoin if the smaller one fits in half of the buffer pool, or with an AdaptiveJoin if neither is sure
+// to.  Inputs that were written out are killed once the join is done
+MyDB_TableReaderWriterPtr LogicalJoin :: execute () {
+	MyDB_TableReaderWriterPtr outputTable = make_shared<MyDB_TableReaderWriter>(outputSpec, myMgr);
+	outputOrder = "";
+
+    string finalPredicate = buildConjunction (outputSelectionPredicate);
+
+    // if one side is a B+-Tree ordered on a join attribute, it may be cheaper to probe it, or to merge
+    // with it in order, than to scan it
+    ExprTreePtr outerAtt;
+    if (findOrderedTree (rightInputOp, outerAtt) != nullptr) {
+        runWithTree (leftInputOp, rightInputOp, outerAtt, outputTable, finalPredicate);
+        return outputTable;
     }
-    else {
-        SortMergeJoin sortMergeJoin(leftTable, rightTable, outputTable, finalPredicate, exprsToCompute, equalityChecks.back(), "bool[true]", "bool[true]");
-        sortMergeJoin.run();
+    if (findOrderedTree (leftInputOp, outerAtt) != nullptr) {
+        runWithTree (rightInputOp, leftInputOp, outerAtt, outputTable, finalPredicate);
+        return outputTable;
     }
 
-    myMgr->killTable(leftTable->getTable());
-    myMgr->killTable(rightTable->getTable());
+    // a scan on either side is run by the join itself, as it reads the scan's table
+    string leftPredicate, rightPredicate;
+    MyDB_TableReaderWriterPtr leftTable = getInput (leftInputOp, rightInputOp->getOutputSchema (), leftPredicate);
+    MyDB_TableReaderWriterPtr rightTable = getInput (rightInputOp, leftTable->getTable ()->getSchema (), rightPredicate);
+
+    runHashJoin (leftTable, rightTable, outputTable, finalPredicate, leftPredicate, rightPredicate,
+        leftInputOp->cost ().second->getTupleCount (), rightInputOp->cost ().second->getTupleCount ());
+
+    killInput (leftInputOp, leftTable);
+    killInput (rightInputOp, rightTable);
     return outputTable;
 
 }
 
+string LogicalJoin :: getOutputOrder () {
+	return outputOrder;
+}
+
+// a join with a B+-Tree on one side may be run using the tree's order, so it is not pipelined
+double LogicalJoin :: estimateRecordSize () {
+	double leftSize = leftInputOp->estimateRecordSize ();
+	double rightSize = rightInputOp->estimateRecordSize ();
+	if (leftSize < 0 || rightSize < 0)
+		return -1;
+	return leftSize + rightSize;
+}
+
+bool LogicalJoin :: isPipelined () {
+	ExprTreePtr outerAtt;
+	return findOrderedTree (leftInputOp, outerAtt) == nullptr && findOrderedTree (rightInputOp, outerAtt) == nullptr;
+}
+
+void LogicalJoin :: produce (MyDB_RecordPtr intoMe, function <void ()> consume) {
+
+	if (!isPipelined ()) {
+		LogicalOp :: produce (intoMe, consume);
+		return;
+	}
+	outputOrder = "";
+
+	// hash the side that is expected to be smaller
+	double leftEstimate = leftInputOp->cost ().second->getTupleCount ();
+	double rightEstimate = rightInputOp->cost ().second->getTupleCount ();
+	bool buildLeft = (leftEstimate <= rightEstimate);
+	LogicalOpPtr buildOp = buildLeft ? leftInputOp : rightInputOp;
+	LogicalOpPtr probeOp = buildLeft ? rightInputOp : leftInputOp;
+	MyDB_SchemaPtr buildSchema = buildOp->getOutputSchema ();
+	MyDB_SchemaPtr probeSchema = probeOp->getOutputSchema ();
+
+	// get the records that the two sides are pushed into, and hash them on the join keys
+	MyDB_RecordPtr buildRec = make_shared <MyDB_Record> (buildSchema);
+	MyDB_RecordPtr probeRec = make_shared <MyDB_Record> (probeSchema);
+	vector <string> buildKeys, probeKeys;
+	for (auto &p : getEqualityChecks (buildSchema)) {
+		buildKeys.push_back (p.first);
+		probeKeys.push_back (p.second);
+	}
+	function <size_t ()> buildHash = buildKeyHasher (buildRec, buildKeys);
+	function <size_t ()> probeHash = buildKeyHasher (probeRec, probeKeys);
+
+	// the build side is copied into pinned pages, until it takes up half of the buffer pool; at that point,
+	// everything is written out to a table instead
+	size_t budget = myMgr->getNumPages () / 2;
+	vector <MyDB_PageReaderWriter> pagesInRAM;
+	vector <size_t> hashes;
+	vector <void *> recs;
+	MyDB_TableReaderWriterPtr buildTable = nullptr;
+	buildOp->produce (buildRec, [&] () {
+
+		if (buildTable != nullptr) {
+			buildTable->append (buildRec);
+			return;
+		}
+
+		void *loc = nullptr;
+		if (pagesInRAM.size () > 0)
+			loc = pagesInRAM.back ().appendAndReturnLocation (buildRec);
+
+		if (loc == nullptr && pagesInRAM.size () < budget) {
+			pagesInRAM.push_back (MyDB_PageReaderWriter (true, *myMgr));
+			loc = pagesInRAM.back ().appendAndReturnLocation (buildRec);
+		}
+
+		if (loc != nullptr) {
+			recs.push_back (loc);
+			hashes.push_back (buildHash ());
+			return;
+		}
+
+		// we are out of RAM, so write out everything so far, and let the pinned pages go
+		buildTable = make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (outputSpec->getName () + "_build",
+			outputSpec->getStorageLoc () + "_build", buildSchema), myMgr);
+		MyDB_RecordPtr spillRec = make_shared <MyDB_Record> (buildSchema);
+		MyDB_RecordIteratorAltPtr spillIter = getIteratorAlt (pagesInRAM);
+		while (spillIter->advance ()) {
+			spillIter->getCurrent (spillRec);
+			buildTable->append (spillRec);
+		}
+		buildTable->append (buildRec);
+		vector <MyDB_PageReaderWriter> ().swap (pagesInRAM);
+		vector <void *> ().swap (recs);
+		vector <size_t> ().swap (hashes);
+	});
+
+	string finalPredicate = buildConjunction (outputSelectionPredicate);
+
+	// if the build side did not fit, run the whole join, and read back its output
+	if (buildTable != nullptr) {
+		string probePredicate;
+		MyDB_TableReaderWriterPtr probeTable = getInput (probeOp, buildSchema, probePredicate);
+		MyDB_TableReaderWriterPtr outputTable = make_shared <MyDB_TableReaderWriter> (outputSpec, myMgr);
+		runHashJoin (buildTable, probeTable, outputTable, finalPredicate, "bool[true]", probePredicate,
+			buildLeft ? leftEstimate : rightEstimate, buildLeft ? rightEstimate : leftEstimate);
+		myMgr->killTable (buildTable->getTable ());
+		killInput (probeOp, probeTable);
+
+		MyDB_RecordIteratorAltPtr myIter = outputTable->getIteratorAlt ();
+		while (myIter->advance ()) {
+			myIter->getCurrent (intoMe);
+			consume ();
+		}
+		myMgr->killTable (outputTable->getTable ());
+		return;
+	}
+
+	RecordHashTable myHash (hashes.size ());
+	myHash.insertBatch (hashes, recs);
+
+	// get the record that combines the two sides, and compile the predicate and the projections over it
+	MyDB_SchemaPtr combinedSchema = make_shared <MyDB_Schema> ();
+	for (auto &p : buildSchema->getAtts ())
+		combinedSchema->appendAtt (p);
+	for (auto &p : probeSchema->getAtts ())
+		combinedSchema->appendAtt (p);
+	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (combinedSchema);
+	combinedRec->buildFrom (buildRec, probeRec);
+	func finalPred = combinedRec->compileComputation (finalPredicate);
+	vector <func> projections;
+	for (string &s : exprsToCompute) {
+		projections.push_back (combinedRec->compileComputation (s));
+	}
+
+	// and push the other side through the hash table
+	probeOp->produce (probeRec, [&] () {
+		for (long e = myHash.find (probeHash ()); e != -1; e = myHash.getNext (e)) {
+
+			buildRec->fromBinary (myHash.getRecord (e));
+			if (!finalPred ()->toBool ()) {
+				continue;
+			}
+
+			int i = 0;
+			for (auto &f : projections) {
+				intoMe->getAtt (i++)->set (f ());
+			}
+			intoMe->recordContentHasChanged ();
+			consume ();
+		}
+	});
+}
+
 // this costs the table scan returning the compute set of statistics for the output
 pair <double, MyDB_StatsPtr> LogicalTableScan :: cost () {
-	MyDB_StatsPtr returnVal = inputStats->costSelection (selectionPred);
+
+	// costing eats the list of predicates, so give it a copy
+	vector <ExprTreePtr> preds = selectionPred;
+	MyDB_StatsPtr returnVal = inputStats->costSelection (preds);
 	return make_pair (returnVal->getTupleCount (), returnVal);	
 }
 
-// fill this out!  This should heuristically choose whether to use a B+-Tree (if appropriate) or just a regular
-// table scan, and then execute the table scan using a relational selection.  Note that a desirable optimization
-// is to somehow set things up so that if a B+-Tree is NOT used, that the table scan does not actually do anything,
-// and the selection predicate is handled at the level of the parent (by filtering, for example, the data that is
-// input into a join)
+MyDB_BPlusTreeReaderWriterPtr LogicalTableScan :: getBPlusTree () {
+	return dynamic_pointer_cast <MyDB_BPlusTreeReaderWriter> (inputSpec);
+}
+
+string LogicalTableScan :: getSelectionPredicate () {
+	return buildConjunction (selectionPred);
+}
+
+double LogicalTableScan :: estimateRecordSize () {
+	double tuples = inputSpec->getTable ()->getTupleCount ();
+	if (tuples <= 0)
+		return -1;
+	return inputSpec->getNumPages () * (double) myMgr->getPageSize () / tuples;
+}
+
+bool LogicalTableScan :: isSimpleScan () {
+
+	if (getBPlusTree () != nullptr)
+		return false;
+
+	vector <pair <string, MyDB_AttTypePtr>> &outputAtts = outputSpec->getSchema ()->getAtts ();
+	if (outputAtts.size () != exprsToCompute.size ())
+		return false;
+
+	for (size_t i = 0; i < outputAtts.size (); i++) {
+		if (exprsToCompute[i] != "[" + outputAtts[i].first + "]" || !isAttOf (inputSpec->getTable ()->getSchema (), exprsToCompute[i]))
+			return false;
+	}
+	return true;
+}
+
+void LogicalTableScan :: produce (MyDB_RecordPtr intoMe, function <void ()> consume) {
+
+	MyDB_RecordPtr inputRec = inputSpec->getEmptyRecord ();
+	vector <func> projections;
+	for (string &s : exprsToCompute) {
+		projections.push_back (inputRec->compileComputation (s));
+	}
+	func pred = inputRec->compileComputation (getSelectionPredicate ());
+
+	// if it is cheaper, only read the range of the tree that the predicate asks for
+	MyDB_AttValPtr low, high;
+	MyDB_RecordIteratorAltPtr myIter;
+	if (getKeyRange (low, high))
+		myIter = getBPlusTree ()->getRangeIteratorAlt (low, high);
+	else
+		myIter = inputSpec->getIteratorAlt ();
+
+	while (myIter->advance ()) {
+
+		myIter->getCurrent (inputRec);
+		if (!pred ()->toBool ()) {
+			continue;
+		}
+
+		int i = 0;
+		for (auto &f : projections) {
+			intoMe->getAtt (i++)->set (f ());
+		}
+		intoMe->recordContentHasChanged ();
+		consume ();
+	}
+}
+
+// returns true if a is less than b, when both are compared as the given type
+static bool isLessThan (MyDB_AttTypePtr type, MyDB_AttValPtr a, MyDB_AttValPtr b) {
+	if (type->promotableToInt ())
+		return a->toInt () < b->toInt ();
+	else if (type->promotableToDouble ())
+		return a->toDouble () < b->toDouble ();
+	else
+		return a->toString () < b->toString ();
+}
+
+bool LogicalTableScan :: getKeyRange (MyDB_AttValPtr &low, MyDB_AttValPtr &high) {
+
+	MyDB_BPlusTreeReaderWriterPtr tree = getBPlusTree ();
+	if (tree == nullptr)
+		return false;
+
+	// the tree's comparator treats the key as an int, a double, or a string
+	MyDB_RecordPtr inputRec = inputSpec->getEmptyRecord ();
+	string keyAtt = "[" + tree->getOrderingAttName () + "]";
+	MyDB_AttTypePtr keyType = inputRec->getType (keyAtt);
+	if (keyType->isBool ())
+		return false;
+
+	low = nullptr;
+	high = nullptr;
+	vector <ExprTreePtr> rangePreds;
+	for (auto &predicate : selectionPred) {
+
+		if (!predicate->isEq () && !predicate->isLTGT ())
+			continue;
+
+		// one side has to be the key, and the other has to be a constant
+		ExprTreePtr constant;
+		bool keyOnLeft;
+		if (predicate->getLHS ()->toString () == keyAtt && predicate->getRHS ()->getId () == "") {
+			constant = predicate->getRHS ();
+			keyOnLeft = true;
+		} else if (predicate->getRHS ()->toString () == keyAtt && predicate->getLHS ()->getId () == "") {
+			constant = predicate->getLHS ();
+			keyOnLeft = false;
+		} else {
+			continue;
+		}
+
+		// and the constant has to compare the same way that the tree does... so an int key can only be checked
+		// against an int, and a string key only against a string
+		MyDB_AttTypePtr constType = inputRec->getType (constant->toString ());
+		if (keyType->promotableToInt ()) {
+			if (!constType->promotableToInt ())
+				continue;
+		} else if (keyType->promotableToDouble ()) {
+			if (!constType->promotableToDouble ())
+				continue;
+		} else if (constType->promotableToDouble () || constType->isBool ()) {
+			continue;
+		}
+
+		MyDB_AttValPtr val = inputRec->compileComputation (constant->toString ()) ()->getCopy ();
+
+		// key = c bounds both sides; key < c and c > key bound the top; key > c and c < key bound the bottom
+		bool isLow = predicate->isEq () || predicate->isLT () != keyOnLeft;
+		bool isHigh = predicate->isEq () || predicate->isLT () == keyOnLeft;
+		if (isLow && (low == nullptr || isLessThan (keyType, low, val)))
+			low = val;
+		if (isHigh && (high == nullptr || isLessThan (keyType, val, high)))
+			high = val;
+		rangePreds.push_back (predicate);
+	}
+
+	if (rangePreds.size () == 0)
+		return false;
+
+	// fill in a missing bound with the smallest or largest key... there is no largest string, so a string
+	// key has to be bounded on the top
+	if (high == nullptr) {
+		if (!keyType->promotableToDouble ())
+			return false;
+		high = keyType->createAttMax ();
+	}
+	if (low == nullptr) {
+		low = keyType->createAtt ();
+		if (keyType->promotableToInt ())
+			static_pointer_cast <MyDB_IntAttVal> (low)->set (INT_MIN);
+		else if (keyType->promotableToDouble ())
+			static_pointer_cast <MyDB_DoubleAttVal> (low)->set (-numeric_limits <double> :: max ());
+		else
+			static_pointer_cast <MyDB_StringAttVal> (low)->set ("");
+	}
+
+	// an empty range is as cheap as it gets... the tree can't look up a range whose bottom is above its top, so
+	// just look up the one key (the predicate throws it out anyway)
+	if (isLessThan (keyType, high, low)) {
+		high = low;
+		return true;
+	}
+
+	// looking up the range costs about one random read, plus reading the part of the leaves that the range
+	// covers; the stats tell us how much of the table that is
+	double treePages = tree->getNumPages ();
+	double tuples = inputStats->getTupleCount ();
+	double fraction = 1.0;
+	if (tuples > 0)
+		fraction = min (1.0, inputStats->costSelection (rangePreds)->getTupleCount () / tuples);
+
+	return INDEX_LOOKUP_COST + fraction * treePages < treePages;
+}
+
+// if the scan is over a B+-Tree and the selection predicate picks out a small enough range of the key, only that
+// range is read; otherwise, the whole input is scanned.  Either way, the whole predicate is run over what is read
 MyDB_TableReaderWriterPtr LogicalTableScan :: execute () {
 	MyDB_TableReaderWriterPtr outputTable = make_shared<MyDB_TableReaderWriter>(outputSpec, myMgr);
 
-    string predicate;
-
-    // there is no prediction
-    if (selectionPred.size() == 0) {
-        predicate = "bool[true]";
+    MyDB_AttValPtr low, high;
+    if (getKeyRange (low, high)) {
+        BPlusSelection myOp (getBPlusTree (), outputTable, low, high, getSelectionPredicate (), exprsToCompute);
+        myOp.run ();
+    } else {
+        ParallelSelection myOp (inputSpec, outputTable, getSelectionPredicate (), exprsToCompute);
+        myOp.run ();
     }
-    else {
-        predicate = selectionPred.back()->toString();
-        selectionPred.pop_back();
-        while (selectionPred.size() >= 1) {
-            predicate = "&& (" + predicate + ", " + selectionPred.back()->toString() + ")";
-            selectionPred.pop_back();
-        }
-    }
-
-    RegularSelection myOp(inputSpec, outputTable, predicate, exprsToCompute);
-    myOp.run();
 
     return outputTable;
 }
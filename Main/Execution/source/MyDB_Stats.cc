@@ -149,6 +149,35 @@ MyDB_StatsPtr MyDB_Stats :: costSelection (vector <ExprTreePtr> &allDisjunctions
 	
 }
 
+MyDB_StatsPtr MyDB_Stats :: costGroupBy (vector <ExprTreePtr> &groupings) {
+
+	// there can't be more groups than the product of the number of values of each of the grouping atts, or
+	// more groups than tuples... if we don't know how many values a grouping computation has, it could be
+	// anything, so we just use the number of tuples
+	MyDB_StatsPtr returnVal = make_shared <MyDB_Stats> ();
+	double groupCount = (tupleCount > 0) ? 1 : 0;
+	for (auto &g : groupings) {
+		double vals = g->isId () ? getAttVals (g->getId ()) : 0;
+		if (vals < 0.0000001)
+			vals = tupleCount;
+		groupCount *= vals;
+		if (groupCount > tupleCount)
+			groupCount = tupleCount;
+	}
+	returnVal->tupleCount = groupCount;
+
+	for (auto &g : groupings) {
+		if (!g->isId ())
+			continue;
+		double vals = getAttVals (g->getId ());
+		if (vals > groupCount)
+			vals = groupCount;
+		returnVal->allAtts.push_back (make_pair (vals, g->getId ()));
+	}
+
+	cout << "group by: in tuples was " << tupleCount << " and out is " << groupCount << "\n";
+	return returnVal;
+}
 
 MyDB_StatsPtr MyDB_Stats ::  costJoin (vector <ExprTreePtr> &allDisjunctions, MyDB_StatsPtr RHS) {
 
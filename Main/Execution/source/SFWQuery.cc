@@ -6,13 +6,14 @@
 	
 // builds and optimizes a logical query plan for a SFW query, returning the logical query plan
 // 
-// note that this implementation only works for two-table queries that do not have an aggregation
+// for two or more tables, the join order is chosen by buildLogicalMultipleTablesPlan
 // 
 LogicalOpPtr SFWQuery :: buildLogicalQueryPlan (map <string, MyDB_TablePtr> &allTables, map <string, MyDB_TableReaderWriterPtr> &allTableReaderWriters,
                                                 MyDB_BufferManagerPtr myMgr) {
 
-	if (tablesToProcess.size () > 2) {
-		cout << "Sorry, this currently only works for less-or-equals-two-table queries!\n";
+	// the join enumeration keeps track of sets of tables using the bits of an unsigned int
+	if (tablesToProcess.size () > 32) {
+		cout << "Sorry, this currently only works for queries over at most 32 tables!\n";
 		return nullptr;
 	}
 
@@ -26,18 +27,54 @@ LogicalOpPtr SFWQuery :: buildLogicalQueryPlan (map <string, MyDB_TablePtr> &all
     if (tablesToProcess.size() == 1) {
         // there is aggregation in the sql
         if (groupingClauses.size() != 0 || areAggs) {
-            return buildLogicalOneTableWithAggQueryPlan(allTables, allTableReaderWriters, myMgr);
+            return addOrderByAndLimit(buildLogicalOneTableWithAggQueryPlan(allTables, allTableReaderWriters, myMgr), true, myMgr);
         }
 
         else {
-            return buildLogicalOneTableQueryPlan(allTables, allTableReaderWriters, myMgr);
+            return addOrderByAndLimit(buildLogicalOneTableQueryPlan(allTables, allTableReaderWriters, myMgr), false, myMgr);
         }
     }
 
-    else if (tablesToProcess.size() == 2) {
-        return buildLogicalMultipleTablesPlan(allTables, allTableReaderWriters, myMgr);
+    else {
+        return addOrderByAndLimit(buildLogicalMultipleTablesPlan(allTables, allTableReaderWriters, myMgr), true, myMgr);
+    }
+
+}
+
+LogicalOpPtr SFWQuery::addOrderByAndLimit(LogicalOpPtr plan, bool outputIsSelectList, MyDB_BufferManagerPtr myMgr) {
+
+    if (plan == nullptr || (orderingClauses.size() == 0 && limit < 0)) {
+        return plan;
+    }
+
+    // figure out how to compute each of the values we sort on over the output of the plan
+    vector <pair <string, bool>> orderBy;
+    for (auto &o : orderingClauses) {
+
+        // the plan output is just the base table atts, so we can compute the value directly
+        if (!outputIsSelectList) {
+            orderBy.push_back(make_pair(o.first->toString(), o.second));
+            continue;
+        }
+
+        // otherwise, we need to find the value in the SELECT clause
+        int which = -1;
+        for (size_t i = 0; i < valuesToSelect.size(); i++) {
+            if (valuesToSelect[i]->toString() == o.first->toString()) {
+                which = (int) i;
+                break;
+            }
+        }
+
+        if (which == -1) {
+            cout << "Sorry, ORDER BY " << o.first->toString() << " must also appear in the SELECT clause!\n";
+            return nullptr;
+        }
+        orderBy.push_back(make_pair("[att_" + to_string(which) + "]", o.second));
     }
 
+    return make_shared<LogicalTopK>(plan, make_shared<MyDB_Table>("orderedTable", "orderedStorageLoc", nullptr),
+                                    orderBy, limit, myMgr);
 }
 
 LogicalOpPtr SFWQuery::buildLogicalOneTableQueryPlan(map<string, MyDB_TablePtr> &allTables,
@@ -55,6 +92,11 @@ LogicalOpPtr SFWQuery::buildLogicalOneTableQueryPlan(map<string, MyDB_TablePtr>
                 needIt = true;
             }
         }
+        for (auto a : orderingClauses) {
+            if (a.first->referencesAtt(tablesToProcess[0].second, b.first)){
+                needIt = true;
+            }
+        }
 
         if (needIt) {
             outputSchema->getAtts().push_back(b);
@@ -108,7 +150,7 @@ LogicalOpPtr SFWQuery ::buildLogicalOneTableWithAggQueryPlan(map<string, MyDB_Ta
 
     int i = 0;
     for (auto a : valuesToSelect) {
-        if (a->isSum()) {
+        if (a->isSum() || a->isMin() || a->isMax()) {
             outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->getChild()->toString())));
         }
 
@@ -116,6 +158,10 @@ LogicalOpPtr SFWQuery ::buildLogicalOneTableWithAggQueryPlan(map<string, MyDB_Ta
             outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), make_shared <MyDB_DoubleAttType> ()));
         }
 
+        else if (a->isCount() || a->isCountDistinct() || a->isApproxCountDistinct()) {
+            outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), make_shared <MyDB_IntAttType> ()));
+        }
+
         else {
             outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->toString())));
         }
@@ -127,162 +173,437 @@ LogicalOpPtr SFWQuery ::buildLogicalOneTableWithAggQueryPlan(map<string, MyDB_Ta
     return aggregate;
 }
 
-LogicalOpPtr SFWQuery::buildLogicalMultipleTablesPlan(map<string, MyDB_TablePtr> &allTables,
-                                                 map<string, MyDB_TableReaderWriterPtr> &allTableReaderWriters,
-                                                 MyDB_BufferManagerPtr myMgr) {
+unsigned SFWQuery::getTableMask(ExprTreePtr forMe) {
+    unsigned mask = 0;
+    for (size_t i = 0; i < tablesToProcess.size(); i++) {
+        if (forMe->referencesTable(tablesToProcess[i].second)) {
+            mask |= (1u << i);
+        }
+    }
 
-    // find the two input tables
-    MyDB_TablePtr leftTable = allTables[tablesToProcess[0].first];
-    MyDB_TablePtr rightTable = allTables[tablesToProcess[1].first];
-
-    // find the various parts of the CNF
-    vector<ExprTreePtr> leftCNF;
-    vector<ExprTreePtr> rightCNF;
-    vector<ExprTreePtr> topCNF;
-
-    // loop through all of the disjunctions and break them apart
-    for (auto a: allDisjunctions) {
-        bool inLeft = a->referencesTable(tablesToProcess[0].second);
-        bool inRight = a->referencesTable(tablesToProcess[1].second);
-        if (inLeft && inRight) {
-            cout << "top " << a->toString() << "\n";
-            topCNF.push_back(a);
-        } else if (inLeft) {
-            cout << "left: " << a->toString() << "\n";
-            leftCNF.push_back(a);
-        } else {
-            cout << "right: " << a->toString() << "\n";
-            rightCNF.push_back(a);
+    // something like "true" does not reference any table, so we just check it at the first table
+    if (mask == 0) {
+        mask = 1;
+    }
+    return mask;
+}
+
+vector<ExprTreePtr> SFWQuery::getJoinPredicates(unsigned lhsMask, unsigned rhsMask) {
+    vector<ExprTreePtr> returnVal;
+    for (auto a : allDisjunctions) {
+        unsigned mask = getTableMask(a);
+        if ((mask & lhsMask) != 0 && (mask & rhsMask) != 0 && (mask & ~(lhsMask | rhsMask)) == 0) {
+            returnVal.push_back(a);
         }
     }
+    return returnVal;
+}
 
-    // now get the left and right schemas for the two selections
-    MyDB_SchemaPtr leftSchema = make_shared<MyDB_Schema>();
-    MyDB_SchemaPtr rightSchema = make_shared<MyDB_Schema>();
-    MyDB_SchemaPtr totSchema = make_shared<MyDB_Schema>();
-    vector<string> leftExprs;
-    vector<string> rightExprs;
-    vector<string> totExprs;
+void SFWQuery::getNeededAtts(map<string, MyDB_TablePtr> &allTables, unsigned mask, MyDB_SchemaPtr schema,
+                             vector<string> &exprs) {
 
-    // and see what we need from the left, and from the right
-    for (auto b: leftTable->getSchema()->getAtts()) {
-        bool needIt = false;
-        for (auto a: valuesToSelect) {
-            if (a->referencesAtt(tablesToProcess[0].second, b.first)) {
-                needIt = true;
-            }
+    for (size_t i = 0; i < tablesToProcess.size(); i++) {
+        if ((mask & (1u << i)) == 0) {
+            continue;
         }
-        for (auto a: topCNF) {
-            if (a->referencesAtt(tablesToProcess[0].second, b.first)) {
-                needIt = true;
+
+        string alias = tablesToProcess[i].second;
+        for (auto b : allTables[tablesToProcess[i].first]->getSchema()->getAtts()) {
+            bool needIt = false;
+            for (auto a : valuesToSelect) {
+                if (a->referencesAtt(alias, b.first)) {
+                    needIt = true;
+                }
+            }
+            for (auto a : groupingClauses) {
+                if (a->referencesAtt(alias, b.first)) {
+                    needIt = true;
+                }
             }
-        }
-        if (needIt) {
-            leftSchema->getAtts().push_back(make_pair(b.first, b.second));
-            totSchema->getAtts().push_back(make_pair(b.first, b.second));
-            leftExprs.push_back("[" + b.first + "]");
-            totExprs.push_back("[" + b.first + "]");
-            cout << "left expr: " << ("[" + b.first + "]") << "\n";
-        }
-    }
 
-    cout << "left schema: " << leftSchema << "\n";
+            // a predicate that references a table outside of the mask is applied further up the plan
+            for (auto a : allDisjunctions) {
+                if ((getTableMask(a) & ~mask) != 0 && a->referencesAtt(alias, b.first)) {
+                    needIt = true;
+                }
+            }
 
-    // and see what we need from the right, and from the right
-    for (auto b: rightTable->getSchema()->getAtts()) {
-        bool needIt = false;
-        for (auto a: valuesToSelect) {
-            if (a->referencesAtt(tablesToProcess[1].second, b.first)) {
-                needIt = true;
+            if (needIt) {
+                schema->getAtts().push_back(b);
+                exprs.push_back("[" + b.first + "]");
             }
         }
-        for (auto a: topCNF) {
-            if (a->referencesAtt(tablesToProcess[1].second, b.first)) {
-                needIt = true;
+
+        // the partial aggregates are always needed, by the final aggregation
+        if ((int) i == eagerTable) {
+            for (auto &b : eagerAtts) {
+                schema->getAtts().push_back(b);
+                exprs.push_back("[" + b.first + "]");
             }
         }
-        if (needIt) {
-            rightSchema->getAtts().push_back(make_pair(b.first, b.second));
-            totSchema->getAtts().push_back(make_pair(b.first, b.second));
-            rightExprs.push_back("[" + b.first + "]");
-            totExprs.push_back("[" + b.first + "]");
-            cout << "right expr: " << ("[" + b.first + "]") << "\n";
-        }
     }
-    cout << "right schema: " << rightSchema << "\n";
+}
 
-    // now we gotta figure out the top schema... get a record for the top
-    MyDB_Record myRec(totSchema);
+SFWQuery::JoinPlan SFWQuery::buildJoin(map<string, MyDB_TablePtr> &allTables, JoinPlan &lhs, JoinPlan &rhs,
+                                       bool isTop, MyDB_BufferManagerPtr myMgr) {
+
+    unsigned mask = lhs.lhsMask | lhs.rhsMask | rhs.lhsMask | rhs.rhsMask;
+    vector<ExprTreePtr> joinCNF = getJoinPredicates(lhs.lhsMask | lhs.rhsMask, rhs.lhsMask | rhs.rhsMask);
+
+    // cost the join; this is the same as LogicalJoin::cost (), but it re-uses the costs of the two inputs
+    vector<ExprTreePtr> preds = joinCNF;
+    JoinPlan returnVal;
+    returnVal.stats = lhs.stats->costJoin(preds, rhs.stats);
+    returnVal.cost = lhs.cost + rhs.cost + returnVal.stats->getTupleCount();
+    returnVal.lhsMask = lhs.lhsMask | lhs.rhsMask;
+    returnVal.rhsMask = rhs.lhsMask | rhs.rhsMask;
 
-    // and it's time to build the query plan
-    LogicalOpPtr leftTableScan = make_shared<LogicalTableScan>(allTableReaderWriters[tablesToProcess[0].first],
-                                                               make_shared<MyDB_Table>("leftTable", "leftStorageLoc", leftSchema),
-                                                               make_shared<MyDB_Stats>(leftTable, tablesToProcess[0].second),
-                                                               leftCNF, leftExprs, myMgr);
-    LogicalOpPtr rightTableScan = make_shared<LogicalTableScan>(allTableReaderWriters[tablesToProcess[1].first],
-                                                                make_shared<MyDB_Table>("rightTable", "rightStorageLoc", rightSchema),
-                                                                make_shared<MyDB_Stats>(rightTable, tablesToProcess[1].second),
-                                                                rightCNF, rightExprs, myMgr);
+    // see what we need to keep from the inputs
+    MyDB_SchemaPtr joinSchema = make_shared<MyDB_Schema>();
+    vector<string> joinExprs;
+    getNeededAtts(allTables, mask, joinSchema, joinExprs);
 
     bool areAggs = false;
-    for (auto a: valuesToSelect) {
+    for (auto a : valuesToSelect) {
         if (a->hasAgg()) {
             areAggs = true;
         }
     }
 
-    if (groupingClauses.size() != 0 || areAggs) {
-        // there is aggregations in sql
-
-        MyDB_SchemaPtr outputSchema = make_shared<MyDB_Schema>();
+    // if this is the last join and there is no aggregation, we compute the SELECT clause right here
+    if (isTop && groupingClauses.size() == 0 && !areAggs) {
+        MyDB_Record myRec(joinSchema);
+        MyDB_SchemaPtr topSchema = make_shared<MyDB_Schema>();
+        vector<string> exprsToCompute;
         int i = 0;
         for (auto a : valuesToSelect) {
-            if (a->isSum()) {
-                outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->getChild()->toString())));
+            topSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->toString())));
+            exprsToCompute.push_back(a->toString());
+        }
+
+        returnVal.op = make_shared<LogicalJoin>(lhs.op, rhs.op,
+                                                make_shared<MyDB_Table>("topTable", "topStorageLoc", topSchema),
+                                                joinCNF, exprsToCompute, myMgr);
+    } else {
+        returnVal.op = make_shared<LogicalJoin>(lhs.op, rhs.op,
+                                                make_shared<MyDB_Table>("joinTable" + to_string(mask),
+                                                                        "joinStorageLoc" + to_string(mask), joinSchema),
+                                                joinCNF, joinExprs, myMgr);
+    }
+
+    return returnVal;
+}
+
+// the most tables that we will enumerate all of the connected join orders for; past this, we join greedily
+#define MAX_DP_TABLES 8
+
+// finds the cheapest join order for the plans
+SFWQuery::JoinPlan SFWQuery::joinAllTables(map<string, MyDB_TablePtr> &allTables, vector<JoinPlan> &scans,
+                                           MyDB_BufferManagerPtr myMgr) {
+
+    int numTables = scans.size();
+    unsigned allMask = ~0u >> (32 - numTables);
+
+    // if there are not too many tables, find the best plan for each connected set of tables, from the smallest
+    // sets up... the best plan for a set is the cheapest join of the best plans for two pieces of it that have
+    // a predicate in common.  Since the pieces can be any size, the plans can be bushy
+    if (numTables <= MAX_DP_TABLES) {
+
+        map<unsigned, JoinPlan> best;
+        for (int i = 0; i < numTables; i++) {
+            best[1u << i] = scans[i];
+        }
+
+        vector<unsigned> sets;
+        for (unsigned set = 1; set <= allMask; set++) {
+            sets.push_back(set);
+        }
+        stable_sort(sets.begin(), sets.end(), [](unsigned a, unsigned b) {
+            return __builtin_popcount(a) < __builtin_popcount(b);
+        });
+
+        for (unsigned set : sets) {
+            if (__builtin_popcount(set) < 2) {
+                continue;
+            }
+
+            // look at every way to split the set in two (the piece with the lowest table is always on the left,
+            // so that each split is only considered once)
+            unsigned lowest = set & (~set + 1);
+            for (unsigned lhsMask = (set - 1) & set; lhsMask != 0; lhsMask = (lhsMask - 1) & set) {
+                unsigned rhsMask = set & ~lhsMask;
+                if ((lhsMask & lowest) == 0 || best.count(lhsMask) == 0 || best.count(rhsMask) == 0 ||
+                    getJoinPredicates(lhsMask, rhsMask).size() == 0) {
+                    continue;
+                }
+
+                JoinPlan candidate = buildJoin(allTables, best[lhsMask], best[rhsMask], false, myMgr);
+                if (best.count(set) == 0 || candidate.cost < best[set].cost) {
+                    best[set] = candidate;
+                }
+            }
+        }
+
+        // if all of the tables are connected, re-do the last join so that it computes the final output
+        if (best.count(allMask) != 0) {
+            JoinPlan &top = best[allMask];
+            return buildJoin(allTables, best[top.lhsMask], best[top.rhsMask], true, myMgr);
+        }
+    }
+
+    // otherwise, join greedily: repeatedly do the cheapest join of two of the plans that we have so far (using a
+    // cross product only if no pair of plans has a predicate in common)
+    vector<JoinPlan> plans = scans;
+    while (plans.size() > 1) {
+
+        bool isTop = (plans.size() == 2);
+        int bestLHS = -1, bestRHS = -1;
+        bool bestConnected = false;
+        JoinPlan bestPlan;
+        for (size_t i = 0; i < plans.size(); i++) {
+            for (size_t j = i + 1; j < plans.size(); j++) {
+                unsigned lhsMask = plans[i].lhsMask | plans[i].rhsMask;
+                unsigned rhsMask = plans[j].lhsMask | plans[j].rhsMask;
+                bool connected = getJoinPredicates(lhsMask, rhsMask).size() != 0;
+                if (bestConnected && !connected) {
+                    continue;
+                }
+
+                JoinPlan candidate = buildJoin(allTables, plans[i], plans[j], isTop, myMgr);
+                if (bestLHS == -1 || (connected && !bestConnected) || candidate.cost < bestPlan.cost) {
+                    bestLHS = (int) i;
+                    bestRHS = (int) j;
+                    bestConnected = connected;
+                    bestPlan = candidate;
+                }
+            }
+        }
+
+        plans[bestLHS] = bestPlan;
+        plans.erase(plans.begin() + bestRHS);
+    }
+
+    return plans[0];
+}
+
+bool SFWQuery::canAggregateEagerly(int whichTable) {
+
+    bool areAggs = false;
+    for (auto a : valuesToSelect) {
+        if (a->isAgg()) {
+            areAggs = true;
+
+            // a COUNT does not care what it is counting
+            if (a->isCount()) {
+                continue;
             }
 
-            else if (a->isAvg()) {
-                outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), make_shared <MyDB_DoubleAttType> ()));
+            // an AVG or a COUNT (DISTINCT) can't be put back together from partial aggregates
+            if (!a->isSum() && !a->isMin() && !a->isMax()) {
+                return false;
             }
 
-            else {
-                outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->toString())));
+            if (getTableMask(a->getChild()) != (1u << whichTable)) {
+                return false;
             }
+
+        // an aggregate inside of some other computation is not something that we can handle
+        } else if (a->hasAgg()) {
+            return false;
+        }
+    }
+
+    return areAggs;
+}
+
+SFWQuery::JoinPlan SFWQuery::buildEagerAggregate(map<string, MyDB_TablePtr> &allTables, JoinPlan &scan,
+                                                 int whichTable, MyDB_BufferManagerPtr myMgr) {
+
+    // this is the output of the scan, which we need to get the types of the partial aggregates
+    MyDB_SchemaPtr scanSchema = make_shared<MyDB_Schema>();
+    vector<string> scanExprs;
+    getNeededAtts(allTables, 1u << whichTable, scanSchema, scanExprs);
+    MyDB_Record scanRec(scanSchema);
+
+    // each aggregate is computed over the table, and the final aggregate is then computed from that
+    string alias = tablesToProcess[whichTable].second;
+    vector<ExprTreePtr> partialAggs;
+    vector<ExprTreePtr> finalValues;
+    vector<pair<string, MyDB_AttTypePtr>> partialAtts;
+    for (auto a : valuesToSelect) {
+        if (!a->isAgg()) {
+            finalValues.push_back(a);
+            continue;
         }
 
-        LogicalOpPtr joinResult = make_shared<LogicalJoin>(leftTableScan, rightTableScan,
-                                                            make_shared<MyDB_Table>("joinTable", "joinStorageLoc", totSchema),
-                                                                    topCNF, totExprs, myMgr);
+        string attName = "eagerAgg" + to_string(partialAggs.size());
+        ExprTreePtr partialAtt = make_shared<Identifier>(alias, attName);
+        partialAggs.push_back(a);
+        if (a->isCount()) {
+            partialAtts.push_back(make_pair(attName, make_shared<MyDB_IntAttType>()));
+        } else {
+            partialAtts.push_back(make_pair(attName, scanRec.getType(a->getChild()->toString())));
+        }
 
-        LogicalOpPtr aggregatePlan = make_shared<LogicalAggregate>(joinResult, make_shared<MyDB_Table>("outputTable", "outputStorageLoc", outputSchema),
-                                                                   valuesToSelect, groupingClauses, myMgr);
+        if (a->isMin()) {
+            finalValues.push_back(make_shared<MinOp>(partialAtt));
+        } else if (a->isMax()) {
+            finalValues.push_back(make_shared<MaxOp>(partialAtt));
+        } else {
+            finalValues.push_back(make_shared<SumOp>(partialAtt));
+        }
+    }
 
-        return aggregatePlan;
+    // now, the table is grouped on all of its atts that are needed once the aggregates are taken out
+    valuesToSelect = finalValues;
+    eagerTable = whichTable;
+    eagerAtts.clear();
+
+    MyDB_SchemaPtr aggSchema = make_shared<MyDB_Schema>();
+    vector<string> groupExprs;
+    getNeededAtts(allTables, 1u << whichTable, aggSchema, groupExprs);
+
+    vector<ExprTreePtr> groupings;
+    vector<ExprTreePtr> exprsToCompute;
+    for (auto &b : aggSchema->getAtts()) {
+        ExprTreePtr groupAtt = make_shared<Identifier>(alias, b.first);
+        groupings.push_back(groupAtt);
+        exprsToCompute.push_back(groupAtt);
     }
-    else {
-        // there is no aggregation in sql
+    for (size_t i = 0; i < partialAggs.size(); i++) {
+        aggSchema->getAtts().push_back(partialAtts[i]);
+        exprsToCompute.push_back(partialAggs[i]);
+    }
+    eagerAtts = partialAtts;
+
+    JoinPlan returnVal;
+    returnVal.op = make_shared<LogicalAggregate>(scan.op, make_shared<MyDB_Table>("eagerAggTable" + to_string(whichTable),
+                                                 "eagerAggStorageLoc" + to_string(whichTable), aggSchema),
+                                                 exprsToCompute, groupings, myMgr);
+    auto aggCost = returnVal.op->cost();
+    returnVal.cost = aggCost.first;
+    returnVal.stats = aggCost.second;
+    returnVal.lhsMask = scan.lhsMask;
+    returnVal.rhsMask = scan.rhsMask;
+    return returnVal;
+}
 
-        // and get all of the attributes for the output
-        MyDB_SchemaPtr topSchema = make_shared<MyDB_Schema>();
-        int i = 0;
-        for (auto a: valuesToSelect) {
-            topSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->toString())));
+LogicalOpPtr SFWQuery::buildLogicalMultipleTablesPlan(map<string, MyDB_TablePtr> &allTables,
+                                                 map<string, MyDB_TableReaderWriterPtr> &allTableReaderWriters,
+                                                 MyDB_BufferManagerPtr myMgr) {
+
+    int numTables = tablesToProcess.size();
+    unsigned allMask = ~0u >> (32 - numTables);
+
+    // first, put a table scan over each of the tables, with all of the predicates that reference only that table
+    vector<JoinPlan> scans;
+    for (int i = 0; i < numTables; i++) {
+
+        vector<ExprTreePtr> scanCNF;
+        for (auto a : allDisjunctions) {
+            if (getTableMask(a) == (1u << i)) {
+                scanCNF.push_back(a);
+            }
         }
-        cout << "top schema: " << topSchema << "\n";
 
-        vector <string> exprsToCompute;
-        for (auto a : valuesToSelect) {
-            exprsToCompute.push_back(a->toString());
+        MyDB_SchemaPtr scanSchema = make_shared<MyDB_Schema>();
+        vector<string> scanExprs;
+        getNeededAtts(allTables, 1u << i, scanSchema, scanExprs);
+
+        MyDB_TablePtr inputTable = allTables[tablesToProcess[i].first];
+        JoinPlan scan;
+        scan.op = make_shared<LogicalTableScan>(allTableReaderWriters[tablesToProcess[i].first],
+                                                make_shared<MyDB_Table>("scanTable" + to_string(i), "scanStorageLoc" + to_string(i), scanSchema),
+                                                make_shared<MyDB_Stats>(inputTable, tablesToProcess[i].second),
+                                                scanCNF, scanExprs, myMgr);
+        auto scanCost = scan.op->cost();
+        scan.cost = scanCost.first;
+        scan.stats = scanCost.second;
+        scan.lhsMask = 1u << i;
+        scan.rhsMask = 0;
+        scans.push_back(scan);
+    }
+
+    JoinPlan result = joinAllTables(allTables, scans, myMgr);
+    cout << "chose join plan with cost " << result.cost << "\n";
+
+    bool areAggs = false;
+    for (auto a : valuesToSelect) {
+        if (a->hasAgg()) {
+            areAggs = true;
+        }
+    }
+
+    if (groupingClauses.size() == 0 && !areAggs) {
+        return result.op;
+    }
+
+    // see if it is cheaper to aggregate one of the tables before it is joined with the others; this can shrink
+    // the input to the joins a lot, if the table has many records for each group
+    vector<ExprTreePtr> allValues = valuesToSelect;
+    vector<ExprTreePtr> finalValues = valuesToSelect;
+    int bestEagerTable = -1;
+    vector<pair<string, MyDB_AttTypePtr>> bestEagerAtts;
+    for (int i = 0; i < numTables; i++) {
+        if (!canAggregateEagerly(i)) {
+            continue;
+        }
+
+        vector<JoinPlan> eagerScans = scans;
+        eagerScans[i] = buildEagerAggregate(allTables, scans[i], i, myMgr);
+        JoinPlan candidate = joinAllTables(allTables, eagerScans, myMgr);
+        cout << "aggregating table " << tablesToProcess[i].second << " before the joins costs " << candidate.cost << "\n";
+        if (candidate.cost < result.cost) {
+            result = candidate;
+            finalValues = valuesToSelect;
+            bestEagerTable = i;
+            bestEagerAtts = eagerAtts;
+        }
+
+        valuesToSelect = allValues;
+        eagerTable = -1;
+        eagerAtts.clear();
+    }
+
+    // there is aggregation in the sql, so it goes on top of the joins (if a table was aggregated eagerly, this
+    // finishes the aggregates using the partial ones)
+    valuesToSelect = finalValues;
+    eagerTable = bestEagerTable;
+    eagerAtts = bestEagerAtts;
+
+    MyDB_SchemaPtr totSchema = make_shared<MyDB_Schema>();
+    vector<string> totExprs;
+    getNeededAtts(allTables, allMask, totSchema, totExprs);
+    MyDB_Record myRec(totSchema);
+
+    MyDB_SchemaPtr outputSchema = make_shared<MyDB_Schema>();
+    int i = 0;
+    for (auto a : valuesToSelect) {
+        if (a->isSum() || a->isMin() || a->isMax()) {
+            outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->getChild()->toString())));
+        }
+
+        else if (a->isAvg()) {
+            outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), make_shared <MyDB_DoubleAttType> ()));
         }
 
-        LogicalOpPtr returnVal = make_shared<LogicalJoin>(leftTableScan, rightTableScan,
-                                                          make_shared<MyDB_Table>("topTable", "topStorageLoc", topSchema),
-                                                          topCNF, exprsToCompute, myMgr);
+        else if (a->isCount() || a->isCountDistinct() || a->isApproxCountDistinct()) {
+            outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), make_shared <MyDB_IntAttType> ()));
+        }
 
-        // done!!
-        return returnVal;
+        else {
+            outputSchema->getAtts().push_back(make_pair("att_" + to_string(i++), myRec.getType(a->toString())));
+        }
     }
 
+    LogicalOpPtr returnVal = make_shared<LogicalAggregate>(result.op, make_shared<MyDB_Table>("outputTable", "outputStorageLoc", outputSchema),
+                                                           valuesToSelect, groupingClauses, myMgr);
+
+    // the ORDER BY is matched against the SELECT clause as it was written
+    valuesToSelect = allValues;
+    eagerTable = -1;
+    eagerAtts.clear();
+    return returnVal;
 }
 
 void SFWQuery :: print () {
@@ -302,6 +623,12 @@ void SFWQuery :: print () {
 	for (auto a : groupingClauses) {
 		cout << "\t" << a->toString () << "\n";
 	}
+	cout << "Order by:\n";
+	for (auto a : orderingClauses) {
+		cout << "\t" << a.first->toString () << (a.second ? " ASC" : " DESC") << "\n";
+	}
+	if (limit >= 0)
+		cout << "Limit " << limit << "\n";
 }
 
 
@@ -311,6 +638,8 @@ SFWQuery :: SFWQuery (struct ValueList *selectClause, struct FromList *fromClaus
         tablesToProcess = fromClause->aliases;
         allDisjunctions = cnf->disjunctions;
         groupingClauses = grouping->valuesToCompute;
+        limit = -1;
+        eagerTable = -1;
 }
 
 SFWQuery :: SFWQuery (struct ValueList *selectClause, struct FromList *fromClause,
@@ -318,12 +647,16 @@ SFWQuery :: SFWQuery (struct ValueList *selectClause, struct FromList *fromClaus
         valuesToSelect = selectClause->valuesToCompute;
         tablesToProcess = fromClause->aliases;
 	allDisjunctions = cnf->disjunctions;
+        limit = -1;
+        eagerTable = -1;
 }
 
 SFWQuery :: SFWQuery (struct ValueList *selectClause, struct FromList *fromClause) {
         valuesToSelect = selectClause->valuesToCompute;
         tablesToProcess = fromClause->aliases;
         allDisjunctions.push_back (make_shared <BoolLiteral> (true));
+        limit = -1;
+        eagerTable = -1;
 }
 
 #endif
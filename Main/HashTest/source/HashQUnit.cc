@@ -0,0 +1,475 @@
+
+#ifndef HASH_TEST_H
+#define HASH_TEST_H
+
+#include "KeyHash.h"
+#include "MyDB_AttType.h"
+#include "MyDB_AttVal.h"
+#include "MyDB_Record.h"
+#include "MyDB_Schema.h"
+#include "QUnit.h"
+#include "RecordHashTable.h"
+#include "RuntimeFilter.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Each of the tests below puts a set of (hash, record) pairs into a RecordHashTable, and then checks
+// that looking up each hash gives back exactly the records that were inserted with it---no more, and
+// no less.  The "records" are just pointers to the ints in a vector, which is all the table looks at.
+// The last two tests check the key hashes themselves, and the runtime filters that are built on them.
+
+// the same scrambling that RecordHashTable does to a hash, so that we can build hashes that land in the
+// same slot and have the same tag
+uint64_t mix (size_t hashVal) {
+	uint64_t x = hashVal;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// gets all of the records for the given hash via find and getNext, sorted
+vector <void *> getRecords (RecordHashTable &myTable, size_t hashVal) {
+	vector <void *> allRecs;
+	for (long e = myTable.find (hashVal); e != -1; e = myTable.getNext (e)) {
+		if (myTable.getHash (e) != hashVal)
+			allRecs.push_back (nullptr);
+		allRecs.push_back (myTable.getRecord (e));
+	}
+	sort (allRecs.begin (), allRecs.end ());
+	return allRecs;
+}
+
+// returns true if looking up every hash in expected gives exactly the records listed for it
+bool checkTable (RecordHashTable &myTable, map <size_t, vector <void *>> &expected) {
+	size_t numRecs = 0;
+	for (auto &p : expected) {
+		vector <void *> recs = p.second;
+		sort (recs.begin (), recs.end ());
+		if (getRecords (myTable, p.first) != recs)
+			return false;
+		numRecs += recs.size ();
+	}
+	return myTable.size () == numRecs && myTable.getNumHashes () == expected.size ();
+}
+
+int main (int argc, char *argv[]) {
+
+	int start = 1;
+	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
+		start = argv[1][0] - '0';
+	}
+
+	QUnit::UnitTest qunit(cerr, QUnit::normal);
+	int countCorrect;
+
+	// the records that get put into the tables
+	vector <int> recs (200000);
+	for (size_t i = 0; i < recs.size (); i++)
+		recs[i] = i;
+
+	switch (start) {
+	case 1:
+	cout << endl << "Test 1: Colliding hashes:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Many records with one hash.." << flush;
+	{
+		RecordHashTable myTable;
+		map <size_t, vector <void *>> expected;
+		for (int i = 0; i < 3000; i++) {
+			size_t hashVal = (i % 3 == 0) ? i : 1000001;
+			myTable.insert (hashVal, &recs[i]);
+			expected[hashVal].push_back (&recs[i]);
+		}
+		if (expected[1000001].size () == 2000 && checkTable (myTable, expected))
+			countCorrect++;
+		if (myTable.find (1000003) == -1)
+			countCorrect++;
+	}
+
+	cout << "Same slot.." << flush;
+	{
+		// find a bunch of hashes that all go to slot 5 of the initial 16 slots, so that they have to
+		// probe past one another
+		vector <size_t> sameSlot;
+		for (size_t h = 0; sameSlot.size () < 8; h++) {
+			if ((mix (h) & 15) == 5)
+				sameSlot.push_back (h);
+		}
+		RecordHashTable myTable;
+		map <size_t, vector <void *>> expected;
+		for (int i = 0; i < 80; i++) {
+			myTable.insert (sameSlot[i % 8], &recs[i]);
+			expected[sameSlot[i % 8]].push_back (&recs[i]);
+		}
+		if (checkTable (myTable, expected))
+			countCorrect++;
+	}
+
+	cout << "Same slot and tag.." << endl << flush;
+	{
+		// now find two hashes that go to the same slot and have the same tag, so that only the full
+		// hash can tell them apart
+		map <uint64_t, size_t> seen;
+		size_t first = 0, second = 0;
+		for (size_t h = 0; ; h++) {
+			uint64_t key = (mix (h) >> 48 << 4) | (mix (h) & 15);
+			if (seen.count (key) > 0) {
+				first = seen[key];
+				second = h;
+				break;
+			}
+			seen[key] = h;
+		}
+		RecordHashTable myTable;
+		map <size_t, vector <void *>> expected;
+		for (int i = 0; i < 10; i++) {
+			size_t hashVal = (i % 2 == 0) ? first : second;
+			myTable.insert (hashVal, &recs[i]);
+			expected[hashVal].push_back (&recs[i]);
+		}
+		if (checkTable (myTable, expected))
+			countCorrect++;
+
+		// and look for a hash with that slot and tag that is not there
+		size_t third = second + 1;
+		while ((mix (third) >> 48) != (mix (first) >> 48) || (mix (third) & 15) != (mix (first) & 15))
+			third++;
+		if (myTable.find (third) == -1)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 5);
+	if (countCorrect == 5) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 2:
+	cout << endl << "Test 2: Growing the table:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Start small.." << flush;
+	{
+		// the table starts with 16 slots, and has to be re-built many times; every hash has one to
+		// four records, and some of the hashes are close together, so the probes run into each other
+		RecordHashTable myTable;
+		map <size_t, vector <void *>> expected;
+		for (size_t i = 0; i < recs.size (); i++) {
+			size_t hashVal = (i % 50000) * 1000003 + (i % 7 == 0 ? 1 : 0);
+			myTable.insert (hashVal, &recs[i]);
+			expected[hashVal].push_back (&recs[i]);
+		}
+		if (checkTable (myTable, expected))
+			countCorrect++;
+	}
+
+	cout << "Start big.." << flush;
+	{
+		RecordHashTable myTable (50000);
+		map <size_t, vector <void *>> expected;
+		for (size_t i = 0; i < 100000; i++) {
+			myTable.insert (i / 2, &recs[i]);
+			expected[i / 2].push_back (&recs[i]);
+		}
+		if (checkTable (myTable, expected))
+			countCorrect++;
+	}
+
+	cout << "Clear and re-use.." << endl << flush;
+	{
+		RecordHashTable myTable;
+		for (size_t i = 0; i < 1000; i++)
+			myTable.insert (i, &recs[i]);
+		myTable.clear ();
+		map <size_t, vector <void *>> expected;
+		for (size_t i = 500; i < 1500; i++) {
+			myTable.insert (i * 3, &recs[i]);
+			expected[i * 3].push_back (&recs[i]);
+		}
+		if (checkTable (myTable, expected) && myTable.find (3) == -1)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 3);
+	if (countCorrect == 3) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 3:
+	cout << endl << "Test 3: Batches:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "insertBatch.." << flush;
+	{
+		// the batches are of different sizes, so that some of them make the table grow and some don't,
+		// and the hashes within a batch repeat
+		RecordHashTable myTable;
+		map <size_t, vector <void *>> expected;
+		size_t i = 0;
+		for (size_t batchSize = 1; i < recs.size (); batchSize = batchSize * 3 + 1) {
+			vector <size_t> hashes;
+			vector <void *> batch;
+			for (size_t j = 0; j < batchSize && i < recs.size (); j++, i++) {
+				size_t hashVal = (i * 7919) % 30011;
+				hashes.push_back (hashVal);
+				batch.push_back (&recs[i]);
+				expected[hashVal].push_back (&recs[i]);
+			}
+			myTable.insertBatch (hashes, batch);
+		}
+		if (checkTable (myTable, expected))
+			countCorrect++;
+
+		cout << "findBatch.." << endl << flush;
+		vector <size_t> hashes;
+		for (size_t h = 0; h < 40000; h++)
+			hashes.push_back (h);
+		vector <long> heads;
+		myTable.findBatch (hashes, heads);
+		bool allOK = (heads.size () == hashes.size ());
+		for (size_t j = 0; allOK && j < hashes.size (); j++) {
+			allOK = (heads[j] == myTable.find (hashes[j]));
+			if (hashes[j] >= 30011)
+				allOK = allOK && (heads[j] == -1);
+		}
+		if (allOK)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 4:
+	cout << endl << "Test 4: Key hashes:" << endl << flush;
+	countCorrect = 0;
+	{
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("k_a", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("k_b", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("k_d", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("k_s", make_shared <MyDB_StringAttType> ()));
+		MyDB_RecordPtr rec = make_shared <MyDB_Record> (mySchema);
+
+		vector <string> abKeys {"[k_a]", "[k_b]"};
+		vector <string> baKeys {"[k_b]", "[k_a]"};
+		vector <string> aKey {"[k_a]"};
+		vector <string> dKey {"[k_d]"};
+		vector <string> sKey {"[k_s]"};
+		vector <string> adKeys {"[k_a]", "[k_d]"};
+		vector <string> daKeys {"[k_d]", "[k_a]"};
+		vector <string> asKeys {"[k_a]", "[k_s]"};
+		function <size_t ()> abHash = buildKeyHasher (rec, abKeys);
+		function <size_t ()> baHash = buildKeyHasher (rec, baKeys);
+		function <size_t ()> aHash = buildKeyHasher (rec, aKey);
+		function <size_t ()> dHash = buildKeyHasher (rec, dKey);
+		function <size_t ()> sHash = buildKeyHasher (rec, sKey);
+		function <size_t ()> adHash = buildKeyHasher (rec, adKeys);
+		function <size_t ()> daHash = buildKeyHasher (rec, daKeys);
+		function <size_t ()> asHash = buildKeyHasher (rec, asKeys);
+
+		cout << "Order of the keys.." << flush;
+		{
+			// (a, b) and (b, a) hash differently, and so do (a, a) and (b, b)
+			bool allOK = true;
+			map <size_t, int> sameKeys;
+			for (int a = 0; a < 100; a++) {
+				for (int b = 0; b < 100; b++) {
+					rec->fromString (to_string (a) + "|" + to_string (b) + "|" + to_string (a) + "|x|");
+					if (a != b && abHash () == baHash ())
+						allOK = false;
+					if (a == b)
+						sameKeys[abHash ()] = a;
+				}
+			}
+			if (allOK && sameKeys.size () == 100)
+				countCorrect++;
+		}
+
+		cout << "Int, double, and string keys.." << flush;
+		{
+			// each type of key hashes the same way as the function for that type, and an int and a double
+			// with the same value hash the same, alone or as part of a bigger key
+			bool allOK = true;
+			for (int i = -500; i < 500; i++) {
+				string s = "string number " + to_string (i * 7);
+				rec->fromString (to_string (i) + "|0|" + to_string (i) + ".0|" + s + "|");
+				allOK = allOK && aHash () == hashInt (i) && dHash () == hashDouble (i) && aHash () == dHash ();
+				allOK = allOK && adHash () == daHash () && sHash () == hashBytes (s.c_str (), s.size ());
+				allOK = allOK && asHash () == combineHashes (combineHashes (0, hashInt (i)), hashBytes (s.c_str (),
+					s.size ()));
+			}
+			if (allOK)
+				countCorrect++;
+
+			// and a double that is not an integer does not hash the same as the integer part
+			rec->fromString ("3|0|3.5|x|");
+			if (aHash () != dHash () && dHash () == hashDouble (3.5))
+				countCorrect++;
+		}
+
+		cout << "String values.." << endl << flush;
+		{
+			// a string hashes the same (via hashBytes) whether it is in its own string or sitting in a page
+			string s = "a string that is long enough to take a few rounds of the hash";
+			MyDB_StringAttValPtr notInPage = make_shared <MyDB_StringAttVal> ();
+			notInPage->set (s);
+			rec->fromString ("1|2|3.0|" + s + "|");
+			vector <char> page (rec->getBinarySize ());
+			rec->toBinary (page.data ());
+			MyDB_RecordPtr fromPage = make_shared <MyDB_Record> (mySchema);
+			fromPage->fromBinary (page.data ());
+			size_t expected = hashBytes (s.c_str (), s.size ());
+			if (notInPage->hash () == expected && fromPage->getAtt (3)->getDataPointer () != nullptr &&
+				fromPage->getAtt (3)->hash () == expected)
+				countCorrect++;
+		}
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 4);
+	if (countCorrect == 4) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 5:
+	cout << endl << "Test 5: Runtime filters:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Hashes.." << flush;
+	{
+		// every hash that was added has to pass, and most of the others should not
+		RuntimeFilter myFilter (10000);
+		if (!myFilter.mayContainHash (hashInt (1)) && !myFilter.mayContainHash (hashInt (2)))
+			countCorrect++;
+		for (int i = 0; i < 10000; i++)
+			myFilter.addHash (hashInt (i * 2));
+		bool allOK = true;
+		int numFalsePositives = 0;
+		for (int i = 0; i < 10000; i++) {
+			allOK = allOK && myFilter.mayContainHash (hashInt (i * 2));
+			if (myFilter.mayContainHash (hashInt (i * 2 + 1)))
+				numFalsePositives++;
+		}
+		if (allOK)
+			countCorrect++;
+		if (numFalsePositives < 500)
+			countCorrect++;
+	}
+
+	cout << "Ranges.." << flush;
+	{
+		RuntimeFilter myFilter (100);
+		if (myFilter.inRange (-1e300) && myFilter.inRange (1e300))
+			countCorrect++;
+		myFilter.addToRange (-2.5);
+		myFilter.addToRange (7.25);
+		myFilter.addToRange (0);
+		if (myFilter.inRange (-2.5) && myFilter.inRange (7.25) && myFilter.inRange (3) &&
+			!myFilter.inRange (-2.6) && !myFilter.inRange (7.26))
+			countCorrect++;
+	}
+
+	cout << "Int and double keys.." << endl << flush;
+	{
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("f_i", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("f_d", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("f_s", make_shared <MyDB_StringAttType> ()));
+		MyDB_RecordPtr rec = make_shared <MyDB_Record> (mySchema);
+		vector <string> intKey {"[f_i]"};
+		vector <string> doubleKey {"[f_d]"};
+		vector <string> stringKey {"[f_s]"};
+		vector <string> twoKeys {"[f_i]", "[f_d]"};
+
+		// only a single number gets a range
+		if (RuntimeFilter :: buildRangeKey (rec, intKey) != nullptr &&
+			RuntimeFilter :: buildRangeKey (rec, doubleKey) != nullptr &&
+			RuntimeFilter :: buildRangeKey (rec, stringKey) == nullptr &&
+			RuntimeFilter :: buildRangeKey (rec, twoKeys) == nullptr)
+			countCorrect++;
+
+		// build a filter over the int keys 100 to 200, and then check it with both int and double keys
+		RuntimeFilter intFilter (101);
+		function <bool ()> adder = intFilter.buildAdder (rec, intKey);
+		for (int i = 100; i <= 200; i++) {
+			rec->fromString (to_string (i) + "|0|x|");
+			adder ();
+		}
+		function <bool ()> intChecker = intFilter.buildChecker (rec, intKey);
+		function <bool ()> doubleChecker = intFilter.buildChecker (rec, doubleKey);
+		bool allOK = true;
+		for (int i = 100; i <= 200; i++) {
+			rec->fromString (to_string (i) + "|" + to_string (i) + ".0|x|");
+			allOK = allOK && intChecker () && doubleChecker ();
+		}
+		for (string s : {"99|99.0|x|", "201|201.0|x|", "-5|-5.0|x|", "100000|1e10|x|"}) {
+			rec->fromString (s);
+			allOK = allOK && !intChecker () && !doubleChecker ();
+		}
+
+		// a double that is not one of the ints does not get through, even if it is in the range
+		for (string s : {"150|150.5|x|", "150|99.9|x|"}) {
+			rec->fromString (s);
+			allOK = allOK && intChecker () && !doubleChecker ();
+		}
+		if (allOK)
+			countCorrect++;
+
+		// and a filter over double keys, which checks the range on the real values
+		RuntimeFilter doubleFilter (100);
+		adder = doubleFilter.buildAdder (rec, doubleKey);
+		for (int i = 0; i < 100; i++) {
+			rec->fromString ("0|" + to_string (1.5 + i * 0.125) + "|x|");
+			adder ();
+		}
+		function <bool ()> checker = doubleFilter.buildChecker (rec, doubleKey);
+		allOK = true;
+		for (int i = 0; i < 100; i++) {
+			rec->fromString ("0|" + to_string (1.5 + i * 0.125) + "|x|");
+			allOK = allOK && checker ();
+		}
+		for (string s : {"0|1.49|x|", "0|13.876|x|", "0|-1.5|x|"}) {
+			rec->fromString (s);
+			allOK = allOK && !checker () && !doubleFilter.inRange (rec->getAtt (1)->toDouble ());
+		}
+		if (allOK && doubleFilter.inRange (1.5) && doubleFilter.inRange (13.875))
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 8);
+	if (countCorrect == 8) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+	default:
+		break;
+	}
+}
+
+#endif
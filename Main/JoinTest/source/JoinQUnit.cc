@@ -0,0 +1,516 @@
+
+#ifndef JOIN_TEST_H
+#define JOIN_TEST_H
+
+#include "MyDB_AttType.h"
+#include "MyDB_BufferManager.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_Record.h"
+#include "MyDB_Table.h"
+#include "MyDB_TableReaderWriter.h"
+#include "MyDB_Schema.h"
+#include "QUnit.h"
+#include "AdaptiveJoin.h"
+#include "HybridHashJoin.h"
+#include "IndexNestedLoopJoin.h"
+#include "ParallelHashJoin.h"
+#include "ScanJoin.h"
+#include "SortMergeJoin.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Each of the tests below runs one of the joins with a buffer pool that is small enough to force the
+// path through the join that is being tested, and then checks that it gets exactly the same records as
+// a nested loop over the generated records.  The nested loop does not share any code with the joins,
+// so a bug in the hashing or the filtering that they have in common can't hide itself.
+
+// one of the records in a test table
+struct TestRec {
+	int key;
+	int key2;
+	int val;
+};
+
+// writes a text file for a table with four atts: a key (from 0 up to numKeys - 1), a second key (from 0
+// up to 2), a unique value, and some padding so that there are not too many records on a page.  If
+// skewEvery is not zero, every skewEvery'th record gets the key 7, so that one key has a lot of records.
+// Returns the records, so that the output of the joins can be checked
+vector <TestRec> makeTable (string fileName, int numRecs, int numKeys, int skewEvery, int seed) {
+	srand (seed);
+	vector <TestRec> allRecs;
+	ofstream out (fileName);
+	for (int i = 0; i < numRecs; i++) {
+		TestRec rec;
+		rec.key = rand () % numKeys;
+		if (skewEvery != 0 && i % skewEvery == 0)
+			rec.key = 7;
+		rec.key2 = rand () % 3;
+		rec.val = i;
+		allRecs.push_back (rec);
+		out << rec.key << "|" << rec.key2 << "|" << rec.val << "|padding" << string (40, 'x') << "|\n";
+	}
+	return allRecs;
+}
+
+// loads up a table from a text file made by makeTable; the atts are named prefix_key, prefix_key2,
+// prefix_val, and prefix_pad
+MyDB_TableReaderWriterPtr loadTable (string name, string prefix, string fileName, MyDB_BufferManagerPtr myMgr) {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair (prefix + "_key", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "_key2", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "_val", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "_pad", make_shared <MyDB_StringAttType> ()));
+	MyDB_TableReaderWriterPtr myTable = make_shared <MyDB_TableReaderWriter> (
+		make_shared <MyDB_Table> (name, name + ".bin", mySchema), myMgr);
+	myTable->loadFromTextFile (fileName);
+	return myTable;
+}
+
+// makes an empty table to hold the output of one of the joins
+MyDB_TableReaderWriterPtr makeOutputTable (string name, MyDB_BufferManagerPtr myMgr) {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair ("o_key", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("o_lval", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("o_rval", make_shared <MyDB_IntAttType> ()));
+	return make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (name, name + ".bin", mySchema), myMgr);
+}
+
+// gets all of the records in a table as strings, sorted, so that they can be compared with the expected ones
+vector <string> getSortedRecords (MyDB_TableReaderWriterPtr fromMe) {
+	vector <string> allRecs;
+	MyDB_RecordPtr rec = fromMe->getEmptyRecord ();
+	size_t numAtts = fromMe->getTable ()->getSchema ()->getAtts ().size ();
+	MyDB_RecordIteratorAltPtr myIter = fromMe->getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (rec);
+		string asString;
+		for (size_t i = 0; i < numAtts; i++)
+			asString += rec->getAtt (i)->toString () + "|";
+		allRecs.push_back (asString);
+	}
+	sort (allRecs.begin (), allRecs.end ());
+	return allRecs;
+}
+
+// runs a nested loop over the two sets of records, and returns the output (the left key, the left value,
+// and the right value) for every pair that is accepted, as sorted strings
+vector <string> getExpected (vector <TestRec> &left, vector <TestRec> &right,
+	function <bool (TestRec &, TestRec &)> accept) {
+
+	vector <string> allRecs;
+	for (TestRec &l : left) {
+		for (TestRec &r : right) {
+			if (accept (l, r))
+				allRecs.push_back (to_string (l.key) + "|" + to_string (l.val) + "|" + to_string (r.val) + "|");
+		}
+	}
+	sort (allRecs.begin (), allRecs.end ());
+	return allRecs;
+}
+
+int main (int argc, char *argv[]) {
+
+	int start = 1;
+	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
+		start = argv[1][0] - '0';
+	}
+
+	QUnit::UnitTest qunit(cerr, QUnit::normal);
+	int countCorrect;
+
+	// all of the joins match on the key, and only keep pairs where the left value is smaller
+	string finalPredicate = "&& (== ([l_key], [r_key]), < ([l_val], [r_val]))";
+	auto acceptAll = [] (TestRec &l, TestRec &r) {
+		return l.key == r.key && l.val < r.val;
+	};
+	vector <pair <string, string>> equalityChecks;
+	equalityChecks.push_back (make_pair (string ("[l_key]"), string ("[r_key]")));
+	vector <string> projections;
+	projections.push_back ("[l_key]");
+	projections.push_back ("[l_val]");
+	projections.push_back ("[r_val]");
+
+	vector <TestRec> leftRecs, rightRecs;
+
+	switch (start) {
+	case 1:
+	cout << endl << "Test 1: Hybrid Hash Join:" << endl << flush;
+	countCorrect = 0;
+	leftRecs = makeTable ("joinLeft.tbl", 4000, 2000, 0, 1);
+	rightRecs = makeTable ("joinRight.tbl", 6000, 2000, 0, 2);
+
+	cout << "Spill partitions.." << flush;
+	{
+		// the left table is a few hundred pages, so none of its partitions fit in the budget of 32 pages
+		vector <string> expected = getExpected (leftRecs, rightRecs, [&] (TestRec &l, TestRec &r) {
+			return r.val < 5000 && acceptAll (l, r);
+		});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 64, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		HybridHashJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "< ([r_val], int[5000])");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Keep several partitions in RAM.." << flush;
+	{
+		// the selection keeps a quarter of the left records, so a few of the partitions fit in the budget,
+		// and the rest are spilled
+		vector <string> expected = getExpected (leftRecs, rightRecs, [&] (TestRec &l, TestRec &r) {
+			return l.val < 1000 && acceptAll (l, r);
+		});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 64, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		HybridHashJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"< ([l_val], int[1000])", "bool[true]");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Partition recursively.." << flush;
+	{
+		// with a budget of 8 pages, there are only 4 partitions, and each has to be partitioned again
+		vector <string> expected = getExpected (leftRecs, rightRecs, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		HybridHashJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Give up on partitioning.." << endl << flush;
+	{
+		// the records with key 7 are too many to fit in the budget on both sides, and re-partitioning
+		// can't split them up, so after MAX_PARTITION_LEVELS their partition has to be sort-merged
+		vector <TestRec> leftSkewed = makeTable ("joinLeftSkewed.tbl", 1000, 2000, 4, 3);
+		vector <TestRec> rightSkewed = makeTable ("joinRightSkewed.tbl", 1200, 2000, 8, 4);
+		vector <string> expected = getExpected (leftSkewed, rightSkewed, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeftSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRightSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		HybridHashJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 8);
+	if (countCorrect == 8) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 2:
+	cout << endl << "Test 2: Parallel Hash Join:" << endl << flush;
+	countCorrect = 0;
+	leftRecs = makeTable ("joinLeft.tbl", 4000, 2000, 0, 5);
+	rightRecs = makeTable ("joinRight.tbl", 6000, 2000, 0, 6);
+
+	cout << "Join with four threads.." << flush;
+	{
+		vector <string> expected = getExpected (leftRecs, rightRecs, [&] (TestRec &l, TestRec &r) {
+			return l.val < 3000 && acceptAll (l, r);
+		});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 512, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		ParallelHashJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"< ([l_val], int[3000])", "bool[true]", 4);
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Join with heavy hitters.." << endl << flush;
+	{
+		// a third of the right records have key 7, so it is probed by all of the threads
+		vector <TestRec> rightSkewed = makeTable ("joinRightSkewed.tbl", 6000, 2000, 3, 7);
+		vector <string> expected = getExpected (leftRecs, rightSkewed, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 512, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRightSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		ParallelHashJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]", 4);
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 4);
+	if (countCorrect == 4) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 3:
+	cout << endl << "Test 3: Scan Join with a runtime filter:" << endl << flush;
+	countCorrect = 0;
+	leftRecs = makeTable ("joinLeft.tbl", 4000, 2000, 0, 12);
+	rightRecs = makeTable ("joinRight.tbl", 6000, 10000, 0, 13);
+
+	cout << "Filter the right table.." << endl << flush;
+	{
+		// most of the right keys are out of the range of the left ones, and the left selection leaves
+		// only a few of the keys that are in range, so the filter throws out nearly all of the right records
+		vector <string> expected = getExpected (leftRecs, rightRecs, [&] (TestRec &l, TestRec &r) {
+			return l.val < 500 && r.val % 2 == 0 && acceptAll (l, r);
+		});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 512, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		ScanJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"< ([l_val], int[500])", "== ([r_val], * (int[2], / ([r_val], int[2])))");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 4:
+	cout << endl << "Test 4: Sort Merge Join:" << endl << flush;
+	countCorrect = 0;
+	leftRecs = makeTable ("joinLeft.tbl", 3000, 300, 0, 8);
+	rightRecs = makeTable ("joinRight.tbl", 3000, 300, 0, 9);
+
+	cout << "Join on a composite key.." << flush;
+	{
+		// the tables are sorted with a pool of 16 pages, so there are lots of runs to merge
+		string compositePredicate = "&& (&& (== ([l_key], [r_key]), == ([l_key2], [r_key2])), < ([l_val], [r_val]))";
+		vector <pair <string, string>> compositeChecks = equalityChecks;
+		compositeChecks.push_back (make_pair (string ("[l_key2]"), string ("[r_key2]")));
+		vector <string> expected = getExpected (leftRecs, rightRecs, [&] (TestRec &l, TestRec &r) {
+			return l.key2 == r.key2 && acceptAll (l, r);
+		});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		SortMergeJoin myOp (leftTable, rightTable, outTable, compositePredicate, projections, compositeChecks,
+			"bool[true]", "bool[true]");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Join with a key that spans many pages.." << endl << flush;
+	{
+		// half of the left records have key 7, which is far more than fit on the pages that are pinned
+		vector <TestRec> leftSkewed = makeTable ("joinLeftSkewed.tbl", 2000, 2000, 2, 10);
+		vector <TestRec> rightSkewed = makeTable ("joinRightSkewed.tbl", 3000, 2000, 40, 11);
+		vector <string> expected = getExpected (leftSkewed, rightSkewed, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeftSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRightSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		SortMergeJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 4);
+	if (countCorrect == 4) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 5:
+	cout << endl << "Test 5: Index Nested Loop Join:" << endl << flush;
+	countCorrect = 0;
+	leftRecs = makeTable ("joinLeft.tbl", 400, 5000, 0, 14);
+	rightRecs = makeTable ("joinRight.tbl", 8000, 5000, 0, 15);
+
+	cout << "Probe a B+-Tree.." << endl << flush;
+	{
+		// the outer table is sorted in runs, and then looked up in a tree that is much bigger than the pool
+		vector <string> expected = getExpected (leftRecs, rightRecs, [&] (TestRec &l, TestRec &r) {
+			return r.key2 < 2 && acceptAll (l, r);
+		});
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 32, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_SchemaPtr rightSchema = make_shared <MyDB_Schema> ();
+		rightSchema->appendAtt (make_pair ("r_key", make_shared <MyDB_IntAttType> ()));
+		rightSchema->appendAtt (make_pair ("r_key2", make_shared <MyDB_IntAttType> ()));
+		rightSchema->appendAtt (make_pair ("r_val", make_shared <MyDB_IntAttType> ()));
+		rightSchema->appendAtt (make_pair ("r_pad", make_shared <MyDB_StringAttType> ()));
+		MyDB_BPlusTreeReaderWriterPtr rightTree = make_shared <MyDB_BPlusTreeReaderWriter> ("r_key",
+			make_shared <MyDB_Table> ("joinRightTree", "joinRightTree.bin", rightSchema), myMgr);
+		rightTree->loadFromTextFile ("joinRight.tbl");
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		IndexNestedLoopJoin myOp (leftTable, rightTree, outTable, finalPredicate, projections, "[l_key]",
+			"bool[true]", "< ([r_key2], int[2])");
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 6:
+	cout << endl << "Test 6: Adaptive Join:" << endl << flush;
+	countCorrect = 0;
+	leftRecs = makeTable ("joinLeft.tbl", 6000, 2000, 0, 16);
+	rightRecs = makeTable ("joinRight.tbl", 600, 2000, 0, 17);
+
+	cout << "Flip the sides.." << flush;
+	{
+		// the left side is estimated to be tiny, but it is ten times the size of the right side, so the
+		// join has to switch to hashing the right side (which fits in the budget of 128 pages)
+		vector <string> expected = getExpected (leftRecs, rightRecs, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 256, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		AdaptiveJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]", 10, 600);
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Fall back to a hybrid hash join.." << flush;
+	{
+		// neither side fits in the budget of 8 pages
+		vector <string> expected = getExpected (leftRecs, rightRecs, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeft.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRight.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		AdaptiveJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]", 6000, 600);
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	cout << "Fall back to a sort merge join.." << endl << flush;
+	{
+		// every record has the same key, so partitioning would not help
+		vector <TestRec> leftSkewed = makeTable ("joinLeftSkewed.tbl", 600, 1, 0, 18);
+		vector <TestRec> rightSkewed = makeTable ("joinRightSkewed.tbl", 150, 1, 0, 19);
+		vector <string> expected = getExpected (leftSkewed, rightSkewed, acceptAll);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, 16, "tempFile");
+		MyDB_TableReaderWriterPtr leftTable = loadTable ("joinLeft", "l", "joinLeftSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr rightTable = loadTable ("joinRight", "r", "joinRightSkewed.tbl", myMgr);
+		MyDB_TableReaderWriterPtr outTable = makeOutputTable ("joinOut", myMgr);
+		AdaptiveJoin myOp (leftTable, rightTable, outTable, finalPredicate, projections, equalityChecks,
+			"bool[true]", "bool[true]", 600, 150);
+		myOp.run ();
+
+		vector <string> result = getSortedRecords (outTable);
+		if (expected.size () > 0 && result.size () == expected.size ())
+			countCorrect++;
+		if (result == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 6);
+	if (countCorrect == 6) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+	default:
+		break;
+	}
+}
+
+#endif
@@ -0,0 +1,61 @@
+
+#ifndef KEY_HASH_H
+#define KEY_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// These are the hash functions used to hash join and grouping keys.  They are all built on
+// the same 64x64->128 bit "multiply and fold" step used by wyhash, which mixes all of the
+// bits of its inputs into all of the bits of the output.
+
+// multiplies the two values, and then folds the high 64 bits of the product into the low 64 bits
+inline uint64_t hashMultiplyFold (uint64_t a, uint64_t b) {
+	__uint128_t product = ((__uint128_t) a) * b;
+	return ((uint64_t) product) ^ ((uint64_t) (product >> 64));
+}
+
+// hashes an integer
+inline size_t hashInt (int64_t hashMe) {
+	return hashMultiplyFold (((uint64_t) hashMe) ^ 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL);
+}
+
+// hashes a double... a double that holds an integer value hashes to the same value as that
+// integer, so that an int key can be joined with a double key
+inline size_t hashDouble (double hashMe) {
+	if (hashMe >= -9.2e18 && hashMe <= 9.2e18 && hashMe == (double) (int64_t) hashMe)
+		return hashInt ((int64_t) hashMe);
+
+	uint64_t bits;
+	memcpy (&bits, &hashMe, sizeof (double));
+	return hashMultiplyFold (bits ^ 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL);
+}
+
+// hashes an array of bytes (for example, a string that is still sitting in a page)
+size_t hashBytes (const void *hashMe, size_t len);
+
+// combines the hash of one more key into the hash of all of the keys seen so far...
+// unlike XOR, this is not symmetric, so (a, b) and (b, a) hash differently, and two
+// copies of the same value do not cancel each other out
+inline size_t combineHashes (size_t soFar, size_t next) {
+	return hashMultiplyFold (soFar ^ 0x1d8e4e27c47d124fULL, next ^ 0xe7037ed1a0b428dbULL);
+}
+
+// forward declaration, since MyDB_Record.h includes MyDB_AttVal.h, which uses this file
+class MyDB_Record;
+typedef shared_ptr <MyDB_Record> MyDB_RecordPtr;
+
+// returns a function that computes the hash of all of the given computations over the
+// current contents of rec (each computation is encoded as for MyDB_Record.compileComputation ()).
+// Int and double keys are hashed directly from their values, rather than via MyDB_AttVal.hash ().
+// Two lists of computations that produce equal values (in the same order) hash the same, even
+// if one is over an int and the other over a double
+function <size_t ()> buildKeyHasher (MyDB_RecordPtr rec, vector <string> &computations);
+
+#endif
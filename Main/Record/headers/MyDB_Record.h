@@ -165,4 +165,8 @@ private:
 
 };
 
+// just like buildRecordComparator above, except that the records are compared on a list of computations:
+// first on computations[0], then, if that is a tie, on computations[1], and so on
+function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, vector <string> computations);
+
 #endif
@@ -0,0 +1,72 @@
+
+#ifndef KEY_HASH_C
+#define KEY_HASH_C
+
+#include "KeyHash.h"
+#include "MyDB_Record.h"
+
+using namespace std;
+
+// reads len (at most 8) bytes into the low end of an integer
+static inline uint64_t readSmall (const unsigned char *fromMe, size_t len) {
+	uint64_t returnVal = 0;
+	memcpy (&returnVal, fromMe, len);
+	return returnVal;
+}
+
+size_t hashBytes (const void *hashMe, size_t len) {
+
+	const unsigned char *bytes = (const unsigned char *) hashMe;
+	uint64_t seed = 0xa0761d6478bd642fULL ^ len;
+
+	// eat up 16 bytes at a time
+	while (len > 16) {
+		uint64_t a, b;
+		memcpy (&a, bytes, 8);
+		memcpy (&b, bytes + 8, 8);
+		seed = hashMultiplyFold (a ^ 0xe7037ed1a0b428dbULL, b ^ seed);
+		bytes += 16;
+		len -= 16;
+	}
+
+	// and then whatever is left
+	uint64_t a = 0, b = 0;
+	if (len > 8) {
+		memcpy (&a, bytes, 8);
+		b = readSmall (bytes + 8, len - 8);
+	} else {
+		a = readSmall (bytes, len);
+	}
+
+	return hashMultiplyFold (hashMultiplyFold (a ^ 0xe7037ed1a0b428dbULL, b ^ seed), 0x8ebc6af09c88c6e3ULL);
+}
+
+function <size_t ()> buildKeyHasher (MyDB_RecordPtr rec, vector <string> &computations) {
+
+	// get a function that hashes each of the computations
+	vector <function <size_t ()>> hashers;
+	for (string &s : computations) {
+		func f = rec->compileComputation (s);
+		MyDB_AttTypePtr myType = rec->getType (s);
+		if (myType->promotableToInt ()) {
+			hashers.push_back ([f] {return hashInt (f ()->toInt ());});
+		} else if (myType->promotableToDouble ()) {
+			hashers.push_back ([f] {return hashDouble (f ()->toDouble ());});
+		} else {
+			hashers.push_back ([f] {return f ()->hash ();});
+		}
+	}
+
+	// the common case is just one key
+	if (hashers.size () == 1)
+		return hashers[0];
+
+	return [hashers] {
+		size_t hashVal = 0;
+		for (auto &h : hashers)
+			hashVal = combineHashes (hashVal, h ());
+		return hashVal;
+	};
+}
+
+#endif
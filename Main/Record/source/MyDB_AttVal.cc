@@ -3,6 +3,7 @@
 #define ATT_VAL_C
 
 #include <iostream>
+#include "KeyHash.h"
 #include "MyDB_AttVal.h"
 #include <string>
 #include <string.h>
@@ -66,19 +67,25 @@ void MyDB_IntAttVal :: fromString (string &fromMe) {
 }
 
 size_t MyDB_IntAttVal :: hash () {
-	return std :: hash <int> () (toInt ());
+	return hashInt (toInt ());
 }
 
 size_t MyDB_DoubleAttVal :: hash () {
-	return std :: hash <int> () (toDouble ());
+	return hashDouble (toDouble ());
 }
 
 size_t MyDB_BoolAttVal :: hash () {
-	return std :: hash <int> () (toBool ());
+	return hashInt (toBool ());
 }
 
 size_t MyDB_StringAttVal :: hash () {
-	return std :: hash <string> () (toString ());
+
+	// if we are sitting in a page, hash the bytes there, rather than building a string
+	void *dataPtr = getDataPointer ();
+	if (dataPtr == nullptr) 
+		return hashBytes (value.c_str (), value.size ());
+	else
+		return hashBytes (dataPtr, strlen ((char *) dataPtr));
 }
 
 bool MyDB_IntAttVal :: toBool () {
@@ -847,6 +847,32 @@ function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rh
 	
 }
 
+function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, vector <string> computations) {
+
+	// with just one computation, this is easy
+	if (computations.size () == 1)
+		return buildRecordComparator (lhs, rhs, computations[0]);
+
+	// otherwise, get a "less than" and a "greater than" for each computation
+	vector <function <bool ()>> lessThans;
+	vector <function <bool ()>> greaterThans;
+	for (string &s : computations) {
+		lessThans.push_back (buildRecordComparator (lhs, rhs, s));
+		greaterThans.push_back (buildRecordComparator (rhs, lhs, s));
+	}
+
+	// and the first computation where the two records differ decides
+	return [lessThans, greaterThans] {
+		for (size_t i = 0; i < lessThans.size (); i++) {
+			if (lessThans[i] ())
+				return true;
+			if (greaterThans[i] ())
+				return false;
+		}
+		return false;
+	};
+}
+
 MyDB_Record :: MyDB_Record (MyDB_SchemaPtr mySchemaIn) {
 	mySchema = mySchemaIn;
 
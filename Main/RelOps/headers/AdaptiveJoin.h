@@ -0,0 +1,66 @@
+
+#ifndef ADAPTIVE_JOIN_H
+#define ADAPTIVE_JOIN_H
+
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates a hash join that decides how to run itself as it goes, rather than
+// trusting the planner's estimates of how big its (selected) inputs are.
+//
+// It starts out as an in-RAM hash join: the side that is estimated to be smaller (after its
+// selection predicate is run) is copied into pinned pages and hashed, and then the other side
+// is scanned and probed.  But if, while it is being hashed, the "small" side turns out to have
+// a lot more records than were estimated for the other side, the two sides are flipped, and the
+// other side is hashed instead.  And if the side being hashed does not fit into the RAM that the
+// join is allowed to use, the join gives up on doing everything in RAM, and switches to either a
+// HybridHashJoin or (if the records seen so far have very few distinct keys, so that partitioning
+// on the keys would not help) a SortMergeJoin.
+//
+class AdaptiveJoin {
+
+public:
+	// The parameters are exactly the same as for the ScanJoin, except that leftEstimate and
+	// rightEstimate are the numbers of records that the planner thinks will be accepted by
+	// leftSelectionPredicate and rightSelectionPredicate.
+	//
+	AdaptiveJoin (MyDB_TableReaderWriterPtr leftInput, MyDB_TableReaderWriterPtr rightInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate,
+		vector <string> projections,
+		vector <pair <string, string>> equalityChecks, string leftSelectionPredicate,
+		string rightSelectionPredicate, double leftEstimate, double rightEstimate);
+
+	// execute the join
+	void run ();
+
+private:
+
+	// what happened when we tried to run the join in RAM
+	enum InRAMResult {JOINED, FLIPPED, OVERFLOWED};
+
+	// tries to run the join in RAM, hashing the left side if hashLeft is true, and the right side
+	// otherwise.  If canFlip is true, this gives up (and returns FLIPPED) as soon as the side being
+	// hashed has a lot more records than were estimated for the other side
+	InRAMResult joinInRAM (bool hashLeft, bool canFlip);
+
+	string finalSelectionPredicate;
+	vector <pair <string, string>> equalityChecks;
+	vector <string> projections;
+	MyDB_TableReaderWriterPtr output;
+	MyDB_TableReaderWriterPtr leftTable;
+	MyDB_TableReaderWriterPtr rightTable;
+	string leftSelectionPredicate;
+	string rightSelectionPredicate;
+	double leftEstimate;
+	double rightEstimate;
+
+	// the number of pages that we can use to hash a side
+	size_t budget;
+
+	// set by joinInRAM when it overflows, if there were few distinct keys in the records it hashed
+	bool looksSkewed;
+};
+
+#endif
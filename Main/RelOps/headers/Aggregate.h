@@ -3,15 +3,34 @@
 #define AGG_H
 
 #include "MyDB_TableReaderWriter.h"
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 // This class encapulates a simple, hash-based aggregation + group by.  It does not
 // need to work when there is not enough space in the buffer manager to store all of
-// the groups.
+// the groups.  The groups are kept in a GroupTable, so that the running aggregates
+// are native values, and output records are only built once all of the input is read.
+//
+// If the groups take up more than the RAM budget (half of the buffer pool), no new groups
+// are created; records for groups that are already there are still aggregated, but all
+// of the others are partitioned on the hash of their grouping values and spilled to
+// temporary tables.  Once the input has been read, the groups in RAM are written out,
+// and each spilled partition is then aggregated on its own (partitioning it again, with
+// a different hash function, if it is still too big).
+//
+// Rather than reading its input from a table, an aggregation can also have its input pushed
+// into it a record at a time (see open (), push () and close ()), so that it can sit at the
+// end of a pipeline of operations whose output is never written out.
 
-enum MyDB_AggType {Sum, Avg, Cnt};
+// the aggregates that can be computed.  CntDistinct counts the distinct values exactly (keeping
+// all of them for each group), and ApproxCntDistinct estimates the count using a HyperLogLog
+// sketch, which takes a small, fixed amount of RAM per group; both are output as ints
+enum MyDB_AggType {Sum, Avg, Cnt, Min, Max, CntDistinct, ApproxCntDistinct};
+
+class GroupTable;
 
 class Aggregate {
 
@@ -51,17 +70,63 @@ public:
 		vector <pair <MyDB_AggType, string>> aggsToCompute,
 		vector <string> groupings, string selectionPredicate);
 	
+	// this is just like the above, except that there is no input table; rather, records with the
+	// given schema are pushed into the aggregation
+	Aggregate (MyDB_SchemaPtr inputSchema, MyDB_TableReaderWriterPtr output,
+		vector <pair <MyDB_AggType, string>> aggsToCompute,
+		vector <string> groupings, string selectionPredicate);
+
 	// execute the aggregation
 	void run ();
 
+	// these run the aggregation over records that are pushed into it.  open () returns the record
+	// that each input record is to be written into; push () is then called once for each of them.
+	// Once all of them are pushed, close () writes out the groups.  open () returns nullptr (and
+	// nothing should be pushed) if the output schema does not match the aggregates
+	MyDB_RecordPtr open ();
+	void push ();
+	void close ();
+
 private:
 
+	// this is used to aggregate a partition that was spilled... level is the number of times
+	// that the data have been partitioned, and namePrefix is used to give unique names to the
+	// temporary tables
+	Aggregate (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <MyDB_AggType, string>> aggsToCompute,
+		vector <string> groupings, string selectionPredicate, int level, string namePrefix);
+
+	// maps the hash of a record's grouping values to a partition
+	int getPartition (size_t hashVal);
+
 	MyDB_TableReaderWriterPtr input;
 	MyDB_TableReaderWriterPtr output;
 	vector <pair <MyDB_AggType, string>> aggsToCompute;
 	vector <string> groupings;
 	string selectionPredicate;
+	MyDB_SchemaPtr inputSchema;
+	MyDB_BufferManagerPtr myMgr;
+
+	// the number of bytes that the groups can take up before we start spilling
+	size_t budget;
+
+	// the number of partitions that we spill to
+	int numPartitions;
+
+	int level;
+	string namePrefix;
 
+	// this is everything that is set up by open (), and used by push () and close ()
+	MyDB_RecordPtr inputRec;
+	shared_ptr <GroupTable> myTable;
+	vector <func> groupingComps;
+	function <size_t ()> groupingHash;
+	vector <func> aggComps;
+	func inputPred;
+	vector <MyDB_TableReaderWriterPtr> parts;
+	vector <long> partCounts;
+	bool canSpill;
+	bool isFull;
 };
 
 #endif
@@ -0,0 +1,161 @@
+
+#ifndef GROUP_TABLE_H
+#define GROUP_TABLE_H
+
+#include "Aggregate.h"
+#include "HyperLogLog.h"
+#include "MyDB_AttType.h"
+#include "MyDB_AttVal.h"
+#include "MyDB_Record.h"
+#include "MyDB_Schema.h"
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// This is the hash table used by a hash aggregation.  Rather than keeping each group as a
+// serialized record (which has to be deserialized to check the grouping values, and then
+// re-serialized every time that one of the aggregates is updated), the grouping values and the
+// running aggregates are kept in native arrays: there is one array for each of the grouping
+// values, one for each of the aggregates, and one for the counts, and group i is at position i
+// of all of them.  Output records are only created at the very end, by getGroup ().
+//
+// An exact count of the distinct values is kept as a hash set of the values for each group, and
+// an approximate one as a HyperLogLog sketch for each group.
+//
+// Looking up a group is done with a flat array of slots that uses open addressing (linear
+// probing); each slot holds one plus the number of a group, or zero if it is empty.  The hash
+// of each group is kept, so that we almost never compare the grouping values of a group unless
+// it really has the hash we want, and so that the slots can be re-built without re-hashing.
+// If there are no grouping values, there is only ever one group, and the slots are not used.
+//
+// Tables that were created with the same types can be merged; this is used to combine the
+// partial aggregates computed by different threads.
+//
+// A table is used as follows:
+//
+// GroupTable myTable (outputSchema, aggsToCompute, inputRec);
+// while (...) {
+//	// compute the hash of the current record's grouping values
+//	myTable.add (hashVal, groupingComps, aggComps);
+// }
+// for (size_t i = 0; i < myTable.size (); i++) {
+//	myTable.getGroup (i, outRec);
+//	...
+// }
+//
+class GroupTable {
+
+public:
+
+	// creates an empty table for aggregating records like inputRec into records with the given
+	// schema, which has all of the grouping values, followed by all of the aggregates in
+	// aggsToCompute (this is the output schema of an Aggregate).  A sum or average that is output
+	// as an int is computed with integers, and otherwise it is computed with doubles
+	GroupTable (MyDB_SchemaPtr outputSchema, vector <pair <MyDB_AggType, string>> &aggsToCompute,
+		MyDB_RecordPtr inputRec);
+
+	// adds one record to its group.  hashVal is the hash of the record's grouping values,
+	// groupingComps compute the grouping values, and aggComps compute the values that are
+	// aggregated (the computation for a count is never called).  If the group is not there,
+	// it is created only if canAddGroup is true; returns false if the record was not added
+	bool add (size_t hashVal, vector <func> &groupingComps, vector <func> &aggComps, bool canAddGroup);
+
+	// adds one record to its group, creating the group if it is not there
+	inline void add (size_t hashVal, vector <func> &groupingComps, vector <func> &aggComps) {
+		add (hashVal, groupingComps, aggComps, true);
+	}
+
+	// adds all of the groups in fromMe (which must have been created with the same types) to
+	// this table, combining the aggregates for groups that are in both
+	void merge (GroupTable &fromMe);
+
+	// the number of groups
+	inline size_t size () {
+		return hashes.size ();
+	}
+
+	// about how many bytes of RAM the groups are taking up
+	inline size_t getBytesUsed () {
+		return hashes.size () * bytesPerGroup + extraBytes + slots.size () * sizeof (uint32_t);
+	}
+
+	// writes the grouping values and then the final aggregates for the given group into outRec
+	void getGroup (size_t whichGroup, MyDB_RecordPtr outRec);
+
+	// removes all of the groups, and gives back the RAM
+	void clear ();
+
+private:
+
+	// the ways that a value can be stored
+	enum StorageType {IntStorage, DoubleStorage, StringStorage, BoolStorage};
+
+	// gets the way that a value of this type is stored
+	static StorageType getStorageType (MyDB_AttTypePtr forMe);
+
+	// all of the values for one of the grouping attributes, or one of the aggregates; only the
+	// vectors that match the storage type (and, for an aggregate, the type of aggregate) are used
+	struct Column {
+		StorageType type;
+		vector <int64_t> ints;
+		vector <double> doubles;
+		vector <string> strings;
+
+		// the distinct values seen by each group, for an exact count of the distinct values
+		vector <unordered_set <int64_t>> intSets;
+		vector <unordered_set <double>> doubleSets;
+		vector <unordered_set <string>> stringSets;
+
+		// the sketch for each group, for an approximate count of the distinct values
+		vector <HyperLogLog> sketches;
+	};
+
+	// returns true if the grouping values at position keyPos in keys are the same as the ones for the given group
+	bool sameGroup (size_t whichGroup, vector <Column> &keys, size_t keyPos);
+
+	// returns the group with the given hash and the grouping values at position keyPos in keys; if
+	// it is not there, it is created if canAddGroup is true, and otherwise -1 is returned
+	long findGroup (size_t hashVal, vector <Column> &keys, size_t keyPos, bool canAddGroup);
+
+	// makes room for more groups, if the slots are getting too full
+	void grow ();
+
+	// updates the given aggregate for the given group with a value; isFirst is true if this is
+	// the first value that the group has seen
+	void update (size_t whichAgg, size_t whichGroup, MyDB_AttValPtr val, bool isFirst);
+
+	// updates the given aggregate for the given group with the same aggregate for a group in fromMe
+	void update (size_t whichAgg, size_t whichGroup, GroupTable &fromMe, size_t fromGroup, bool isFirst);
+
+	// the grouping values and the aggregates for all of the groups
+	vector <Column> groupCols;
+	vector <Column> aggCols;
+	vector <MyDB_AggType> aggTypes;
+	vector <int64_t> counts;
+	vector <size_t> hashes;
+
+	// the size of each group, not counting the characters in any strings or the distinct values,
+	// which are counted separately
+	size_t bytesPerGroup;
+	size_t extraBytes;
+
+	// the slots; the number of slots is always a power of two
+	vector <uint32_t> slots;
+	size_t mask;
+
+	// this holds the grouping values of the record being added, which are then compared with
+	// the values for each of the groups
+	vector <Column> keyCols;
+
+	// these are used to write out the groups
+	MyDB_IntAttValPtr intVal;
+	MyDB_DoubleAttValPtr doubleVal;
+	MyDB_StringAttValPtr stringVal;
+	MyDB_BoolAttValPtr boolVal;
+};
+
+#endif
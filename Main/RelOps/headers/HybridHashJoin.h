@@ -0,0 +1,83 @@
+
+#ifndef HYBRID_HASH_JOIN_H
+#define HYBRID_HASH_JOIN_H
+
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates a hybrid (Grace) hash join.  This is to be used in the case
+// that the smaller of the two input tables is too large to be hashed in RAM by a ScanJoin.
+//
+// Both tables are partitioned on the hash of their join keys, so that each record
+// from the left can only join with records from the right in the same partition.
+// As many partitions of the smaller table as fit in RAM are kept there; when they
+// outgrow the budget, the highest-numbered partition still in RAM is spilled to a
+// temporary table (and its pages let go), and so on until the rest fit.  Records
+// from the larger table that hash to an in-RAM partition are joined right away, as
+// the larger table is being partitioned, and the rest are spilled to temporary
+// tables.  Each pair of spilled partitions is then joined with a ScanJoin.  If a
+// partition is still too large to hash in RAM, it is partitioned again (using a
+// different hash function), and in the (rare) case that this does not help---because
+// there are too many records with the same key, for example---a SortMergeJoin is
+// used on that partition.
+//
+class HybridHashJoin {
+
+public:
+	// The parameters are exactly the same as for the ScanJoin.  Note that there
+	// needs to be at least one equality check, since those are used to partition
+	// the records; if there is none, then this just runs a ScanJoin.
+	//
+	HybridHashJoin (MyDB_TableReaderWriterPtr leftInput, MyDB_TableReaderWriterPtr rightInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate,
+		vector <string> projections,
+		vector <pair <string, string>> equalityChecks, string leftSelectionPredicate,
+		string rightSelectionPredicate);
+
+	// execute the join
+	void run ();
+
+private:
+
+	// this is used to join a pair of partitions that were too big to join in RAM...
+	// level is the number of times that the data have been partitioned, and namePrefix
+	// is used to give unique names to the temporary tables
+	HybridHashJoin (MyDB_TableReaderWriterPtr leftInput, MyDB_TableReaderWriterPtr rightInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate,
+		vector <string> projections,
+		vector <pair <string, string>> equalityChecks, string leftSelectionPredicate,
+		string rightSelectionPredicate, int level, string namePrefix);
+
+	// partitions both of the tables, joining the in-RAM partition along the way, and
+	// then joins all of the partitions that were spilled
+	void partitionAndJoin ();
+
+	// joins one pair of spilled partitions
+	void joinPartitions (MyDB_TableReaderWriterPtr leftPart, MyDB_TableReaderWriterPtr rightPart, int whichPart);
+
+	// maps the hash of a record's join keys to a partition
+	int getPartition (size_t hashVal);
+
+	string finalSelectionPredicate;
+	vector <pair <string, string>> equalityChecks;
+	vector <string> projections;
+	MyDB_TableReaderWriterPtr output;
+	MyDB_TableReaderWriterPtr leftTable;
+	MyDB_TableReaderWriterPtr rightTable;
+	string leftSelectionPredicate;
+	string rightSelectionPredicate;
+	bool hadToSwapThem;
+
+	// the number of pages that we can use to hash the smaller table
+	int budget;
+
+	// the number of partitions that we are creating
+	int numPartitions;
+
+	int level;
+	string namePrefix;
+};
+
+#endif
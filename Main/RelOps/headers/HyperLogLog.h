@@ -0,0 +1,52 @@
+
+#ifndef HYPER_LOG_LOG_H
+#define HYPER_LOG_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// This is a HyperLogLog sketch, which is used to estimate the number of distinct values in a
+// set, using a fixed (and small) amount of RAM: there are 2^HLL_BITS one-byte registers.  The
+// first HLL_BITS bits of each value's hash pick a register, and the register remembers the
+// largest number of leading zeros (plus one) seen in the rest of the hash bits of the values
+// that land there.  The more distinct values there are, the larger those numbers get.
+//
+// With 2^10 registers, the estimate is usually within about 3% of the true count.
+//
+// Two sketches are merged by taking the larger of each pair of registers; the result is just
+// what would have been gotten by adding all of the values to one sketch.  So partial sketches
+// (computed by different threads, for example) can be combined.
+//
+class HyperLogLog {
+
+public:
+
+	// the number of bits of the hash used to pick a register
+	static const int HLL_BITS = 10;
+
+	// creates an empty sketch
+	HyperLogLog ();
+
+	// adds a value to the sketch, given its hash
+	void add (size_t hashVal);
+
+	// adds all of the values in the other sketch to this one
+	void merge (HyperLogLog &fromMe);
+
+	// estimates the number of distinct values that have been added
+	double estimate ();
+
+	// the number of bytes taken up by the sketch
+	static inline size_t getBytes () {
+		return sizeof (HyperLogLog) + (1 << HLL_BITS);
+	}
+
+private:
+
+	vector <uint8_t> registers;
+};
+
+#endif
@@ -0,0 +1,74 @@
+
+#ifndef INDEX_NESTED_LOOP_JOIN_H
+#define INDEX_NESTED_LOOP_JOIN_H
+
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates an index nested-loop join, where one of the tables (the "inner"
+// table) is a B+-Tree that is ordered on its join attribute.  Rather than scanning the inner
+// table, the other (the "outer") table is sorted on its join key, and then the tree is
+// probed once for each distinct key.  This is a good idea when there are not too many
+// records in the outer table, and a lot of pages in the inner one.
+//
+// Since the keys are looked up in sorted order, consecutive lookups tend to land on the
+// same leaf pages.  So the leaf pages used by a lookup are kept pinned (and the records on
+// each of them are sorted on the key, so that they can be binary searched), and the next
+// lookup re-uses them, rather than reading and sorting them again.
+//
+class IndexNestedLoopJoin {
+
+public:
+	// This creates an index nested-loop join of the tables managed by outerInput and innerInput.
+	//
+	// The string finalSelectionPredicate encodes the predicate over records created by appending
+	// records from outerInput and innerInput (in that order).  Only records for which this predicate
+	// evaluates to true are appended to the output table.
+	//
+	// outerKey is a computation over the records in outerInput, and it must be equal to the
+	// attribute that innerInput is ordered on, for the final record to be accepted by the
+	// predicate (that is, the predicate must include this equality check).
+	//
+	// As records are read in from outerInput (resp. innerInput), they are discarded if the predicate
+	// encoded by outerSelectionPredicate (resp. innerSelectionPredicate) does not evaluate to true.
+	//
+	// Finally, the vector projections contains all of the computations that are performed to create
+	// the output records from the join.
+	//
+	IndexNestedLoopJoin (MyDB_TableReaderWriterPtr outerInput, MyDB_BPlusTreeReaderWriterPtr innerInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate,
+		vector <string> projections, string outerKey, string outerSelectionPredicate,
+		string innerSelectionPredicate);
+
+	// execute the join
+	void run ();
+
+private:
+
+	// a leaf page of the inner table that is being kept around between lookups, along with
+	// the locations of all of the records on it, sorted on the key
+	struct LeafPage {
+		int pageNum;
+		MyDB_PageReaderWriter page;
+		vector <void *> sortedRecs;
+	};
+
+	// we keep no more than this many leaf pages pinned between lookups
+	static const int MAX_CACHED_LEAVES = 4;
+
+	string finalSelectionPredicate;
+	vector <string> projections;
+	string outerKey;
+	MyDB_TableReaderWriterPtr output;
+	MyDB_TableReaderWriterPtr outerTable;
+	MyDB_BPlusTreeReaderWriterPtr innerTable;
+	string outerSelectionPredicate;
+	string innerSelectionPredicate;
+	int runSize;
+};
+
+#endif
@@ -0,0 +1,53 @@
+
+#ifndef ORDERED_AGG_H
+#define ORDERED_AGG_H
+
+#include "Aggregate.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates an aggregation + group by over an input that is already sorted on one
+// of the grouping computations (the "ordering key"): for example, a B+-Tree that is ordered on a
+// grouping attribute, or the output of a SortMergeJoin on a grouping attribute.
+//
+// Since the input is sorted, all of the records with the same value for the ordering key are next
+// to each other, and so every group is completely contained in one such run of records.  So the
+// records are read in order, and each run is aggregated on its own; once the ordering key changes,
+// all of the groups for the run are written out, and then thrown away.  If the ordering key is the
+// only grouping computation, there is only one group in RAM at a time, no matter how many groups
+// there are in all.
+//
+class OrderedAggregate {
+
+public:
+	// This aggregates the table pointed to by input, which must be sorted on orderingKey (one of the
+	// computations in groupings), and the records are read in the order that they are in the table.
+	// All of the other parameters are exactly the same as for the Aggregate.
+	OrderedAggregate (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <MyDB_AggType, string>> aggsToCompute,
+		vector <string> groupings, string selectionPredicate, string orderingKey);
+
+	// This aggregates the B+-Tree pointed to by input, reading its records in sorted order; the
+	// attribute that the tree is ordered on must be one of the groupings
+	OrderedAggregate (MyDB_BPlusTreeReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <MyDB_AggType, string>> aggsToCompute,
+		vector <string> groupings, string selectionPredicate);
+
+	// execute the aggregation
+	void run ();
+
+private:
+
+	MyDB_TableReaderWriterPtr input;
+	MyDB_BPlusTreeReaderWriterPtr inputTree;
+	MyDB_TableReaderWriterPtr output;
+	vector <pair <MyDB_AggType, string>> aggsToCompute;
+	vector <string> groupings;
+	string selectionPredicate;
+	string orderingKey;
+};
+
+#endif
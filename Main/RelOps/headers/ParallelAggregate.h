@@ -0,0 +1,80 @@
+
+#ifndef PARALLEL_AGG_H
+#define PARALLEL_AGG_H
+
+#include "Aggregate.h"
+#include "GroupTable.h"
+#include "MyDB_TableReaderWriter.h"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates a multi-threaded version of the Aggregate, which is done in two phases.
+//
+// In the first phase, the input table is pinned a chunk of pages at a time, and each page of the
+// chunk is handed to the TaskScheduler as a task; the threads pre-aggregate the records on the
+// pages that they get into their own GroupTables.  Each thread has one GroupTable for each
+// partition (the partition is picked using the hash of the grouping values), so that a thread's
+// partial aggregates are already split up by partition.
+//
+// In the second phase, each partition is a task; the threads merge all of the threads' partial
+// aggregates for each partition into one table.  Since a group can only be in one partition, no
+// two threads ever touch the same group.  The main thread then writes out the groups.
+//
+// If there is no GROUP BY, there is just one partition, and each thread just keeps one running
+// set of aggregates (see GroupTable), so there is no hashing at all.
+//
+// Like the Aggregate, all of the groups need to fit in RAM (since there can't be more groups than
+// records, they will as long as the input table is not too much bigger than the buffer pool).
+// None of the threads besides the main one touch the buffer manager, or compile computations.
+//
+class ParallelAggregate {
+
+public:
+
+	// The parameters are exactly the same as for the Aggregate.  The aggregation uses as
+	// many threads as the TaskScheduler allows by default.
+	ParallelAggregate (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <MyDB_AggType, string>> aggsToCompute,
+		vector <string> groupings, string selectionPredicate);
+
+	// same as above, but the number of threads is given
+	ParallelAggregate (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <MyDB_AggType, string>> aggsToCompute,
+		vector <string> groupings, string selectionPredicate, int numThreads);
+
+	// execute the aggregation
+	void run ();
+
+private:
+
+	// everything that one thread needs in order to read and aggregate records; all of this is
+	// set up by the main thread, since computations cannot be compiled in parallel
+	struct ThreadState {
+
+		MyDB_RecordPtr inputRec;
+		func inputPred;
+		function <size_t ()> groupingHash;
+		vector <func> groupingComps;
+		vector <func> aggComps;
+
+		// this thread's partial aggregates, one table for each partition
+		vector <GroupTable> partials;
+	};
+
+	// maps the hash of a record's grouping values to a partition
+	int getPartition (size_t hashVal);
+
+	MyDB_TableReaderWriterPtr input;
+	MyDB_TableReaderWriterPtr output;
+	vector <pair <MyDB_AggType, string>> aggsToCompute;
+	vector <string> groupings;
+	string selectionPredicate;
+
+	int numThreads;
+	int numPartitions;
+	vector <ThreadState> threads;
+};
+
+#endif
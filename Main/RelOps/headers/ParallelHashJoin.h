@@ -0,0 +1,133 @@
+
+#ifndef PARALLEL_HASH_JOIN_H
+#define PARALLEL_HASH_JOIN_H
+
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_TableReaderWriter.h"
+#include "RecordHashTable.h"
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// This class encapsulates a multi-threaded version of the ScanJoin.  Like the ScanJoin, the smaller
+// table is pinned in RAM in its entirity and hashed, and the larger table is scanned.
+//
+// The records of the smaller table are radix-partitioned on the hash of their join keys by all of
+// the threads, so that each partition is small enough that its hash table fits in cache, and then
+// the threads build the partitions' hash tables in parallel.  All of the work is run on the
+// TaskScheduler: reading and hashing is done a page at a time, and building and probing are done a
+// partition at a time.  The larger table is pinned a chunk of pages at a time; each chunk is
+// partitioned the same way, and then the threads probe the partitions in parallel, so that each
+// thread is only using one (cache-resident) hash table at a time.  Each thread writes its output
+// records into its own buffer, and these are appended to the output table by the main thread once
+// the chunk is done.
+//
+// If a few join keys are very common on either side (heavy hitters, found by sampling the hashes),
+// then whichever partitions those keys land in would have most of the work, and one thread would
+// end up doing it all.  So the records from the larger table with those keys are not partitioned;
+// instead, the ones that each thread found are probed as a separate task.  Since the partitions'
+// hash tables are not changed once they are built, every thread can probe every one of them, so the
+// smaller table's records for those keys are effectively broadcast to all of the threads.
+//
+// None of the threads besides the main one touch the buffer manager, or compile computations
+// (neither of those is thread safe); all of the pages that they read are pinned up front, and
+// the threads read records straight from the pinned bytes.
+//
+class ParallelHashJoin {
+
+public:
+
+	// The parameters are exactly the same as for the ScanJoin.  The join uses as many
+	// threads as the TaskScheduler allows by default.
+	ParallelHashJoin (MyDB_TableReaderWriterPtr leftInput, MyDB_TableReaderWriterPtr rightInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate,
+		vector <string> projections,
+		vector <pair <string, string>> equalityChecks, string leftSelectionPredicate,
+		string rightSelectionPredicate);
+
+	// same as above, but the number of threads is given
+	ParallelHashJoin (MyDB_TableReaderWriterPtr leftInput, MyDB_TableReaderWriterPtr rightInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate,
+		vector <string> projections,
+		vector <pair <string, string>> equalityChecks, string leftSelectionPredicate,
+		string rightSelectionPredicate, int numThreads);
+
+	// execute the join
+	void run ();
+
+private:
+
+	// everything that one thread needs in order to read, hash, and join records; all of this
+	// is set up by the main thread, since computations cannot be compiled in parallel
+	struct ThreadState {
+
+		MyDB_RecordPtr leftRec;
+		func leftPred;
+		function <size_t ()> leftHash;
+
+		MyDB_RecordPtr rightRec;
+		func rightPred;
+		function <size_t ()> rightHash;
+
+		// the final predicate and the computations are compiled over combinedRec, which is
+		// built from leftRec and rightRec
+		MyDB_RecordPtr combinedRec;
+		func finalPred;
+		vector <func> finalComputations;
+		MyDB_RecordPtr outputRec;
+
+		// the (hash, location) pairs found by this thread, first as one list, and then split
+		// up into one list per partition
+		vector <pair <size_t, void *>> found;
+		vector <vector <pair <size_t, void *>>> partitioned;
+
+		// the records from the right whose keys are heavy hitters, sorted on their hashes; these are
+		// probed as their own task, rather than being put into a partition
+		vector <pair <size_t, void *>> heavy;
+
+		// the output records produced by this thread, serialized back-to-back
+		vector <char> outputBytes;
+	};
+
+	// has the threads hash all of the records in the given pages (checking the selection
+	// predicate on the left or on the right), and then split them into partitions
+	void partitionPages (vector <pair <void *, void *>> &pages, bool isLeft);
+
+	// the partition for a hash is given by its high bits
+	inline size_t getPartition (size_t hashVal) {
+		return numPartitionBits == 0 ? 0 : (((uint64_t) hashVal) >> (64 - numPartitionBits));
+	}
+
+	// adds the hashes that are very common among the records that the threads have found to heavyHitters
+	void findHeavyHitters ();
+
+	// probes the hash table with probes[first] through probes[last - 1], writing the results to the thread's buffer
+	void probe (ThreadState &myState, vector <pair <size_t, void *>> &probes, size_t first, size_t last,
+		RecordHashTable &myTable);
+
+	// moves the records that the threads have written to their output buffers into the output table
+	void flushOutput ();
+
+	string finalSelectionPredicate;
+	vector <pair <string, string>> equalityChecks;
+	vector <string> projections;
+	MyDB_TableReaderWriterPtr output;
+	MyDB_TableReaderWriterPtr leftTable;
+	MyDB_TableReaderWriterPtr rightTable;
+	string leftSelectionPredicate;
+	string rightSelectionPredicate;
+
+	int numThreads;
+	vector <ThreadState> threads;
+
+	// the number of partitions is always 2^numPartitionBits
+	int numPartitionBits;
+	vector <RecordHashTable> tables;
+
+	// the hashes of the keys that are heavy hitters
+	unordered_set <size_t> heavyHitters;
+};
+
+#endif
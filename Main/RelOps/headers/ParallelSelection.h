@@ -0,0 +1,53 @@
+
+#ifndef PARALLEL_SELECTION_H
+#define PARALLEL_SELECTION_H
+
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates a multi-threaded version of the RegularSelection.  The input table is
+// pinned a chunk of pages at a time, and each page of the chunk is handed to the TaskScheduler as
+// a task.  Each page's output records are written into a buffer for that page, and once the chunk
+// is done, the main thread appends the buffers to the output table in page order, so the output
+// comes out in the same order as it would from the RegularSelection.
+//
+// None of the threads besides the main one touch the buffer manager, or compile computations.
+//
+class ParallelSelection {
+
+public:
+
+	// The parameters are exactly the same as for the RegularSelection.  The selection uses as
+	// many threads as the TaskScheduler allows by default.
+	ParallelSelection (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		string selectionPredicate, vector <string> projections);
+
+	// same as above, but the number of threads is given
+	ParallelSelection (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		string selectionPredicate, vector <string> projections, int numThreads);
+
+	// execute the selection operation
+	void run ();
+
+private:
+
+	// everything that one thread needs in order to read records and compute the output; all of
+	// this is set up by the main thread, since computations cannot be compiled in parallel
+	struct ThreadState {
+		MyDB_RecordPtr inputRec;
+		func pred;
+		vector <func> finalComputations;
+		MyDB_RecordPtr outputRec;
+	};
+
+	MyDB_TableReaderWriterPtr input;
+	MyDB_TableReaderWriterPtr output;
+	string selectionPredicate;
+	vector <string> projections;
+
+	int numThreads;
+};
+
+#endif
@@ -0,0 +1,131 @@
+
+#ifndef REC_HASH_TABLE_H
+#define REC_HASH_TABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// This is a hash table that maps the hash of a record's key (as computed by ScanJoin or
+// Aggregate, by hashing all of the key attributes) to the locations of all of the records
+// with that hash.  It is used in place of an unordered_map <size_t, vector <void *>>, which
+// needs a node allocation for each key and a separate vector for each list of records.
+//
+// There is one slot for each distinct hash value, in a flat array that uses open addressing
+// (linear probing).  Each slot holds the index of the first entry with that hash, along with
+// a 16-bit tag taken from the hash.  The entries themselves all live in one contiguous array;
+// each entry stores its hash and its record location, along with the index of the next entry
+// with the same hash.  When probing, the tag is checked first, so that we almost never look
+// at an entry (much less deserialize a record) unless it really has the hash we want.
+//
+// Since a lookup is almost always a cache miss, findBatch and insertBatch are provided; these
+// prefetch all of the slots for a batch of hashes before looking at any of them, so that the
+// cache misses can overlap.
+//
+// Entries are iterated as follows:
+//
+// for (long e = myTable.find (hashVal); e != -1; e = myTable.getNext (e)) {
+//	void *rec = myTable.getRecord (e);
+//	...
+// }
+//
+// The entries are numbered from 0 to size () - 1, so all of them can be visited by looping
+// through those numbers.
+//
+class RecordHashTable {
+
+public:
+
+	// create an empty table
+	RecordHashTable ();
+
+	// create an empty table with room for (about) the given number of distinct hashes
+	RecordHashTable (size_t expectedNumHashes);
+
+	// adds a record with the given hash
+	void insert (size_t hashVal, void *rec);
+
+	// adds all of the records in the batch; recs[i] has hash hashes[i]
+	void insertBatch (vector <size_t> &hashes, vector <void *> &recs);
+
+	// returns the first entry with the given hash, or -1 if there is none
+	long find (size_t hashVal);
+
+	// looks up all of the hashes in the batch; heads[i] is set to find (hashes[i])
+	void findBatch (vector <size_t> &hashes, vector <long> &heads);
+
+	// returns the next entry with the same hash as the given one, or -1 if there is none
+	inline long getNext (long whichEntry) {
+		return ((long) entries[whichEntry].next) - 1;
+	}
+
+	// returns the location of the record for the given entry
+	inline void *getRecord (long whichEntry) {
+		return entries[whichEntry].rec;
+	}
+
+	// returns the hash for the given entry
+	inline size_t getHash (long whichEntry) {
+		return entries[whichEntry].hashVal;
+	}
+
+	// the number of records in the table
+	inline size_t size () {
+		return entries.size ();
+	}
+
+	// the number of distinct hashes in the table
+	inline size_t getNumHashes () {
+		return numUsed;
+	}
+
+	// removes everything from the table, and gives back its RAM
+	void clear ();
+
+private:
+
+	struct Entry {
+		size_t hashVal;
+		void *rec;
+
+		// one plus the index of the next entry with the same hash; zero if there is none
+		uint32_t next;
+	};
+
+	struct Slot {
+
+		// one plus the index of the first entry with this hash; zero if the slot is empty
+		uint32_t head;
+		uint16_t tag;
+	};
+
+	// scrambles the hash; the low bits pick the slot, and the high bits are the tag
+	static inline uint64_t mix (size_t hashVal) {
+		uint64_t x = hashVal;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	// returns the slot holding the given hash, or the empty slot where it would go
+	size_t findSlot (size_t hashVal, uint64_t mixed);
+
+	// makes sure that numMore additional hashes can be added without the table getting too full
+	void reserve (size_t numMore);
+
+	// adds an entry, given the slot that it goes into
+	void insertAt (size_t whichSlot, size_t hashVal, uint64_t mixed, void *rec);
+
+	vector <Slot> slots;
+	vector <Entry> entries;
+
+	// slots.size () - 1; the number of slots is always a power of two
+	size_t mask;
+
+	// the number of slots that are in use
+	size_t numUsed;
+};
+
+#endif
@@ -0,0 +1,93 @@
+
+#ifndef RUNTIME_FILTER_H
+#define RUNTIME_FILTER_H
+
+#include "MyDB_Record.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// This is a filter that is built from the join keys on one side of a join (the "build" side),
+// and then used to throw away records on the other side (the "probe" side) that cannot possibly
+// have a match, before any real work (checking the selection predicate, probing a hash table,
+// sorting) is done on them.
+//
+// There are two parts to the filter.  The first is a blocked Bloom filter over the hashes of the
+// keys (as computed by buildKeyHasher); each key sets three bits in a single 64-bit word, so a check
+// touches only one word.  The second is the range (min and max) of the key values, which is only
+// kept when there is a single join key and it is a number; this is a lot cheaper to check than
+// the Bloom filter, and gets rid of everything when the two sides' keys do not overlap much.
+//
+// Note that a filter to which nothing has been added rejects everything.
+//
+class RuntimeFilter {
+
+public:
+
+	// creates an empty filter, with about 10 bits per key for the given number of keys
+	RuntimeFilter (size_t expectedNumKeys);
+
+	// adds the hash of a key to the Bloom filter
+	inline void addHash (size_t hashVal) {
+		bits[whichWord (hashVal)] |= whichBits (hashVal);
+	}
+
+	// returns false if no key with this hash was added
+	inline bool mayContainHash (size_t hashVal) {
+		uint64_t mask = whichBits (hashVal);
+		return (bits[whichWord (hashVal)] & mask) == mask;
+	}
+
+	// adds a key value to the range
+	inline void addToRange (double val) {
+		if (!haveRange || val < low)
+			low = val;
+		if (!haveRange || val > high)
+			high = val;
+		haveRange = true;
+	}
+
+	// returns false if the value is outside of the range of values that were added; if
+	// addToRange () has never been called, this always returns true
+	inline bool inRange (double val) {
+		return !haveRange || (val >= low && val <= high);
+	}
+
+	// if there is one key and it is a number, this returns a function that computes it over the
+	// current contents of rec (for use with addToRange () and inRange ()); otherwise it returns nullptr
+	static function <double ()> buildRangeKey (MyDB_RecordPtr rec, vector <string> &keys);
+
+	// returns a function that adds the keys in the current contents of rec to the filter, and
+	// then returns true; this is used to build the filter while the build side is being scanned
+	function <bool ()> buildAdder (MyDB_RecordPtr rec, vector <string> &keys);
+
+	// returns a function that checks the keys in the current contents of rec against the filter
+	function <bool ()> buildChecker (MyDB_RecordPtr rec, vector <string> &keys);
+
+private:
+
+	// the Bloom filter uses the low bits of the hash to pick a word, and three sets of six
+	// higher bits to pick the bits in the word
+	inline size_t whichWord (size_t hashVal) {
+		return hashVal & wordMask;
+	}
+
+	inline uint64_t whichBits (size_t hashVal) {
+		return (1ULL << ((hashVal >> 34) & 63)) | (1ULL << ((hashVal >> 40) & 63)) |
+			(1ULL << ((hashVal >> 46) & 63));
+	}
+
+	vector <uint64_t> bits;
+	size_t wordMask;
+
+	bool haveRange;
+	double low;
+	double high;
+};
+
+typedef shared_ptr <RuntimeFilter> RuntimeFilterPtr;
+
+#endif
@@ -10,6 +10,9 @@
 // This class encapulates a sort merge join.  This is to be used in the case that the
 // two input tables are too large to be stored in RAM.
 //
+// If an input is a B+-Tree that is ordered on one of its join keys, then it is read in
+// order, rather than sorted, and the merge is done on just that pair of keys.
+//
 class SortMergeJoin {
 
 public:
@@ -38,6 +41,17 @@ public:
 		vector <string> projections,
 		pair <string, string> equalityCheck, string leftSelectionPredicate,
 		string rightSelectionPredicate);
+
+	// same as above, except that there can be more than one pair of computations that must
+	// match.  The left relation is sorted using all of the .first computations (first on
+	// equalityChecks[0].first, with ties broken using equalityChecks[1].first, and so on),
+	// the right relation is sorted using all of the .second computations, and the merge
+	// compares the two records on all of the pairs in the same order
+	SortMergeJoin (MyDB_TableReaderWriterPtr leftInput, MyDB_TableReaderWriterPtr rightInput,
+		MyDB_TableReaderWriterPtr output, string finalSelectionPredicate, 
+		vector <string> projections,
+		vector <pair <string, string>> equalityChecks, string leftSelectionPredicate,
+		string rightSelectionPredicate);
 	
 	// execute the join
 	void run ();
@@ -46,7 +60,7 @@ private:
 
 	int runSize;
 	string finalSelectionPredicate;
-	pair <string, string> equalityCheck;
+	vector <pair <string, string>> equalityChecks;
 	vector <string> projections;
 	MyDB_TableReaderWriterPtr output;
 	MyDB_TableReaderWriterPtr leftTable;
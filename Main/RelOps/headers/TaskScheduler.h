@@ -0,0 +1,58 @@
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <cstddef>
+#include <functional>
+
+using namespace std;
+
+// This is the scheduler that all of the multi-threaded operations run their work on.  Rather than
+// each operation starting up its own threads, there is one pool of worker threads that stays
+// around for the life of the program; the pool grows (up to the largest number of threads that
+// anyone has asked for), but never shrinks.
+//
+// Work is handed to the scheduler as a batch of numbered tasks (a task is usually a "morsel" of
+// the input, such as one pinned page, or one partition of a hash table).  The tasks are split
+// up evenly between the threads that are working on the batch, and each thread runs its own
+// tasks in order.  A thread that runs out of tasks steals half of the tasks that some other
+// thread has not started yet, so a thread that is slow (because its pages had more matches, or
+// because the core that it is on is busy with something else) does not hold up the rest.
+//
+// The calling thread always works on its own batch, so a batch finishes even if all of the
+// workers are busy with other batches (for example, with another query).  Each batch also has
+// a limit on the number of threads that can work on it, so one query can't take over all of
+// the cores; by default, this limit is the one given to setMaxThreads.
+//
+// Just as before, the tasks cannot touch the buffer manager, or compile computations, since
+// neither of those is thread safe.  So an operation pins whatever pages it needs and sets up
+// the state for each thread before handing out the tasks.  It is used as follows:
+//
+// // the state for each of the threads
+// vector <ThreadState> threads (numThreads);
+// ...
+// TaskScheduler :: run (numPages, numThreads, [&] (int whichThread, size_t whichTask) {
+//	ThreadState &myState = threads[whichThread];
+//	// process page whichTask
+// });
+//
+class TaskScheduler {
+
+public:
+
+	// runs runMe (whichThread, whichTask) for every task from 0 up to numTasks - 1, using no more
+	// than numThreads threads (one of which is the calling thread), and returns once all of the
+	// tasks are done.  whichThread is from 0 up to numThreads - 1, and no two tasks with the same
+	// whichThread are ever run at the same time, so it can be used to pick per-thread state
+	static void run (size_t numTasks, int numThreads, function <void (int, size_t)> runMe);
+
+	// same as above, but it uses the default limit on the number of threads
+	static void run (size_t numTasks, function <void (int, size_t)> runMe);
+
+	// gets and sets the default limit on the number of threads that work on a batch of tasks; this
+	// starts out as the number of cores on the machine
+	static int getMaxThreads ();
+	static void setMaxThreads (int maxThreads);
+};
+
+#endif
@@ -0,0 +1,66 @@
+
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// This class encapsulates an ORDER BY, optionally with a LIMIT.  The records in
+// input are written to output (which must have the same schema) in sorted order.
+//
+// If there is a limit of K records, then while input is scanned, a bounded heap
+// holding the best K records seen so far is maintained; this means that only
+// one pass over the input is needed, and that nothing has to be written out.
+// If the K records do not fit in the memory that we are allowed to use, or if
+// there is no limit, then we fall back to the external sort in Sorting.cc.
+
+class TopK {
+
+public:
+	//
+	// The vector orderBy lists the computations to sort on, from most to least
+	// significant.  The bool in each pair is true if that one is sorted in
+	// ascending order, and false if it is sorted in descending order.  For example:
+	//
+	// <("[att1]", false), ("+ ([att2], [att3])", true)>
+	//
+	// corresponds to:
+	//
+	// ORDER BY att1 DESC, att2 + att3 ASC
+	//
+	// At most limit records are written to output.
+	//
+	TopK (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <string, bool>> orderBy, long limit);
+
+	// same as above, but every record is written to output
+	TopK (MyDB_TableReaderWriterPtr input, MyDB_TableReaderWriterPtr output,
+		vector <pair <string, bool>> orderBy);
+
+	// execute the operation
+	void run ();
+
+private:
+
+	// builds a comparator that returns true if lhs comes before rhs in the ordering
+	function <bool ()> buildOrderingComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
+
+	// keeps the best limit records in a heap; returns false (and writes nothing) if
+	// they do not fit in memory
+	bool runWithHeap ();
+
+	// sorts the input using an external sort, and writes the first limit records
+	void runWithSort ();
+
+	MyDB_TableReaderWriterPtr input;
+	MyDB_TableReaderWriterPtr output;
+	vector <pair <string, bool>> orderBy;
+	long limit;
+
+	// the number of pages that we are allowed to use
+	int runSize;
+};
+
+#endif
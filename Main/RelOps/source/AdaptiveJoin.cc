@@ -0,0 +1,203 @@
+
+#ifndef ADAPTIVE_JOIN_C
+#define ADAPTIVE_JOIN_C
+
+#include "AdaptiveJoin.h"
+#include "HybridHashJoin.h"
+#include "KeyHash.h"
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_Record.h"
+#include "RecordHashTable.h"
+#include "SortMergeJoin.h"
+
+using namespace std;
+
+// we flip the sides if the side being hashed turns out to have this many times more records than were
+// estimated for the other side
+#define FLIP_FACTOR 2.0
+
+// if, when we run out of RAM, there are at least this many records hashed per distinct key, then
+// partitioning on the keys is not going to split things up much
+#define SKEWED_RECORDS_PER_KEY 64
+
+AdaptiveJoin :: AdaptiveJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWriterPtr rightInputIn,
+                MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn,
+		vector <string> projectionsIn,
+                vector <pair <string, string>> equalityChecksIn, string leftSelectionPredicateIn,
+                string rightSelectionPredicateIn, double leftEstimateIn, double rightEstimateIn) {
+
+	output = outputIn;
+	finalSelectionPredicate = finalSelectionPredicateIn;
+	projections = projectionsIn;
+	equalityChecks = equalityChecksIn;
+	leftTable = leftInputIn;
+	rightTable = rightInputIn;
+	leftSelectionPredicate = leftSelectionPredicateIn;
+	rightSelectionPredicate = rightSelectionPredicateIn;
+	leftEstimate = leftEstimateIn;
+	rightEstimate = rightEstimateIn;
+	budget = leftInputIn->getBufferMgr ()->getNumPages () / 2;
+	looksSkewed = false;
+}
+
+void AdaptiveJoin :: run () {
+
+	// start out by hashing the side that we think is smaller
+	bool hashLeft = (leftEstimate <= rightEstimate);
+	InRAMResult result = joinInRAM (hashLeft, true);
+
+	// if the estimates were wrong, hash the other side... but only once
+	if (result == FLIPPED)
+		result = joinInRAM (!hashLeft, false);
+
+	if (result == JOINED)
+		return;
+
+	// if we got here, the side that we were hashing did not fit in RAM, so we have to go to disk... if
+	// there were only a few distinct keys, partitioning won't help, so we sort instead
+	if (looksSkewed && equalityChecks.size () > 0) {
+		SortMergeJoin myOp (leftTable, rightTable, output, finalSelectionPredicate, projections,
+			equalityChecks, leftSelectionPredicate, rightSelectionPredicate);
+		myOp.run ();
+	} else {
+		HybridHashJoin myOp (leftTable, rightTable, output, finalSelectionPredicate, projections,
+			equalityChecks, leftSelectionPredicate, rightSelectionPredicate);
+		myOp.run ();
+	}
+}
+
+AdaptiveJoin :: InRAMResult AdaptiveJoin :: joinInRAM (bool hashLeft, bool canFlip) {
+
+	// figure out which side is which
+	MyDB_TableReaderWriterPtr hashTable = hashLeft ? leftTable : rightTable;
+	MyDB_TableReaderWriterPtr scanTable = hashLeft ? rightTable : leftTable;
+	string hashPredicate = hashLeft ? leftSelectionPredicate : rightSelectionPredicate;
+	string scanPredicate = hashLeft ? rightSelectionPredicate : leftSelectionPredicate;
+	double scanEstimate = hashLeft ? rightEstimate : leftEstimate;
+	vector <string> hashKeys;
+	vector <string> scanKeys;
+	for (auto &p : equalityChecks) {
+		hashKeys.push_back (hashLeft ? p.first : p.second);
+		scanKeys.push_back (hashLeft ? p.second : p.first);
+	}
+
+	// this is the hash table we'll use to look up data... the key is the hashed value
+	// of all of the records' join keys, and it gives us a list of pointers were all
+	// of the records with that hsah value are located
+	RecordHashTable myHash;
+
+	// the records that pass the selection predicate are copied into these pinned pages
+	MyDB_BufferManagerPtr myMgr = hashTable->getBufferMgr ();
+	vector <MyDB_PageReaderWriter> pagesInRAM;
+
+	// get the hashed side's record, and the various functions over it
+	MyDB_RecordPtr hashRec = hashTable->getEmptyRecord ();
+	function <size_t ()> hashHash = buildKeyHasher (hashRec, hashKeys);
+	func hashPred = hashRec->compileComputation (hashPredicate);
+
+	// hash the side
+	MyDB_RecordIteratorAltPtr myIter = hashTable->getIteratorAlt ();
+	while (myIter->advance ()) {
+
+		myIter->getCurrent (hashRec);
+
+		// see if it is accepted by the preicate
+		if (!hashPred ()->toBool ()) {
+			continue;
+		}
+
+		// put it into RAM
+		void *loc = nullptr;
+		if (pagesInRAM.size () > 0)
+			loc = pagesInRAM.back ().appendAndReturnLocation (hashRec);
+
+		if (loc == nullptr) {
+
+			// we are out of RAM; the pinned pages are let go when we return
+			if (pagesInRAM.size () >= budget) {
+				looksSkewed = (myHash.getNumHashes () * SKEWED_RECORDS_PER_KEY < myHash.size ());
+				return OVERFLOWED;
+			}
+
+			pagesInRAM.push_back (MyDB_PageReaderWriter (true, *myMgr));
+			loc = pagesInRAM.back ().appendAndReturnLocation (hashRec);
+		}
+
+		myHash.insert (hashHash (), loc);
+
+		// if this side is a lot bigger than the other one is supposed to be, the estimates must have
+		// been off, and we should be hashing the other side (we don't bother when this side fits on a page)
+		if (canFlip && pagesInRAM.size () > 1 && myHash.size () > FLIP_FACTOR * scanEstimate) {
+			return FLIPPED;
+		}
+	}
+
+	// now get the scanned side's record, and the various functions over it
+	MyDB_RecordPtr scanRec = scanTable->getEmptyRecord ();
+	function <size_t ()> scanHash = buildKeyHasher (scanRec, scanKeys);
+	func scanPred = scanRec->compileComputation (scanPredicate);
+
+	// and get the schema that results from combining the left and right records
+	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
+	for (auto &p : hashTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+	for (auto &p : scanTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+
+	// get the combined record
+	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (mySchemaOut);
+	combinedRec->buildFrom (hashRec, scanRec);
+
+	// now, get the final predicate over it
+	func finalPredicate = combinedRec->compileComputation (finalSelectionPredicate);
+
+	// and get the final set of computatoins that will be used to buld the output record
+	vector <func> finalComputations;
+	for (string s : projections) {
+		finalComputations.push_back (combinedRec->compileComputation (s));
+	}
+
+	// this is the output record
+	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+
+	// scan the other side, and probe the hash table
+	MyDB_RecordIteratorAltPtr myIterAgain = scanTable->getIteratorAlt ();
+	while (myIterAgain->advance ()) {
+
+		myIterAgain->getCurrent (scanRec);
+
+		// see if it is accepted by the preicate
+		if (!scanPred ()->toBool ()) {
+			continue;
+		}
+
+		// iterate though the potential matches, checking each of them
+		for (long e = myHash.find (scanHash ()); e != -1; e = myHash.getNext (e)) {
+
+			// build the combined record
+			hashRec->fromBinary (myHash.getRecord (e));
+
+			// check to see if it is accepted by the join predicate
+			if (finalPredicate ()->toBool ()) {
+
+				// run all of the computations
+				int i = 0;
+				for (auto &f : finalComputations) {
+					outputRec->getAtt (i++)->set (f());
+				}
+
+				// the record's content has changed because it
+				// is now a composite of two records whose content
+				// has changed via a read... we have to tell it this,
+				// or else the record's internal buffer may cause it
+				// to write old values
+				outputRec->recordContentHasChanged ();
+				output->append (outputRec);
+			}
+		}
+	}
+
+	return JOINED;
+}
+
+#endif
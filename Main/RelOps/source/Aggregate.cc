@@ -2,220 +2,193 @@
 #ifndef AGG_CC
 #define AGG_CC
 
+#include "GroupTable.h"
+#include "KeyHash.h"
 #include "MyDB_Record.h"
-#include "MyDB_PageReaderWriter.h"
 #include "MyDB_TableReaderWriter.h"
 #include "Aggregate.h"
-#include <unordered_map>
+
+#include <cstdint>
 
 using namespace std;
 
+// the number of times that we will re-partition a partition that is too big before giving up,
+// and just aggregating it in RAM
+#define MAX_PARTITION_LEVELS 3
+
 Aggregate :: Aggregate (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
                 vector <pair <MyDB_AggType, string>> aggsToComputeIn,
-                vector <string> groupingsIn, string selectionPredicateIn) {
+                vector <string> groupingsIn, string selectionPredicateIn) : Aggregate (inputIn, outputIn,
+		aggsToComputeIn, groupingsIn, selectionPredicateIn, 0, outputIn->getTable ()->getStorageLoc () + "_agg") {}
+
+Aggregate :: Aggregate (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                vector <pair <MyDB_AggType, string>> aggsToComputeIn,
+                vector <string> groupingsIn, string selectionPredicateIn, int levelIn, string namePrefixIn) {
 
 	input = inputIn;
 	output = outputIn;
 	aggsToCompute = aggsToComputeIn;
 	groupings = groupingsIn;
 	selectionPredicate = selectionPredicateIn;
+	level = levelIn;
+	namePrefix = namePrefixIn;
+	inputSchema = input->getTable ()->getSchema ();
+	myMgr = input->getBufferMgr ();
+
+	// the groups can use half of the buffer pool
+	int budgetPages = myMgr->getNumPages () / 2;
+	budget = budgetPages * myMgr->getPageSize ();
+
+	// there can't be more groups than records, so this many partitions should be enough to make
+	// each of them fit... each partition needs a page in RAM that is being appended to
+	numPartitions = (int) (1.2 * input->getNumPages () / budgetPages) + 1;
+	if (numPartitions > budgetPages / 2)
+		numPartitions = budgetPages / 2;
+	if (numPartitions < 2)
+		numPartitions = 2;
+}
+
+Aggregate :: Aggregate (MyDB_SchemaPtr inputSchemaIn, MyDB_TableReaderWriterPtr outputIn,
+                vector <pair <MyDB_AggType, string>> aggsToComputeIn,
+                vector <string> groupingsIn, string selectionPredicateIn) {
+
+	input = nullptr;
+	output = outputIn;
+	aggsToCompute = aggsToComputeIn;
+	groupings = groupingsIn;
+	selectionPredicate = selectionPredicateIn;
+	level = 0;
+	namePrefix = output->getTable ()->getStorageLoc () + "_agg";
+	inputSchema = inputSchemaIn;
+	myMgr = output->getBufferMgr ();
+
+	int budgetPages = myMgr->getNumPages () / 2;
+	budget = budgetPages * myMgr->getPageSize ();
+
+	// we don't know how much input is coming, so use as many partitions as we can
+	numPartitions = budgetPages / 2;
+	if (numPartitions < 2)
+		numPartitions = 2;
+}
+
+int Aggregate :: getPartition (size_t hashVal) {
 
+	// re-mix the hash, so that each level of partitioning splits up the data differently than
+	// the last one did, and differently than the GroupTable does
+	uint64_t x = ((uint64_t) hashVal) + (level + 1) * 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x = x ^ (x >> 31);
+	return (int) (x % numPartitions);
 }
 
 void Aggregate :: run () {
 
-	// make sure that the number of attributes is OK
-	if (output->getTable ()->getSchema ()->getAtts ().size () != aggsToCompute.size () + groupings.size ()) {
-		cout << "error, the output schema needs to have the same number of atts as (# of aggs to compute + # groups).\n";
+	if (open () == nullptr)
 		return;
-	}
 
-	// first, we create a schema for the aggregate records... this is all grouping atts,
-	// followed by all aggregate atts, followed by the count att
-	MyDB_SchemaPtr aggSchema = make_shared <MyDB_Schema> ();
-	int i = 0;
-	int numGroups = groupings.size ();
-	for (auto &a : output->getTable ()->getSchema ()->getAtts ()) {
-		if (i < numGroups) 
-			aggSchema->appendAtt (make_pair ("MyDB_GroupAtt" + to_string (i++), a.second));
-		else
-			aggSchema->appendAtt (make_pair ("MyDB_AggAtt" + to_string (i++ - numGroups), a.second));
+	// at this point, we are ready to go!!
+	MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (inputRec);
+		push ();
 	}
-	aggSchema->appendAtt (make_pair ("MyDB_CntAtt", make_shared <MyDB_IntAttType> ()));
-
-	// now, create the schema for the combined records
-	MyDB_SchemaPtr combinedSchema = make_shared <MyDB_Schema> ();
-	for (auto &a : input->getTable ()->getSchema ()->getAtts ())
-		combinedSchema->appendAtt (a);
-	for (auto &a : aggSchema->getAtts ())
-		combinedSchema->appendAtt (a);
-
-	// now, get an intput rec, an agg rec, and a combined rec
-	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
-	MyDB_RecordPtr aggRec = make_shared <MyDB_Record> (aggSchema);
-	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (combinedSchema);
-	combinedRec->buildFrom (inputRec, aggRec);
-	
-	// this is the current page where we are writing aggregate records
-	MyDB_PageReaderWriter lastPage (true, *(input->getBufferMgr ()));
-
-	// this is the list all of the pages used to store aggregate records
-	vector <MyDB_PageReaderWriter> allPages;
-	allPages.push_back (lastPage);
-
-	// this is the hash index for all of the aggregate records
-	unordered_map <size_t, vector <void *>> myHash;
 
-	// this will compute each of the groupings
-	vector <func> groupingComps;
-	for (auto &s : groupings) {
-		groupingComps.push_back (inputRec->compileComputation (s));
+	close ();
+}
+
+MyDB_RecordPtr Aggregate :: open () {
+
+	// make sure that the number of attributes is OK
+	if (output->getTable ()->getSchema ()->getAtts ().size () != aggsToCompute.size () + groupings.size ()) {
+		cout << "error, the output schema needs to have the same number of atts as (# of aggs to compute + # groups).\n";
+		return nullptr;
 	}
 
-	// and this will verify that each of the groupings match up
-	func checkGroups;
-	string groupCheck;
-	i = 0;
+	// get an input rec
+	inputRec = make_shared <MyDB_Record> (inputSchema);
 
-	// in case there is not a grouping...
-	groupCheck = "bool[true]";
+	// the groups are kept in native arrays, using the types of the output atts
+	myTable = make_shared <GroupTable> (output->getTable ()->getSchema (), aggsToCompute, inputRec);
 
+	// this will compute each of the groupings
 	for (auto &s : groupings) {
-		string curClause = "== (" + s + ", [MyDB_GroupAtt" + to_string (i) + "])";
-		if (i == 0) {
-			groupCheck = curClause;
-		} else {
-			groupCheck = "&& (" + curClause + ", " + groupCheck + ")";
-		}
-		i++;
+		groupingComps.push_back (inputRec->compileComputation (s));
 	}
-	checkGroups = combinedRec->compileComputation (groupCheck);	
-
-	// this will compute each of the aggregates for updating the aggregate record
-	vector <func> aggComps;
 
-	// this will compute the final aggregate value for each output record
-	vector <func> finalAggComps;
+	// and this will hash them
+	groupingHash = buildKeyHasher (inputRec, groupings);
 
-	i = 0;
+	// this will compute the value to aggregate for each of the aggregates (a count does not need one)
 	for (auto &s : aggsToCompute) {
-		if (s.first == MyDB_AggType :: Sum || s.first == MyDB_AggType :: Avg) {
-			aggComps.push_back (combinedRec->compileComputation ("+ (" + s.second + 
-				", [MyDB_AggAtt" + to_string (i) + "])"));
-		} else if (s.first == MyDB_AggType :: Cnt) {
-			aggComps.push_back (combinedRec->compileComputation ("+ ( int[1], [MyDB_AggAtt"
-				+ to_string (i) + "])"));
-		}
-
-		if (s.first == MyDB_AggType :: Avg) {
-			finalAggComps.push_back (combinedRec->compileComputation ("/ ([MyDB_AggAtt" + to_string (i++) + "], [MyDB_CntAtt])"));
+		if (s.first == MyDB_AggType :: Cnt) {
+			aggComps.push_back (nullptr);
 		} else {
-			finalAggComps.push_back (combinedRec->compileComputation ("[MyDB_AggAtt" + to_string (i++) + "]"));
+			aggComps.push_back (inputRec->compileComputation (s.second));
 		}
 	}
-	aggComps.push_back (combinedRec->compileComputation ("+ ( int[1], [MyDB_CntAtt])"));
 
 	// and this runs the selection on the input records
-	func inputPred = inputRec->compileComputation (selectionPredicate);
+	inputPred = inputRec->compileComputation (selectionPredicate);
 
-	// at this point, we are ready to go!!
-	MyDB_RecordIteratorPtr myIter = input->getIterator (inputRec);
-	MyDB_AttValPtr zero = make_shared <MyDB_IntAttVal> ();
-	while (myIter->hasNext ()) {
+	// the temporary tables for the partitions are created once we first run out of RAM
+	partCounts.assign (numPartitions, 0);
 
-		myIter->getNext ();
-
-		// see if it is accepted by the preicate
-		if (!inputPred ()->toBool ()) {
-			continue;
-		}
-
-		// hash the current record
-		size_t hashVal = 0;
-		for (auto &f : groupingComps) {
-			hashVal ^= f ()->hash ();
-		}
-
-		// if there is a match, then get the list of matches
-		vector <void *> &potentialMatches = myHash [hashVal];
-		void *loc = nullptr;
-
-		// and iterate though the potential matches, checking each of them
-		for (auto &v : potentialMatches) {	
-
-			aggRec->fromBinary (v);
-
-			// check to see if it matches
-			if (!checkGroups ()->toBool ()) {
-				continue;
-			}
-
-			loc = v;
-			break;
-		}
-
-		// if we did not find a match...
-		if (loc == nullptr) {
-
-			// set up the record...
-			i = 0;
-			for (auto &f : groupingComps) {
-				aggRec->getAtt (i++)->set (f ());
-			}
-			for (int j = 0; j < aggComps.size (); j++) {
-				aggRec->getAtt (i++)->set (zero);
-			}
-		}
+	// once the groups fill up the budget, we stop adding new ones... unless we have already
+	// re-partitioned as many times as we are going to
+	canSpill = (level + 1 < MAX_PARTITION_LEVELS) && groupings.size () > 0;
+	isFull = false;
 
-		// update each of the aggregates
-		i = 0;
-		for (auto &f : aggComps) {
-			aggRec->getAtt (numGroups + i++)->set (f ());
-		}
+	return inputRec;
+}
 
-		// if we did not find a match, write to a new location...
-		aggRec->recordContentHasChanged ();
-		if (loc == nullptr) {
-			loc = lastPage.appendAndReturnLocation (aggRec);
+void Aggregate :: push () {
 
-			// if we could not write, then the page was full
-			if (loc == nullptr) {
-				MyDB_PageReaderWriter nextPage (true, *(input->getBufferMgr ()));
-				lastPage = nextPage;
-				allPages.push_back (lastPage);
-				loc = lastPage.appendAndReturnLocation (aggRec);	
-			}
+	// see if it is accepted by the preicate
+	if (!inputPred ()->toBool ()) {
+		return;
+	}
 
-			aggRec->fromBinary (loc);
-			myHash [hashVal].push_back (loc);
+	// add it to its group
+	size_t hashVal = groupingHash ();
+	if (myTable->add (hashVal, groupingComps, aggComps, !isFull)) {
+		isFull = canSpill && myTable->getBytesUsed () >= budget;
+		return;
+	}
 
-		// otherwise, re-write to the old location
-		} else {
-			aggRec->toBinary (loc);
+	// if its group is not there and there is no room for it, spill the record
+	if (parts.size () == 0) {
+		for (int j = 0; j < numPartitions; j++) {
+			string partName = namePrefix + "_" + to_string (level) + "_" + to_string (j);
+			parts.push_back (make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (partName,
+				partName, inputSchema), myMgr));
 		}
 	}
+	int whichPart = getPartition (hashVal);
+	parts[whichPart]->append (inputRec);
+	partCounts[whichPart]++;
+}
 
-	// now, we have processed all of the database records... so we can output the aggregates
-	MyDB_RecordIteratorAltPtr myIterAgain = getIteratorAlt (allPages);	
+void Aggregate :: close () {
 
-	// loop through all of the aggregate records
+	// now, we have processed all of the database records... so we can output the aggregates
 	MyDB_RecordPtr outRec = output->getEmptyRecord ();
-	while (myIterAgain->advance ()) {
-
-		myIterAgain->getCurrent (aggRec);
-
-		// set the grouping atts
-		for (i = 0; i < numGroups; i++) {
-			outRec->getAtt (i)->set (aggRec->getAtt (i));
-		}
-
-		// set the aggregate atts
-		for (auto &a : finalAggComps) {
-			outRec->getAtt (i++)->set (a ());
-		}
-		outRec->recordContentHasChanged ();
+	for (size_t j = 0; j < myTable->size (); j++) {
+		myTable->getGroup (j, outRec);
 		output->append (outRec);
 	}
+	myTable->clear ();
+
+	// and aggregate each of the spilled partitions... note that the selection predicate was already run
+	for (size_t j = 0; j < parts.size (); j++) {
+		if (partCounts[j] > 0) {
+			Aggregate myOp (parts[j], output, aggsToCompute, groupings, "bool[true]", level + 1,
+				namePrefix + "_" + to_string (level) + "_" + to_string (j));
+			myOp.run ();
+		}
+		myMgr->killTable (parts[j]->getTable ());
+	}
+	parts.clear ();
 }
 
 #endif
@@ -0,0 +1,419 @@
+
+#ifndef GROUP_TABLE_C
+#define GROUP_TABLE_C
+
+#include "GroupTable.h"
+#include "KeyHash.h"
+#include <cmath>
+
+using namespace std;
+
+// the slots are re-built once this fraction of them are full
+#define MAX_LOAD 0.7
+
+// about how many bytes each value in a hash set of distinct values takes up, not counting the
+// characters in a string
+#define DISTINCT_VALUE_BYTES 32
+
+// scrambles the hash, so that the low bits can be used to pick a slot
+static inline uint64_t mix (size_t hashVal) {
+	uint64_t x = hashVal;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+GroupTable :: GroupTable (MyDB_SchemaPtr outputSchema, vector <pair <MyDB_AggType, string>> &aggsToCompute,
+	MyDB_RecordPtr inputRec) {
+
+	vector <pair <string, MyDB_AttTypePtr>> &outputAtts = outputSchema->getAtts ();
+	size_t numGroups = outputAtts.size () - aggsToCompute.size ();
+	for (size_t i = 0; i < numGroups; i++) {
+		Column myCol;
+		myCol.type = getStorageType (outputAtts[i].second);
+		groupCols.push_back (myCol);
+	}
+	keyCols = groupCols;
+
+	bytesPerGroup = sizeof (size_t) + sizeof (int64_t);
+	for (auto &c : groupCols)
+		bytesPerGroup += (c.type == StringStorage) ? sizeof (string) : sizeof (int64_t);
+
+	for (size_t i = 0; i < aggsToCompute.size (); i++) {
+		Column myCol;
+		MyDB_AggType aggType = aggsToCompute[i].first;
+		StorageType outputType = getStorageType (outputAtts[numGroups + i].second);
+
+		// a sum or an average is kept as an int only if that is how it is going to be output (this is
+		// how the aggregates have always been computed); a count is always an int, a min or a max is
+		// kept the way that it is output, and distinct values are kept as whatever type they are
+		if (aggType == MyDB_AggType :: Cnt) {
+			myCol.type = IntStorage;
+		} else if (aggType == MyDB_AggType :: Sum || aggType == MyDB_AggType :: Avg) {
+			myCol.type = (outputType == IntStorage) ? IntStorage : DoubleStorage;
+		} else if (aggType == MyDB_AggType :: Min || aggType == MyDB_AggType :: Max) {
+			myCol.type = outputType;
+		} else {
+			myCol.type = getStorageType (inputRec->getType (aggsToCompute[i].second));
+		}
+		aggCols.push_back (myCol);
+		aggTypes.push_back (aggType);
+
+		if (aggType == MyDB_AggType :: CntDistinct)
+			bytesPerGroup += sizeof (unordered_set <string>);
+		else if (aggType == MyDB_AggType :: ApproxCntDistinct)
+			bytesPerGroup += HyperLogLog :: getBytes ();
+		else
+			bytesPerGroup += (myCol.type == StringStorage) ? sizeof (string) : sizeof (int64_t);
+	}
+	extraBytes = 0;
+
+	slots.resize (16);
+	mask = 15;
+
+	intVal = make_shared <MyDB_IntAttVal> ();
+	doubleVal = make_shared <MyDB_DoubleAttVal> ();
+	stringVal = make_shared <MyDB_StringAttVal> ();
+	boolVal = make_shared <MyDB_BoolAttVal> ();
+}
+
+GroupTable :: StorageType GroupTable :: getStorageType (MyDB_AttTypePtr forMe) {
+	string name = forMe->toString ();
+	if (name == "int")
+		return IntStorage;
+	else if (name == "double")
+		return DoubleStorage;
+	else if (name == "bool")
+		return BoolStorage;
+	else
+		return StringStorage;
+}
+
+bool GroupTable :: sameGroup (size_t whichGroup, vector <Column> &keys, size_t keyPos) {
+	for (size_t i = 0; i < groupCols.size (); i++) {
+		Column &myCol = groupCols[i];
+		Column &key = keys[i];
+		if (myCol.type == DoubleStorage) {
+			if (myCol.doubles[whichGroup] != key.doubles[keyPos])
+				return false;
+		} else if (myCol.type == StringStorage) {
+			if (myCol.strings[whichGroup] != key.strings[keyPos])
+				return false;
+		} else {
+			if (myCol.ints[whichGroup] != key.ints[keyPos])
+				return false;
+		}
+	}
+	return true;
+}
+
+void GroupTable :: grow () {
+
+	if (hashes.size () < slots.size () * MAX_LOAD)
+		return;
+
+	// re-build the slots from the hashes of the groups, which we already have
+	vector <uint32_t> (slots.size () * 2).swap (slots);
+	mask = slots.size () - 1;
+	for (size_t i = 0; i < hashes.size (); i++) {
+		size_t whichSlot = mix (hashes[i]) & mask;
+		while (slots[whichSlot] != 0)
+			whichSlot = (whichSlot + 1) & mask;
+		slots[whichSlot] = i + 1;
+	}
+}
+
+long GroupTable :: findGroup (size_t hashVal, vector <Column> &keys, size_t keyPos, bool canAddGroup) {
+
+	// with no grouping values, there is (at most) one group, and there is no need to look for it
+	if (groupCols.size () == 0 && hashes.size () > 0)
+		return 0;
+
+	size_t whichSlot = mix (hashVal) & mask;
+	while (true) {
+
+		// if we found an empty slot, the group is not there, so add it (if we are allowed to)
+		if (slots[whichSlot] == 0) {
+			if (!canAddGroup)
+				return -1;
+
+			size_t whichGroup = hashes.size ();
+			slots[whichSlot] = whichGroup + 1;
+			hashes.push_back (hashVal);
+			for (size_t i = 0; i < groupCols.size (); i++) {
+				Column &myCol = groupCols[i];
+				Column &key = keys[i];
+				if (myCol.type == DoubleStorage) {
+					myCol.doubles.push_back (key.doubles[keyPos]);
+				} else if (myCol.type == StringStorage) {
+					myCol.strings.push_back (key.strings[keyPos]);
+					extraBytes += key.strings[keyPos].size ();
+				} else {
+					myCol.ints.push_back (key.ints[keyPos]);
+				}
+			}
+			for (size_t i = 0; i < aggCols.size (); i++) {
+				Column &c = aggCols[i];
+				if (aggTypes[i] == MyDB_AggType :: CntDistinct) {
+					if (c.type == DoubleStorage)
+						c.doubleSets.emplace_back ();
+					else if (c.type == StringStorage)
+						c.stringSets.emplace_back ();
+					else
+						c.intSets.emplace_back ();
+				} else if (aggTypes[i] == MyDB_AggType :: ApproxCntDistinct) {
+					c.sketches.emplace_back ();
+				} else if (c.type == DoubleStorage) {
+					c.doubles.push_back (0);
+				} else if (c.type == StringStorage) {
+					c.strings.push_back ("");
+				} else {
+					c.ints.push_back (0);
+				}
+			}
+			counts.push_back (0);
+			grow ();
+			return whichGroup;
+		}
+
+		// only check the grouping values if the hash matches
+		size_t whichGroup = slots[whichSlot] - 1;
+		if (hashes[whichGroup] == hashVal && sameGroup (whichGroup, keys, keyPos))
+			return whichGroup;
+
+		whichSlot = (whichSlot + 1) & mask;
+	}
+}
+
+void GroupTable :: update (size_t whichAgg, size_t whichGroup, MyDB_AttValPtr val, bool isFirst) {
+
+	Column &c = aggCols[whichAgg];
+	MyDB_AggType aggType = aggTypes[whichAgg];
+
+	if (aggType == MyDB_AggType :: Sum || aggType == MyDB_AggType :: Avg) {
+		if (c.type == IntStorage)
+			c.ints[whichGroup] += val->toInt ();
+		else
+			c.doubles[whichGroup] += val->toDouble ();
+
+	} else if (aggType == MyDB_AggType :: Min || aggType == MyDB_AggType :: Max) {
+		bool isMin = (aggType == MyDB_AggType :: Min);
+		if (c.type == DoubleStorage) {
+			double newVal = val->toDouble ();
+			if (isFirst || (isMin ? newVal < c.doubles[whichGroup] : newVal > c.doubles[whichGroup]))
+				c.doubles[whichGroup] = newVal;
+		} else if (c.type == StringStorage) {
+			string newVal = val->toString ();
+			if (isFirst || (isMin ? newVal < c.strings[whichGroup] : newVal > c.strings[whichGroup]))
+				c.strings[whichGroup] = newVal;
+		} else {
+			int64_t newVal = (c.type == BoolStorage) ? val->toBool () : val->toInt ();
+			if (isFirst || (isMin ? newVal < c.ints[whichGroup] : newVal > c.ints[whichGroup]))
+				c.ints[whichGroup] = newVal;
+		}
+
+	} else if (aggType == MyDB_AggType :: CntDistinct) {
+		if (c.type == DoubleStorage) {
+			if (c.doubleSets[whichGroup].insert (val->toDouble ()).second)
+				extraBytes += DISTINCT_VALUE_BYTES;
+		} else if (c.type == StringStorage) {
+			string newVal = val->toString ();
+			if (c.stringSets[whichGroup].insert (newVal).second)
+				extraBytes += DISTINCT_VALUE_BYTES + newVal.size ();
+		} else {
+			int64_t newVal = (c.type == BoolStorage) ? val->toBool () : val->toInt ();
+			if (c.intSets[whichGroup].insert (newVal).second)
+				extraBytes += DISTINCT_VALUE_BYTES;
+		}
+
+	} else if (aggType == MyDB_AggType :: ApproxCntDistinct) {
+		if (c.type == DoubleStorage) {
+			c.sketches[whichGroup].add (hashDouble (val->toDouble ()));
+		} else if (c.type == StringStorage) {
+			string newVal = val->toString ();
+			c.sketches[whichGroup].add (hashBytes (newVal.data (), newVal.size ()));
+		} else {
+			c.sketches[whichGroup].add (hashInt ((c.type == BoolStorage) ? val->toBool () : val->toInt ()));
+		}
+	}
+}
+
+void GroupTable :: update (size_t whichAgg, size_t whichGroup, GroupTable &fromMe, size_t fromGroup, bool isFirst) {
+
+	Column &c = aggCols[whichAgg];
+	Column &from = fromMe.aggCols[whichAgg];
+	MyDB_AggType aggType = aggTypes[whichAgg];
+
+	if (aggType == MyDB_AggType :: Cnt || aggType == MyDB_AggType :: Sum || aggType == MyDB_AggType :: Avg) {
+		if (c.type == IntStorage)
+			c.ints[whichGroup] += from.ints[fromGroup];
+		else
+			c.doubles[whichGroup] += from.doubles[fromGroup];
+
+	} else if (aggType == MyDB_AggType :: Min || aggType == MyDB_AggType :: Max) {
+		bool isMin = (aggType == MyDB_AggType :: Min);
+		if (c.type == DoubleStorage) {
+			double newVal = from.doubles[fromGroup];
+			if (isFirst || (isMin ? newVal < c.doubles[whichGroup] : newVal > c.doubles[whichGroup]))
+				c.doubles[whichGroup] = newVal;
+		} else if (c.type == StringStorage) {
+			string &newVal = from.strings[fromGroup];
+			if (isFirst || (isMin ? newVal < c.strings[whichGroup] : newVal > c.strings[whichGroup]))
+				c.strings[whichGroup] = newVal;
+		} else {
+			int64_t newVal = from.ints[fromGroup];
+			if (isFirst || (isMin ? newVal < c.ints[whichGroup] : newVal > c.ints[whichGroup]))
+				c.ints[whichGroup] = newVal;
+		}
+
+	} else if (aggType == MyDB_AggType :: CntDistinct) {
+		if (c.type == DoubleStorage) {
+			for (double v : from.doubleSets[fromGroup]) {
+				if (c.doubleSets[whichGroup].insert (v).second)
+					extraBytes += DISTINCT_VALUE_BYTES;
+			}
+		} else if (c.type == StringStorage) {
+			for (const string &v : from.stringSets[fromGroup]) {
+				if (c.stringSets[whichGroup].insert (v).second)
+					extraBytes += DISTINCT_VALUE_BYTES + v.size ();
+			}
+		} else {
+			for (int64_t v : from.intSets[fromGroup]) {
+				if (c.intSets[whichGroup].insert (v).second)
+					extraBytes += DISTINCT_VALUE_BYTES;
+			}
+		}
+
+	} else if (aggType == MyDB_AggType :: ApproxCntDistinct) {
+		c.sketches[whichGroup].merge (from.sketches[fromGroup]);
+	}
+}
+
+bool GroupTable :: add (size_t hashVal, vector <func> &groupingComps, vector <func> &aggComps, bool canAddGroup) {
+
+	// get the grouping values for this record
+	for (size_t i = 0; i < keyCols.size (); i++) {
+		Column &key = keyCols[i];
+		MyDB_AttValPtr val = groupingComps[i] ();
+		if (key.type == IntStorage)
+			key.ints.assign (1, val->toInt ());
+		else if (key.type == BoolStorage)
+			key.ints.assign (1, val->toBool ());
+		else if (key.type == DoubleStorage)
+			key.doubles.assign (1, val->toDouble ());
+		else
+			key.strings.assign (1, val->toString ());
+	}
+
+	long whichGroup = findGroup (hashVal, keyCols, 0, canAddGroup);
+	if (whichGroup == -1)
+		return false;
+
+	// and update the aggregates
+	bool isFirst = (counts[whichGroup] == 0);
+	for (size_t i = 0; i < aggCols.size (); i++) {
+		if (aggTypes[i] == MyDB_AggType :: Cnt)
+			aggCols[i].ints[whichGroup]++;
+		else
+			update (i, whichGroup, aggComps[i] (), isFirst);
+	}
+	counts[whichGroup]++;
+	return true;
+}
+
+void GroupTable :: merge (GroupTable &fromMe) {
+
+	for (size_t i = 0; i < fromMe.size (); i++) {
+		size_t whichGroup = findGroup (fromMe.hashes[i], fromMe.groupCols, i, true);
+		bool isFirst = (counts[whichGroup] == 0);
+		for (size_t j = 0; j < aggCols.size (); j++)
+			update (j, whichGroup, fromMe, i, isFirst);
+		counts[whichGroup] += fromMe.counts[i];
+	}
+}
+
+void GroupTable :: getGroup (size_t whichGroup, MyDB_RecordPtr outRec) {
+
+	// set the grouping atts
+	int whichAtt = 0;
+	for (auto &c : groupCols) {
+		MyDB_AttValPtr att = outRec->getAtt (whichAtt++);
+		if (c.type == IntStorage) {
+			intVal->set ((int) c.ints[whichGroup]);
+			att->set (intVal);
+		} else if (c.type == BoolStorage) {
+			boolVal->set (c.ints[whichGroup] != 0);
+			att->set (boolVal);
+		} else if (c.type == DoubleStorage) {
+			doubleVal->set (c.doubles[whichGroup]);
+			att->set (doubleVal);
+		} else {
+			stringVal->set (c.strings[whichGroup]);
+			att->set (stringVal);
+		}
+	}
+
+	// and the aggregate atts... an average that is output as an int uses integer division
+	int64_t count = counts[whichGroup];
+	for (size_t i = 0; i < aggCols.size (); i++) {
+		MyDB_AttValPtr att = outRec->getAtt (whichAtt++);
+		Column &c = aggCols[i];
+		if (aggTypes[i] == MyDB_AggType :: CntDistinct) {
+			size_t numDistinct;
+			if (c.type == DoubleStorage)
+				numDistinct = c.doubleSets[whichGroup].size ();
+			else if (c.type == StringStorage)
+				numDistinct = c.stringSets[whichGroup].size ();
+			else
+				numDistinct = c.intSets[whichGroup].size ();
+			intVal->set ((int) numDistinct);
+			att->set (intVal);
+		} else if (aggTypes[i] == MyDB_AggType :: ApproxCntDistinct) {
+			intVal->set ((int) llround (c.sketches[whichGroup].estimate ()));
+			att->set (intVal);
+		} else if (c.type == IntStorage) {
+			int64_t val = c.ints[whichGroup];
+			if (aggTypes[i] == MyDB_AggType :: Avg)
+				val /= count;
+			intVal->set ((int) val);
+			att->set (intVal);
+		} else if (c.type == BoolStorage) {
+			boolVal->set (c.ints[whichGroup] != 0);
+			att->set (boolVal);
+		} else if (c.type == StringStorage) {
+			stringVal->set (c.strings[whichGroup]);
+			att->set (stringVal);
+		} else {
+			double val = c.doubles[whichGroup];
+			if (aggTypes[i] == MyDB_AggType :: Avg)
+				val /= count;
+			doubleVal->set (val);
+			att->set (doubleVal);
+		}
+	}
+	outRec->recordContentHasChanged ();
+}
+
+void GroupTable :: clear () {
+	for (auto &c : groupCols) {
+		vector <int64_t> ().swap (c.ints);
+		vector <double> ().swap (c.doubles);
+		vector <string> ().swap (c.strings);
+	}
+	for (auto &c : aggCols) {
+		vector <int64_t> ().swap (c.ints);
+		vector <double> ().swap (c.doubles);
+		vector <string> ().swap (c.strings);
+		vector <unordered_set <int64_t>> ().swap (c.intSets);
+		vector <unordered_set <double>> ().swap (c.doubleSets);
+		vector <unordered_set <string>> ().swap (c.stringSets);
+		vector <HyperLogLog> ().swap (c.sketches);
+	}
+	vector <int64_t> ().swap (counts);
+	vector <size_t> ().swap (hashes);
+	vector <uint32_t> (16).swap (slots);
+	mask = 15;
+	extraBytes = 0;
+}
+
+#endif
@@ -0,0 +1,322 @@
+
+#ifndef HYBRID_HASH_JOIN_C
+#define HYBRID_HASH_JOIN_C
+
+#include "KeyHash.h"
+#include "MyDB_Record.h"
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_TableReaderWriter.h"
+#include "HybridHashJoin.h"
+#include "RecordHashTable.h"
+#include "ScanJoin.h"
+#include "SortMergeJoin.h"
+#include <cstdint>
+
+using namespace std;
+
+// the number of times that we will re-partition a partition that is too big before giving up
+#define MAX_PARTITION_LEVELS 3
+
+HybridHashJoin :: HybridHashJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWriterPtr rightInputIn,
+                MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn,
+		vector <string> projectionsIn,
+                vector <pair <string, string>> equalityChecksIn, string leftSelectionPredicateIn,
+                string rightSelectionPredicateIn) : HybridHashJoin (leftInputIn, rightInputIn, outputIn,
+		finalSelectionPredicateIn, projectionsIn, equalityChecksIn, leftSelectionPredicateIn,
+		rightSelectionPredicateIn, 0, outputIn->getTable ()->getStorageLoc () + "_hhj") {}
+
+HybridHashJoin :: HybridHashJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWriterPtr rightInputIn,
+                MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn,
+		vector <string> projectionsIn,
+                vector <pair <string, string>> equalityChecksIn, string leftSelectionPredicateIn,
+                string rightSelectionPredicateIn, int levelIn, string namePrefixIn) {
+
+	output = outputIn;
+	finalSelectionPredicate = finalSelectionPredicateIn;
+	projections = projectionsIn;
+	level = levelIn;
+	namePrefix = namePrefixIn;
+	budget = leftInputIn->getBufferMgr ()->getNumPages () / 2;
+
+	// we need to make sure that the left table is smaller, since that is the one that we hash
+
+	// see which table is bigger
+	if (leftInputIn->getNumPages () < rightInputIn->getNumPages ()) {
+
+		// if the left is smaller, we are good
+		equalityChecks = equalityChecksIn;
+		leftTable = leftInputIn;
+		rightTable = rightInputIn;
+		leftSelectionPredicate = leftSelectionPredicateIn;
+		rightSelectionPredicate = rightSelectionPredicateIn;
+
+		hadToSwapThem = false;
+
+	} else {
+
+		// if the right is smaller, swap everything
+		for (auto &a : equalityChecksIn) {
+			equalityChecks.push_back (make_pair (a.second, a.first));
+		}
+		rightTable = leftInputIn;
+		leftTable = rightInputIn;
+		rightSelectionPredicate = leftSelectionPredicateIn;
+		leftSelectionPredicate = rightSelectionPredicateIn;
+
+		hadToSwapThem = true;
+	}
+
+	// figure out the number of partitions, so that each should be able to be hashed in RAM...
+	// each spilled partition needs a page in RAM that is being appended to, so we can't have
+	// more partitions than the budget allows
+	numPartitions = (int) (1.2 * leftTable->getNumPages () / budget) + 1;
+	if (numPartitions > budget / 2)
+		numPartitions = budget / 2;
+	if (numPartitions < 2)
+		numPartitions = 2;
+}
+
+int HybridHashJoin :: getPartition (size_t hashVal) {
+
+	// re-mix the hash, so that each level of partitioning splits up the data differently than
+	// the last one did, and differently than the hash table used by the ScanJoin
+	uint64_t x = ((uint64_t) hashVal) + (level + 1) * 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x = x ^ (x >> 31);
+	return (int) (x % numPartitions);
+}
+
+void HybridHashJoin :: run () {
+
+	// if the smaller table can be hashed in RAM, or if we have nothing to hash on, just do a scan join
+	if (leftTable->getNumPages () <= budget || equalityChecks.size () == 0) {
+		ScanJoin myOp (leftTable, rightTable, output, finalSelectionPredicate, projections,
+			equalityChecks, leftSelectionPredicate, rightSelectionPredicate);
+		myOp.run ();
+		return;
+	}
+
+	partitionAndJoin ();
+}
+
+void HybridHashJoin :: partitionAndJoin () {
+
+	MyDB_BufferManagerPtr myMgr = leftTable->getBufferMgr ();
+
+	// create the temporary tables for all of the partitions
+	vector <MyDB_TableReaderWriterPtr> leftParts;
+	vector <MyDB_TableReaderWriterPtr> rightParts;
+	vector <long> leftCounts (numPartitions, 0);
+	vector <long> rightCounts (numPartitions, 0);
+	for (int i = 0; i < numPartitions; i++) {
+		string leftName = namePrefix + "_L" + to_string (i);
+		string rightName = namePrefix + "_R" + to_string (i);
+		leftParts.push_back (make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (leftName,
+			leftName, leftTable->getTable ()->getSchema ()), myMgr));
+		rightParts.push_back (make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (rightName,
+			rightName, rightTable->getTable ()->getSchema ()), myMgr));
+	}
+
+	// partitions 0 up to numInRAM - 1 are kept in RAM, each in its own pinned pages, for as long as
+	// their pages fit; every spilled partition needs a page in RAM that is being appended to, so
+	// that is taken out of the budget
+	size_t maxPagesInRAM = (budget > numPartitions) ? budget - numPartitions : 0;
+	int numInRAM = (maxPagesInRAM > 0) ? numPartitions : 0;
+	size_t numPagesInRAM = 0;
+	vector <vector <MyDB_PageReaderWriter>> pagesInRAM (numPartitions);
+
+	// these are the hash tables we'll use to look up data in the in-RAM partitions, one for each
+	// partition, so that a partition can be spilled without touching the others... the key is the
+	// hashed value of all of the records' join keys, and it gives us a list of pointers were all
+	// of the records with that hsah value are located
+	vector <RecordHashTable> myHashes (numPartitions);
+
+	// get the left input record, and the various functions whose output we'll hash
+	MyDB_RecordPtr leftInputRec = leftTable->getEmptyRecord ();
+	vector <string> leftKeys;
+	for (auto &p : equalityChecks) {
+		leftKeys.push_back (p.first);
+	}
+	function <size_t ()> leftHash = buildKeyHasher (leftInputRec, leftKeys);
+	func leftPred = leftInputRec->compileComputation (leftSelectionPredicate);
+	MyDB_RecordPtr spillRec = leftTable->getEmptyRecord ();
+
+	// partition the left table
+	MyDB_RecordIteratorAltPtr myIter = leftTable->getIteratorAlt ();
+	while (myIter->advance ()) {
+
+		myIter->getCurrent (leftInputRec);
+
+		// see if it is accepted by the preicate
+		if (!leftPred ()->toBool ()) {
+			continue;
+		}
+
+		// compute its hash
+		size_t hashVal = leftHash ();
+
+		int whichPart = getPartition (hashVal);
+		leftCounts[whichPart]++;
+
+		// put it into RAM, if its partition is there
+		void *loc = nullptr;
+		if (whichPart < numInRAM && pagesInRAM[whichPart].size () > 0)
+			loc = pagesInRAM[whichPart].back ().appendAndReturnLocation (leftInputRec);
+
+		// if its partition needs another page and there is no room for one, spill the partitions
+		// from the last one down, until there is room or its partition has been spilled
+		while (loc == nullptr && whichPart < numInRAM && numPagesInRAM >= maxPagesInRAM) {
+			int spillMe = --numInRAM;
+			MyDB_RecordIteratorAltPtr spillIter = getIteratorAlt (pagesInRAM[spillMe]);
+			while (spillIter->advance ()) {
+				spillIter->getCurrent (spillRec);
+				leftParts[spillMe]->append (spillRec);
+			}
+			numPagesInRAM -= pagesInRAM[spillMe].size ();
+			myHashes[spillMe].clear ();
+			pagesInRAM[spillMe].clear ();
+		}
+
+		if (loc == nullptr && whichPart < numInRAM) {
+			pagesInRAM[whichPart].push_back (MyDB_PageReaderWriter (true, *myMgr));
+			numPagesInRAM++;
+			loc = pagesInRAM[whichPart].back ().appendAndReturnLocation (leftInputRec);
+		}
+
+		if (loc != nullptr) {
+			myHashes[whichPart].insert (hashVal, loc);
+			continue;
+		}
+
+		// if we got here, its partition was spilled, so write it out
+		leftParts[whichPart]->append (leftInputRec);
+	}
+
+	// now get the right input record, and the various functions over it
+	MyDB_RecordPtr rightInputRec = rightTable->getEmptyRecord ();
+	vector <string> rightKeys;
+	for (auto &p : equalityChecks) {
+		rightKeys.push_back (p.second);
+	}
+	function <size_t ()> rightHash = buildKeyHasher (rightInputRec, rightKeys);
+	func rightPred = rightInputRec->compileComputation (rightSelectionPredicate);
+
+	// and get the schema that results from combining the left and right records
+	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
+	for (auto &p : leftTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+	for (auto &p : rightTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+
+	// get the combined record
+	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (mySchemaOut);
+	combinedRec->buildFrom (leftInputRec, rightInputRec);
+
+	// now, get the final predicate over it
+	func finalPredicate = combinedRec->compileComputation (finalSelectionPredicate);
+
+	// and get the final set of computatoins that will be used to buld the output record
+	vector <func> finalComputations;
+	for (string s : projections) {
+		finalComputations.push_back (combinedRec->compileComputation (s));
+	}
+
+	// this is the output record
+	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+
+	// partition the right table, joining the in-RAM partitions along the way
+	MyDB_RecordIteratorAltPtr myIterAgain = rightTable->getIteratorAlt ();
+	while (myIterAgain->advance ()) {
+
+		myIterAgain->getCurrent (rightInputRec);
+
+		// see if it is accepted by the preicate
+		if (!rightPred ()->toBool ()) {
+			continue;
+		}
+
+		// hash the current record
+		size_t hashVal = rightHash ();
+
+		int whichPart = getPartition (hashVal);
+
+		// if its partition was spilled, write it out
+		if (whichPart >= numInRAM) {
+
+			// there is no point writing it out if nothing on the left can match
+			if (leftCounts[whichPart] > 0) {
+				rightParts[whichPart]->append (rightInputRec);
+				rightCounts[whichPart]++;
+			}
+			continue;
+		}
+
+		// otherwise, join it with its in-RAM partition, iterating though the potential matches
+		RecordHashTable &myHash = myHashes[whichPart];
+		for (long e = myHash.find (hashVal); e != -1; e = myHash.getNext (e)) {
+
+			// build the combined record
+			leftInputRec->fromBinary (myHash.getRecord (e));
+
+			// check to see if it is accepted by the join predicate
+			if (finalPredicate ()->toBool ()) {
+
+				// run all of the computations
+				int i = 0;
+				for (auto &f : finalComputations) {
+					outputRec->getAtt (i++)->set (f());
+				}
+
+				// the record's content has changed because it
+				// is now a composite of two records whose content
+				// has changed via a read... we have to tell it this,
+				// or else the record's internal buffer may cause it
+				// to write old values
+				outputRec->recordContentHasChanged ();
+				output->append (outputRec);
+			}
+		}
+	}
+
+	// we are done with the in-RAM partitions, so let their RAM go
+	myHashes.clear ();
+	pagesInRAM.clear ();
+
+	// now join all of the spilled partitions
+	for (int i = 0; i < numPartitions; i++) {
+		if (i >= numInRAM && leftCounts[i] > 0 && rightCounts[i] > 0) {
+			joinPartitions (leftParts[i], rightParts[i], i);
+		}
+		myMgr->killTable (leftParts[i]->getTable ());
+		myMgr->killTable (rightParts[i]->getTable ());
+	}
+}
+
+void HybridHashJoin :: joinPartitions (MyDB_TableReaderWriterPtr leftPart, MyDB_TableReaderWriterPtr rightPart,
+	int whichPart) {
+
+	// note that the selection predicates were already run as the partitions were created
+
+	// if one side fits in RAM, we can use a regular scan join
+	if (leftPart->getNumPages () <= budget || rightPart->getNumPages () <= budget) {
+		ScanJoin myOp (leftPart, rightPart, output, finalSelectionPredicate, projections,
+			equalityChecks, "bool[true]", "bool[true]");
+		myOp.run ();
+
+	// if not, partition again
+	} else if (level + 1 < MAX_PARTITION_LEVELS) {
+		HybridHashJoin myOp (leftPart, rightPart, output, finalSelectionPredicate, projections,
+			equalityChecks, "bool[true]", "bool[true]", level + 1, namePrefix + "_" + to_string (whichPart));
+		myOp.run ();
+
+	// we have partitioned over and over and the partition is still too big, so there must be
+	// a lot of records with the same key... give up on hashing
+	} else {
+		SortMergeJoin myOp (leftPart, rightPart, output, finalSelectionPredicate, projections,
+			equalityChecks, "bool[true]", "bool[true]");
+		myOp.run ();
+	}
+}
+
+#endif
@@ -0,0 +1,60 @@
+
+#ifndef HYPER_LOG_LOG_C
+#define HYPER_LOG_LOG_C
+
+#include "HyperLogLog.h"
+#include <cmath>
+
+using namespace std;
+
+HyperLogLog :: HyperLogLog () {
+	registers.resize (1 << HLL_BITS);
+}
+
+void HyperLogLog :: add (size_t hashVal) {
+
+	// scramble the hash, since the sketch needs all of the bits to look random (and, for example, the
+	// hash of a small int may not have many bits set)
+	uint64_t x = hashVal;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x = x ^ (x >> 31);
+
+	// the high bits pick the register, and we count the leading zeros in the rest; the low bit is
+	// set so that the count stops even if all of the rest are zero
+	size_t whichRegister = x >> (64 - HLL_BITS);
+	uint64_t rest = (x << HLL_BITS) | 1;
+	uint8_t rank = __builtin_clzll (rest) + 1;
+	if (rank > registers[whichRegister])
+		registers[whichRegister] = rank;
+}
+
+void HyperLogLog :: merge (HyperLogLog &fromMe) {
+	for (size_t i = 0; i < registers.size (); i++) {
+		if (fromMe.registers[i] > registers[i])
+			registers[i] = fromMe.registers[i];
+	}
+}
+
+double HyperLogLog :: estimate () {
+
+	double m = registers.size ();
+	double sum = 0;
+	int numZeros = 0;
+	for (uint8_t r : registers) {
+		sum += ldexp (1.0, -r);
+		if (r == 0)
+			numZeros++;
+	}
+
+	double alpha = 0.7213 / (1 + 1.079 / m);
+	double result = alpha * m * m / sum;
+
+	// for small counts, a lot of the registers are still empty, and counting them is more accurate
+	if (result <= 2.5 * m && numZeros > 0)
+		result = m * log (m / numZeros);
+
+	return result;
+}
+
+#endif
@@ -0,0 +1,186 @@
+
+#ifndef INDEX_NESTED_LOOP_JOIN_C
+#define INDEX_NESTED_LOOP_JOIN_C
+
+#include "IndexNestedLoopJoin.h"
+#include "MyDB_Record.h"
+#include "RecordComparator.h"
+#include "Sorting.h"
+#include <algorithm>
+
+using namespace std;
+
+IndexNestedLoopJoin :: IndexNestedLoopJoin (MyDB_TableReaderWriterPtr outerInputIn, MyDB_BPlusTreeReaderWriterPtr innerInputIn,
+		MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn,
+		vector <string> projectionsIn, string outerKeyIn, string outerSelectionPredicateIn,
+		string innerSelectionPredicateIn) {
+
+	output = outputIn;
+	finalSelectionPredicate = finalSelectionPredicateIn;
+	projections = projectionsIn;
+	outerKey = outerKeyIn;
+	outerTable = outerInputIn;
+	innerTable = innerInputIn;
+	outerSelectionPredicate = outerSelectionPredicateIn;
+	innerSelectionPredicate = innerSelectionPredicateIn;
+	runSize = outerTable->getBufferMgr ()->getNumPages () / 2;
+}
+
+// adds the serialized version of the record to the end of the bytes
+static void appendRecord (vector <char> &bytes, MyDB_RecordPtr rec) {
+	size_t oldSize = bytes.size ();
+	bytes.resize (oldSize + rec->getBinarySize ());
+	rec->toBinary (bytes.data () + oldSize);
+}
+
+void IndexNestedLoopJoin :: run () {
+
+	// get the outer records... the sorted iterator gets its own pair, since it loads records into the
+	// records that its comparator is built over every time that it advances
+	MyDB_RecordPtr outerRec = outerTable->getEmptyRecord ();
+	MyDB_RecordPtr outerRecOther = outerTable->getEmptyRecord ();
+	MyDB_RecordPtr outerSortRec = outerTable->getEmptyRecord ();
+	MyDB_RecordPtr outerSortRecOther = outerTable->getEmptyRecord ();
+	function <bool ()> outerSortComp = buildRecordComparator (outerSortRec, outerSortRecOther, outerKey);
+
+	// these are used to see if two outer records have the same key
+	function <bool ()> outerComp = buildRecordComparator (outerRec, outerRecOther, outerKey);
+	function <bool ()> outerCompRev = buildRecordComparator (outerRecOther, outerRec, outerKey);
+	func outerKeyVal = outerRec->compileComputation (outerKey);
+
+	// get the inner records; probeRec holds the key that we are looking up
+	string orderingAtt = innerTable->getOrderingAttName ();
+	string innerKey = "[" + orderingAtt + "]";
+	MyDB_RecordPtr innerRec = innerTable->getEmptyRecord ();
+	MyDB_RecordPtr innerRecOther = innerTable->getEmptyRecord ();
+	MyDB_RecordPtr probeRec = innerTable->getEmptyRecord ();
+	MyDB_AttValPtr probeKey = probeRec->getAtt (probeRec->getSchema ()->getAttByName (orderingAtt).first);
+	func innerPred = innerRec->compileComputation (innerSelectionPredicate);
+
+	// this is used to sort the records on a leaf page, and these to binary search them for the key
+	function <bool ()> innerComp = buildRecordComparator (innerRec, innerRecOther, innerKey);
+	function <bool ()> innerSmaller = buildRecordComparator (innerRec, probeRec, innerKey);
+	function <bool ()> probeSmaller = buildRecordComparator (probeRec, innerRec, innerKey);
+
+	// get the schema that results from combining the outer and inner records
+	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
+	for (auto &p : outerTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+	for (auto &p : innerTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+
+	// get the combined record, and the final predicate and computations over it
+	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (mySchemaOut);
+	combinedRec->buildFrom (outerRec, innerRec);
+	func finalPredicate = combinedRec->compileComputation (finalSelectionPredicate);
+	vector <func> finalComputations;
+	for (string s : projections) {
+		finalComputations.push_back (combinedRec->compileComputation (s));
+	}
+	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+
+	// sort the outer table on the key
+	MyDB_RecordIteratorAltPtr outerIter = buildItertorOverSortedRuns (runSize, *outerTable, outerSortComp,
+		outerSortRec, outerSortRecOther, outerSelectionPredicate, true, outerKey);
+
+	// the leaf pages from the last lookup, and the ones for this lookup
+	vector <LeafPage> lastLeaves;
+	vector <LeafPage> theseLeaves;
+	vector <int> leafPageNums;
+
+	// all of the outer records that have the current key, serialized back-to-back
+	vector <char> group;
+
+	bool more = outerIter->advance ();
+	while (more) {
+
+		// get the next key
+		outerIter->getCurrent (outerRec);
+		probeKey->set (outerKeyVal ());
+		probeRec->recordContentHasChanged ();
+
+		// and all of the outer records that have that key
+		group.clear ();
+		appendRecord (group, outerRec);
+		while ((more = outerIter->advance ())) {
+			outerIter->getCurrent (outerRecOther);
+			if (outerComp () || outerCompRev ())
+				break;
+			appendRecord (group, outerRecOther);
+		}
+
+		// find all of the leaf pages that might have the key
+		leafPageNums.clear ();
+		innerTable->discoverLeafPages (probeKey, probeKey, leafPageNums);
+
+		theseLeaves.clear ();
+		for (int pageNum : leafPageNums) {
+
+			// see if we used the page in the last lookup
+			auto cached = find_if (lastLeaves.begin (), lastLeaves.end (),
+				[pageNum] (LeafPage &l) {return l.pageNum == pageNum;});
+
+			if (cached != lastLeaves.end ()) {
+				theseLeaves.push_back (*cached);
+
+			// if not, pin it and sort the records on it
+			} else {
+				LeafPage newLeaf {pageNum, innerTable->getPinned (pageNum), {}};
+				auto bytes = newLeaf.page.getRecordBytes ();
+				void *pos = bytes.first;
+				while (pos != bytes.second) {
+					newLeaf.sortedRecs.push_back (pos);
+					pos = innerRec->fromBinary (pos);
+				}
+				RecordComparator myComparator (innerComp, innerRec, innerRecOther);
+				std::stable_sort (newLeaf.sortedRecs.begin (), newLeaf.sortedRecs.end (), myComparator);
+				theseLeaves.push_back (newLeaf);
+			}
+
+			// binary search for the first record that does not have a smaller key
+			vector <void *> &recs = theseLeaves.back ().sortedRecs;
+			size_t low = 0, high = recs.size ();
+			while (low < high) {
+				size_t mid = (low + high) / 2;
+				innerRec->fromBinary (recs[mid]);
+				if (innerSmaller ())
+					low = mid + 1;
+				else
+					high = mid;
+			}
+
+			// and join all of the records with the key
+			for (size_t i = low; i < recs.size (); i++) {
+
+				innerRec->fromBinary (recs[i]);
+				if (probeSmaller ())
+					break;
+
+				if (!innerPred ()->toBool ())
+					continue;
+
+				char *groupPos = group.data ();
+				char *groupEnd = groupPos + group.size ();
+				while (groupPos != groupEnd) {
+					groupPos = (char *) outerRec->fromBinary (groupPos);
+					if (finalPredicate ()->toBool ()) {
+						int j = 0;
+						for (auto &f : finalComputations) {
+							outputRec->getAtt (j++)->set (f ());
+						}
+						outputRec->recordContentHasChanged ();
+						output->append (outputRec);
+					}
+				}
+			}
+
+			// the next key is larger, so only the last few pages can be used by the next lookup
+			if (theseLeaves.size () > MAX_CACHED_LEAVES)
+				theseLeaves.erase (theseLeaves.begin ());
+		}
+
+		lastLeaves.swap (theseLeaves);
+	}
+}
+
+#endif
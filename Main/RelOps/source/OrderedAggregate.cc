@@ -0,0 +1,132 @@
+
+#ifndef ORDERED_AGG_C
+#define ORDERED_AGG_C
+
+#include "GroupTable.h"
+#include "KeyHash.h"
+#include "MyDB_Record.h"
+#include "MyDB_TableReaderWriter.h"
+#include "OrderedAggregate.h"
+
+using namespace std;
+
+OrderedAggregate :: OrderedAggregate (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                vector <pair <MyDB_AggType, string>> aggsToComputeIn,
+                vector <string> groupingsIn, string selectionPredicateIn, string orderingKeyIn) {
+
+	input = inputIn;
+	inputTree = nullptr;
+	output = outputIn;
+	aggsToCompute = aggsToComputeIn;
+	groupings = groupingsIn;
+	selectionPredicate = selectionPredicateIn;
+	orderingKey = orderingKeyIn;
+}
+
+OrderedAggregate :: OrderedAggregate (MyDB_BPlusTreeReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                vector <pair <MyDB_AggType, string>> aggsToComputeIn,
+                vector <string> groupingsIn, string selectionPredicateIn) {
+
+	input = inputIn;
+	inputTree = inputIn;
+	output = outputIn;
+	aggsToCompute = aggsToComputeIn;
+	groupings = groupingsIn;
+	selectionPredicate = selectionPredicateIn;
+	orderingKey = "[" + inputIn->getOrderingAttName () + "]";
+}
+
+void OrderedAggregate :: run () {
+
+	// make sure that the number of attributes is OK
+	if (output->getTable ()->getSchema ()->getAtts ().size () != aggsToCompute.size () + groupings.size ()) {
+		cout << "error, the output schema needs to have the same number of atts as (# of aggs to compute + # groups).\n";
+		return;
+	}
+
+	// get an input rec, and one that holds the first record of the current run
+	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
+	MyDB_RecordPtr runRec = input->getEmptyRecord ();
+
+	// the groups for the current run are kept in native arrays, using the types of the output atts
+	GroupTable myTable (output->getTable ()->getSchema (), aggsToCompute, inputRec);
+
+	// these are used to see if a record has the same ordering key as the run
+	function <bool ()> beforeRun = buildRecordComparator (inputRec, runRec, orderingKey);
+	function <bool ()> afterRun = buildRecordComparator (runRec, inputRec, orderingKey);
+
+	// this will compute each of the groupings
+	vector <func> groupingComps;
+	for (auto &s : groupings) {
+		groupingComps.push_back (inputRec->compileComputation (s));
+	}
+
+	// and this will hash them
+	function <size_t ()> groupingHash = buildKeyHasher (inputRec, groupings);
+
+	// this will compute the value to aggregate for each of the aggregates (a count does not need one)
+	vector <func> aggComps;
+	for (auto &s : aggsToCompute) {
+		if (s.first == MyDB_AggType :: Cnt) {
+			aggComps.push_back (nullptr);
+		} else {
+			aggComps.push_back (inputRec->compileComputation (s.second));
+		}
+	}
+
+	// a B+-Tree is read in sorted order (and it runs the selection predicate itself); anything else is
+	// read in the order that it is stored
+	MyDB_RecordIteratorAltPtr myIter;
+	func inputPred;
+	if (inputTree != nullptr) {
+		myIter = inputTree->getSortedIteratorAlt (selectionPredicate);
+		inputPred = inputRec->compileComputation ("bool[true]");
+	} else {
+		myIter = input->getIteratorAlt ();
+		inputPred = inputRec->compileComputation (selectionPredicate);
+	}
+
+	// the first record in the current run, serialized
+	vector <char> runStart;
+	bool inRun = false;
+
+	MyDB_RecordPtr outRec = output->getEmptyRecord ();
+	while (myIter->advance ()) {
+
+		myIter->getCurrent (inputRec);
+
+		// see if it is accepted by the preicate
+		if (!inputPred ()->toBool ()) {
+			continue;
+		}
+
+		// if the ordering key changed, the groups for the run are done, so write them out
+		if (inRun && (beforeRun () || afterRun ())) {
+			for (size_t j = 0; j < myTable.size (); j++) {
+				myTable.getGroup (j, outRec);
+				output->append (outRec);
+			}
+			myTable.clear ();
+			inRun = false;
+		}
+
+		// remember the first record in the run, so that we can check the ordering key against it
+		if (!inRun) {
+			runStart.resize (inputRec->getBinarySize ());
+			inputRec->toBinary (runStart.data ());
+			runRec->fromBinary (runStart.data ());
+			inRun = true;
+		}
+
+		// and add the record to its group
+		myTable.add (groupingHash (), groupingComps, aggComps);
+	}
+
+	// write out the groups for the last run
+	for (size_t j = 0; j < myTable.size (); j++) {
+		myTable.getGroup (j, outRec);
+		output->append (outRec);
+	}
+}
+
+#endif
@@ -0,0 +1,148 @@
+
+#ifndef PARALLEL_AGG_C
+#define PARALLEL_AGG_C
+
+#include "KeyHash.h"
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_Record.h"
+#include "MyDB_TableReaderWriter.h"
+#include "ParallelAggregate.h"
+#include "TaskScheduler.h"
+#include <cstdint>
+
+using namespace std;
+
+// each thread has this many partitions' worth of merging to do (on average), so that the work
+// is spread out evenly, even if some partitions have more groups than others
+#define PARTITIONS_PER_THREAD 4
+
+ParallelAggregate :: ParallelAggregate (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                vector <pair <MyDB_AggType, string>> aggsToComputeIn,
+                vector <string> groupingsIn, string selectionPredicateIn) : ParallelAggregate (inputIn, outputIn,
+		aggsToComputeIn, groupingsIn, selectionPredicateIn, TaskScheduler :: getMaxThreads ()) {}
+
+ParallelAggregate :: ParallelAggregate (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                vector <pair <MyDB_AggType, string>> aggsToComputeIn,
+                vector <string> groupingsIn, string selectionPredicateIn, int numThreadsIn) {
+
+	input = inputIn;
+	output = outputIn;
+	aggsToCompute = aggsToComputeIn;
+	groupings = groupingsIn;
+	selectionPredicate = selectionPredicateIn;
+	numThreads = numThreadsIn;
+	if (numThreads < 1)
+		numThreads = 1;
+
+	// with no GROUP BY, there is only one group, so there is nothing to partition
+	numPartitions = (groupings.size () == 0) ? 1 : numThreads * PARTITIONS_PER_THREAD;
+}
+
+int ParallelAggregate :: getPartition (size_t hashVal) {
+
+	// re-mix the hash, so that the partitions are picked differently than the GroupTable's slots are
+	uint64_t x = ((uint64_t) hashVal) + 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x = x ^ (x >> 31);
+	return (int) (x % numPartitions);
+}
+
+void ParallelAggregate :: run () {
+
+	// make sure that the number of attributes is OK
+	if (output->getTable ()->getSchema ()->getAtts ().size () != aggsToCompute.size () + groupings.size ()) {
+		cout << "error, the output schema needs to have the same number of atts as (# of aggs to compute + # groups).\n";
+		return;
+	}
+
+	// with one thread, just do a regular aggregation
+	if (numThreads == 1) {
+		Aggregate myOp (input, output, aggsToCompute, groupings, selectionPredicate);
+		myOp.run ();
+		return;
+	}
+
+	// set up everything that each of the threads needs
+	threads.resize (numThreads);
+	for (auto &t : threads) {
+
+		t.inputRec = input->getEmptyRecord ();
+		t.inputPred = t.inputRec->compileComputation (selectionPredicate);
+		t.groupingHash = buildKeyHasher (t.inputRec, groupings);
+		for (auto &s : groupings) {
+			t.groupingComps.push_back (t.inputRec->compileComputation (s));
+		}
+
+		// a count does not need a computation
+		for (auto &s : aggsToCompute) {
+			if (s.first == MyDB_AggType :: Cnt) {
+				t.aggComps.push_back (nullptr);
+			} else {
+				t.aggComps.push_back (t.inputRec->compileComputation (s.second));
+			}
+		}
+
+		for (int j = 0; j < numPartitions; j++) {
+			t.partials.push_back (GroupTable (output->getTable ()->getSchema (), aggsToCompute, t.inputRec));
+		}
+	}
+
+	// phase one: go through the input a chunk at a time, and have the threads pre-aggregate each chunk
+	int chunkSize = input->getBufferMgr ()->getNumPages () / 2;
+	if (chunkSize < 1)
+		chunkSize = 1;
+
+	for (int first = 0; first < input->getNumPages (); first += chunkSize) {
+
+		// pin the chunk
+		vector <MyDB_PageReaderWriter> chunk;
+		vector <pair <void *, void *>> pages;
+		for (int j = first; j < first + chunkSize && j < input->getNumPages (); j++) {
+			MyDB_PageReaderWriter temp = input->getPinned (j);
+			if (temp.getType () == MyDB_PageType :: RegularPage) {
+				chunk.push_back (temp);
+				pages.push_back (temp.getRecordBytes ());
+			}
+		}
+
+		// and have the threads take the pages, adding the records on them to their own tables
+		TaskScheduler :: run (pages.size (), numThreads, [&] (int me, size_t which) {
+
+			ThreadState &myState = threads[me];
+			void *pos = pages[which].first;
+			while (pos != pages[which].second) {
+				pos = myState.inputRec->fromBinary (pos);
+				if (!myState.inputPred ()->toBool ())
+					continue;
+
+				size_t hashVal = myState.groupingHash ();
+				myState.partials[getPartition (hashVal)].add (hashVal, myState.groupingComps,
+					myState.aggComps);
+			}
+		});
+	}
+
+	// phase two: have the threads take partitions, merging every thread's partial aggregates for a
+	// partition into the first thread's table
+	TaskScheduler :: run (numPartitions, numThreads, [&] (int, size_t whichPart) {
+		GroupTable &merged = threads[0].partials[whichPart];
+		for (int j = 1; j < numThreads; j++) {
+			merged.merge (threads[j].partials[whichPart]);
+			threads[j].partials[whichPart].clear ();
+		}
+	});
+
+	// now we can output the aggregates
+	MyDB_RecordPtr outRec = output->getEmptyRecord ();
+	for (auto &merged : threads[0].partials) {
+		for (size_t j = 0; j < merged.size (); j++) {
+			merged.getGroup (j, outRec);
+			output->append (outRec);
+		}
+	}
+
+	threads.clear ();
+}
+
+#endif
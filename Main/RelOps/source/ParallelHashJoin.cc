@@ -0,0 +1,355 @@
+
+#ifndef PARALLEL_HASH_JOIN_C
+#define PARALLEL_HASH_JOIN_C
+
+#include "KeyHash.h"
+#include "MyDB_Record.h"
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_TableReaderWriter.h"
+#include "ParallelHashJoin.h"
+#include "ScanJoin.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+
+// we try to have no more than this many records in a partition, so its hash table fits in cache
+#define RECS_PER_PARTITION 8192
+
+// and we never have more than 2^this many partitions
+#define MAX_PARTITION_BITS 12
+
+// we look at (about) this many of the hashes to find the heavy hitters
+#define HEAVY_HITTER_SAMPLE_SIZE 4096
+
+// a key is a heavy hitter if it has at least 1 / (HEAVY_HITTER_SHARE * numThreads) of the sampled records,
+// since then its partition would have a good part of some thread's share of the work
+#define HEAVY_HITTER_SHARE 4
+
+ParallelHashJoin :: ParallelHashJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWriterPtr rightInputIn,
+                MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn,
+		vector <string> projectionsIn,
+                vector <pair <string, string>> equalityChecksIn, string leftSelectionPredicateIn,
+                string rightSelectionPredicateIn) : ParallelHashJoin (leftInputIn, rightInputIn, outputIn,
+		finalSelectionPredicateIn, projectionsIn, equalityChecksIn, leftSelectionPredicateIn,
+		rightSelectionPredicateIn, TaskScheduler :: getMaxThreads ()) {}
+
+ParallelHashJoin :: ParallelHashJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWriterPtr rightInputIn,
+                MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn,
+		vector <string> projectionsIn,
+                vector <pair <string, string>> equalityChecksIn, string leftSelectionPredicateIn,
+                string rightSelectionPredicateIn, int numThreadsIn) {
+
+	output = outputIn;
+	finalSelectionPredicate = finalSelectionPredicateIn;
+	projections = projectionsIn;
+	numThreads = numThreadsIn;
+	if (numThreads < 1)
+		numThreads = 1;
+	numPartitionBits = 0;
+
+	// we need to make sure that the left table is smaller
+
+	// see which table is bigger
+	if (leftInputIn->getNumPages () < rightInputIn->getNumPages ()) {
+
+		// if the left is smaller, we are good
+		equalityChecks = equalityChecksIn;
+		leftTable = leftInputIn;
+		rightTable = rightInputIn;
+		leftSelectionPredicate = leftSelectionPredicateIn;
+		rightSelectionPredicate = rightSelectionPredicateIn;
+
+	} else {
+
+		// if the right is smaller, swap everything
+		for (auto &a : equalityChecksIn) {
+			equalityChecks.push_back (make_pair (a.second, a.first));
+		}
+		rightTable = leftInputIn;
+		leftTable = rightInputIn;
+		rightSelectionPredicate = leftSelectionPredicateIn;
+		leftSelectionPredicate = rightSelectionPredicateIn;
+	}
+}
+
+void ParallelHashJoin :: partitionPages (vector <pair <void *, void *>> &pages, bool isLeft) {
+
+	// first, the threads take pages, and hash all of the records on them that pass the predicate
+	for (auto &t : threads)
+		t.found.clear ();
+
+	TaskScheduler :: run (pages.size (), numThreads, [&] (int me, size_t which) {
+
+		ThreadState &myState = threads[me];
+		MyDB_RecordPtr rec = isLeft ? myState.leftRec : myState.rightRec;
+		func &pred = isLeft ? myState.leftPred : myState.rightPred;
+		function <size_t ()> &hash = isLeft ? myState.leftHash : myState.rightHash;
+
+		void *pos = pages[which].first;
+		while (pos != pages[which].second) {
+			void *nextPos = rec->fromBinary (pos);
+			if (pred ()->toBool ())
+				myState.found.push_back (make_pair (hash (), pos));
+			pos = nextPos;
+		}
+	});
+
+	// the heavy hitters on the left are found once, and the ones on the right are added for each chunk
+	if (isLeft)
+		heavyHitters.clear ();
+	findHeavyHitters ();
+
+	// once we know how many records there are on the left, figure out the number of partitions
+	if (isLeft) {
+		size_t numRecs = 0;
+		for (auto &t : threads)
+			numRecs += t.found.size ();
+
+		numPartitionBits = 0;
+		while (numPartitionBits < MAX_PARTITION_BITS && ((1 << numPartitionBits) < numThreads ||
+			(numRecs >> numPartitionBits) > RECS_PER_PARTITION))
+			numPartitionBits++;
+	}
+
+	// now, split up the records that each thread found, using the high bits of the hash
+	int numPartitions = 1 << numPartitionBits;
+	TaskScheduler :: run (numThreads, numThreads, [&] (int, size_t whichState) {
+
+		ThreadState &myState = threads[whichState];
+		myState.partitioned.resize (numPartitions);
+		for (auto &p : myState.partitioned)
+			p.clear ();
+
+		// all of the records on the left have to go into the hash tables, but the ones on the right with
+		// heavy-hitter keys are kept to one side
+		myState.heavy.clear ();
+		bool checkHeavy = !isLeft && heavyHitters.size () > 0;
+		for (auto &f : myState.found) {
+			if (checkHeavy && heavyHitters.count (f.first) > 0) {
+				myState.heavy.push_back (f);
+				continue;
+			}
+			myState.partitioned[getPartition (f.first)].push_back (f);
+		}
+
+		// sorting on the hash puts the records from the same partition next to each other
+		sort (myState.heavy.begin (), myState.heavy.end (),
+			[] (const pair <size_t, void *> &a, const pair <size_t, void *> &b) {return a.first < b.first;});
+	});
+}
+
+void ParallelHashJoin :: findHeavyHitters () {
+
+	size_t numRecs = 0;
+	for (auto &t : threads)
+		numRecs += t.found.size ();
+
+	if (numRecs == 0)
+		return;
+
+	// count the hashes in an evenly-spaced sample of the records
+	size_t step = numRecs / HEAVY_HITTER_SAMPLE_SIZE + 1;
+	unordered_map <size_t, int> counts;
+	size_t sampleSize = 0;
+	for (auto &t : threads) {
+		for (size_t i = 0; i < t.found.size (); i += step) {
+			counts[t.found[i].first]++;
+			sampleSize++;
+		}
+	}
+
+	// and keep the ones that show up a lot (a key that shows up once can't be a heavy hitter)
+	for (auto &c : counts) {
+		if (c.second > 1 && ((size_t) c.second) * HEAVY_HITTER_SHARE * numThreads >= sampleSize)
+			heavyHitters.insert (c.first);
+	}
+}
+
+void ParallelHashJoin :: probe (ThreadState &myState, vector <pair <size_t, void *>> &probes, size_t first,
+	size_t last, RecordHashTable &myTable) {
+
+	vector <size_t> hashes;
+	vector <long> heads;
+	for (size_t which = first; which < last; which++)
+		hashes.push_back (probes[which].first);
+	myTable.findBatch (hashes, heads);
+
+	for (size_t which = first; which < last; which++) {
+
+		// if there is no match, skip this guy
+		if (heads[which - first] == -1)
+			continue;
+
+		myState.rightRec->fromBinary (probes[which].second);
+
+		// iterate though the potential matches, checking each of them
+		for (long e = heads[which - first]; e != -1; e = myTable.getNext (e)) {
+
+			myState.leftRec->fromBinary (myTable.getRecord (e));
+			if (!myState.finalPred ()->toBool ())
+				continue;
+
+			// run all of the computations, and write the result to our buffer
+			int i = 0;
+			for (auto &f : myState.finalComputations) {
+				myState.outputRec->getAtt (i++)->set (f ());
+			}
+			myState.outputRec->recordContentHasChanged ();
+			size_t oldSize = myState.outputBytes.size ();
+			myState.outputBytes.resize (oldSize + myState.outputRec->getBinarySize ());
+			myState.outputRec->toBinary (myState.outputBytes.data () + oldSize);
+		}
+	}
+}
+
+void ParallelHashJoin :: flushOutput () {
+	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+	for (auto &t : threads) {
+		char *pos = t.outputBytes.data ();
+		char *end = pos + t.outputBytes.size ();
+		while (pos != end) {
+			pos = (char *) outputRec->fromBinary (pos);
+			output->append (outputRec);
+		}
+		t.outputBytes.clear ();
+	}
+}
+
+void ParallelHashJoin :: run () {
+
+	// with one thread, or nothing to partition on, just do a regular scan join
+	if (numThreads == 1 || equalityChecks.size () == 0) {
+		ScanJoin myOp (leftTable, rightTable, output, finalSelectionPredicate, projections,
+			equalityChecks, leftSelectionPredicate, rightSelectionPredicate);
+		myOp.run ();
+		return;
+	}
+
+	// get the schema that results from combining the left and right records
+	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
+	for (auto &p : leftTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+	for (auto &p : rightTable->getTable ()->getSchema ()->getAtts ())
+		mySchemaOut->appendAtt (p);
+
+	vector <string> leftKeys;
+	vector <string> rightKeys;
+	for (auto &p : equalityChecks) {
+		leftKeys.push_back (p.first);
+		rightKeys.push_back (p.second);
+	}
+
+	// set up everything that each of the threads needs
+	threads.resize (numThreads);
+	for (auto &t : threads) {
+
+		t.leftRec = leftTable->getEmptyRecord ();
+		t.leftPred = t.leftRec->compileComputation (leftSelectionPredicate);
+		t.leftHash = buildKeyHasher (t.leftRec, leftKeys);
+
+		t.rightRec = rightTable->getEmptyRecord ();
+		t.rightPred = t.rightRec->compileComputation (rightSelectionPredicate);
+		t.rightHash = buildKeyHasher (t.rightRec, rightKeys);
+
+		t.combinedRec = make_shared <MyDB_Record> (mySchemaOut);
+		t.combinedRec->buildFrom (t.leftRec, t.rightRec);
+		t.finalPred = t.combinedRec->compileComputation (finalSelectionPredicate);
+		for (string s : projections) {
+			t.finalComputations.push_back (t.combinedRec->compileComputation (s));
+		}
+		t.outputRec = output->getEmptyRecord ();
+	}
+
+	// pin all of the left pages
+	vector <MyDB_PageReaderWriter> allData;
+	vector <pair <void *, void *>> leftPages;
+	for (int i = 0; i < leftTable->getNumPages (); i++) {
+		MyDB_PageReaderWriter temp = leftTable->getPinned (i);
+		if (temp.getType () == MyDB_PageType :: RegularPage) {
+			allData.push_back (temp);
+			leftPages.push_back (temp.getRecordBytes ());
+		}
+	}
+
+	// partition them, and then build a hash table for each partition
+	partitionPages (leftPages, true);
+	int numPartitions = 1 << numPartitionBits;
+	tables.clear ();
+	tables.resize (numPartitions);
+	TaskScheduler :: run (numPartitions, numThreads, [&] (int, size_t whichPart) {
+
+		size_t numRecs = 0;
+		for (auto &t : threads)
+			numRecs += t.partitioned[whichPart].size ();
+
+		tables[whichPart] = RecordHashTable (numRecs);
+		vector <size_t> hashes;
+		vector <void *> recs;
+		for (auto &t : threads) {
+			hashes.clear ();
+			recs.clear ();
+			for (auto &f : t.partitioned[whichPart]) {
+				hashes.push_back (f.first);
+				recs.push_back (f.second);
+			}
+			tables[whichPart].insertBatch (hashes, recs);
+		}
+	});
+
+	// now we go through the right table a chunk at a time... we can pin as many pages as
+	// the left table left us, but we keep half of them back for writing the output
+	int chunkSize = (leftTable->getBufferMgr ()->getNumPages () - allData.size ()) / 2;
+	if (chunkSize < 1)
+		chunkSize = 1;
+
+	for (int first = 0; first < rightTable->getNumPages (); first += chunkSize) {
+
+		// pin the chunk
+		vector <MyDB_PageReaderWriter> chunk;
+		vector <pair <void *, void *>> rightPages;
+		for (int i = first; i < first + chunkSize && i < rightTable->getNumPages (); i++) {
+			MyDB_PageReaderWriter temp = rightTable->getPinned (i);
+			if (temp.getType () == MyDB_PageType :: RegularPage) {
+				chunk.push_back (temp);
+				rightPages.push_back (temp.getRecordBytes ());
+			}
+		}
+
+		// partition the chunk the same way as the left
+		partitionPages (rightPages, false);
+
+		// and probe each partition; after the partitions, there is one more task for each thread's heavy hitters
+		TaskScheduler :: run (numPartitions + numThreads, numThreads, [&] (int me, size_t which) {
+
+			ThreadState &myState = threads[me];
+			if (which < (size_t) numPartitions) {
+				for (auto &t : threads) {
+					probe (myState, t.partitioned[which], 0, t.partitioned[which].size (), tables[which]);
+				}
+				return;
+			}
+
+			// probe with the heavy hitters that one thread found, a partition at a time
+			vector <pair <size_t, void *>> &heavy = threads[which - numPartitions].heavy;
+			size_t first = 0;
+			while (first < heavy.size ()) {
+				size_t whichPart = getPartition (heavy[first].first);
+				size_t last = first + 1;
+				while (last < heavy.size () && getPartition (heavy[last].first) == whichPart)
+					last++;
+				probe (myState, heavy, first, last, tables[whichPart]);
+				first = last;
+			}
+		});
+
+		// and write out the results
+		flushOutput ();
+	}
+
+	tables.clear ();
+	threads.clear ();
+}
+
+#endif
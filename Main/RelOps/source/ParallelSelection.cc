@@ -0,0 +1,105 @@
+
+#ifndef PARALLEL_SELECTION_C
+#define PARALLEL_SELECTION_C
+
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_Record.h"
+#include "MyDB_TableReaderWriter.h"
+#include "ParallelSelection.h"
+#include "RegularSelection.h"
+#include "TaskScheduler.h"
+
+using namespace std;
+
+ParallelSelection :: ParallelSelection (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                string selectionPredicateIn, vector <string> projectionsIn) : ParallelSelection (inputIn, outputIn,
+		selectionPredicateIn, projectionsIn, TaskScheduler :: getMaxThreads ()) {}
+
+ParallelSelection :: ParallelSelection (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+                string selectionPredicateIn, vector <string> projectionsIn, int numThreadsIn) {
+
+	input = inputIn;
+	output = outputIn;
+	selectionPredicate = selectionPredicateIn;
+	projections = projectionsIn;
+	numThreads = numThreadsIn;
+	if (numThreads < 1)
+		numThreads = 1;
+}
+
+void ParallelSelection :: run () {
+
+	// with one thread, or not enough pages to go around, just do a regular selection
+	if (numThreads == 1 || input->getNumPages () < 2) {
+		RegularSelection myOp (input, output, selectionPredicate, projections);
+		myOp.run ();
+		return;
+	}
+
+	// set up everything that each of the threads needs
+	vector <ThreadState> threads (numThreads);
+	for (auto &t : threads) {
+		t.inputRec = input->getEmptyRecord ();
+		t.pred = t.inputRec->compileComputation (selectionPredicate);
+		for (string s : projections) {
+			t.finalComputations.push_back (t.inputRec->compileComputation (s));
+		}
+		t.outputRec = output->getEmptyRecord ();
+	}
+
+	// we go through the input a chunk at a time, keeping half of the buffer pool back for writing the output
+	int chunkSize = input->getBufferMgr ()->getNumPages () / 2;
+	if (chunkSize < 1)
+		chunkSize = 1;
+
+	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
+	for (int first = 0; first < input->getNumPages (); first += chunkSize) {
+
+		// pin the chunk
+		vector <MyDB_PageReaderWriter> chunk;
+		vector <pair <void *, void *>> pages;
+		for (int j = first; j < first + chunkSize && j < input->getNumPages (); j++) {
+			MyDB_PageReaderWriter temp = input->getPinned (j);
+			if (temp.getType () == MyDB_PageType :: RegularPage) {
+				chunk.push_back (temp);
+				pages.push_back (temp.getRecordBytes ());
+			}
+		}
+
+		// have the threads take the pages, writing the output for each page into its own buffer
+		vector <vector <char>> outputBytes (pages.size ());
+		TaskScheduler :: run (pages.size (), numThreads, [&] (int me, size_t which) {
+
+			ThreadState &myState = threads[me];
+			vector <char> &myBytes = outputBytes[which];
+			void *pos = pages[which].first;
+			while (pos != pages[which].second) {
+
+				pos = myState.inputRec->fromBinary (pos);
+				if (!myState.pred ()->toBool ())
+					continue;
+
+				int i = 0;
+				for (auto &f : myState.finalComputations) {
+					myState.outputRec->getAtt (i++)->set (f ());
+				}
+				myState.outputRec->recordContentHasChanged ();
+				size_t oldSize = myBytes.size ();
+				myBytes.resize (oldSize + myState.outputRec->getBinarySize ());
+				myState.outputRec->toBinary (myBytes.data () + oldSize);
+			}
+		});
+
+		// and write out the results, in page order
+		for (auto &bytes : outputBytes) {
+			char *pos = bytes.data ();
+			char *end = pos + bytes.size ();
+			while (pos != end) {
+				pos = (char *) outputRec->fromBinary (pos);
+				output->append (outputRec);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,142 @@
+
+#ifndef REC_HASH_TABLE_C
+#define REC_HASH_TABLE_C
+
+#include "RecordHashTable.h"
+
+using namespace std;
+
+// the table is re-built once this fraction of the slots are full
+#define MAX_LOAD 0.7
+
+RecordHashTable :: RecordHashTable () : RecordHashTable (16) {}
+
+RecordHashTable :: RecordHashTable (size_t expectedNumHashes) {
+
+	size_t numSlots = 16;
+	while (numSlots * MAX_LOAD < expectedNumHashes)
+		numSlots *= 2;
+
+	slots.resize (numSlots);
+	mask = numSlots - 1;
+	numUsed = 0;
+}
+
+size_t RecordHashTable :: findSlot (size_t hashVal, uint64_t mixed) {
+
+	uint16_t tag = (uint16_t) (mixed >> 48);
+	size_t whichSlot = mixed & mask;
+	while (true) {
+		Slot &mySlot = slots[whichSlot];
+
+		// an empty slot means that the hash is not there
+		if (mySlot.head == 0)
+			return whichSlot;
+
+		// only look at the entry if the tag matches
+		if (mySlot.tag == tag && entries[mySlot.head - 1].hashVal == hashVal)
+			return whichSlot;
+
+		whichSlot = (whichSlot + 1) & mask;
+	}
+}
+
+void RecordHashTable :: reserve (size_t numMore) {
+
+	if (numUsed + numMore <= slots.size () * MAX_LOAD)
+		return;
+
+	size_t numSlots = slots.size ();
+	while (numSlots * MAX_LOAD < numUsed + numMore)
+		numSlots *= 2;
+
+	// re-insert all of the slots... note that the entries do not move, so we only need
+	// to look at the first entry for each hash
+	vector <Slot> oldSlots;
+	oldSlots.swap (slots);
+	slots.resize (numSlots);
+	mask = numSlots - 1;
+	for (Slot &s : oldSlots) {
+		if (s.head == 0)
+			continue;
+
+		size_t whichSlot = mix (entries[s.head - 1].hashVal) & mask;
+		while (slots[whichSlot].head != 0)
+			whichSlot = (whichSlot + 1) & mask;
+		slots[whichSlot] = s;
+	}
+}
+
+void RecordHashTable :: insertAt (size_t whichSlot, size_t hashVal, uint64_t mixed, void *rec) {
+
+	Slot &mySlot = slots[whichSlot];
+
+	// the new entry goes at the front of the list for this hash
+	Entry myEntry;
+	myEntry.hashVal = hashVal;
+	myEntry.rec = rec;
+	myEntry.next = mySlot.head;
+	entries.push_back (myEntry);
+
+	if (mySlot.head == 0) {
+		mySlot.tag = (uint16_t) (mixed >> 48);
+		numUsed++;
+	}
+	mySlot.head = entries.size ();
+}
+
+void RecordHashTable :: insert (size_t hashVal, void *rec) {
+	reserve (1);
+	uint64_t mixed = mix (hashVal);
+	insertAt (findSlot (hashVal, mixed), hashVal, mixed, rec);
+}
+
+void RecordHashTable :: insertBatch (vector <size_t> &hashes, vector <void *> &recs) {
+
+	// make room for the whole batch up front, so that the slots do not move while we are working
+	reserve (hashes.size ());
+	entries.reserve (entries.size () + hashes.size ());
+
+	// first, touch all of the slots that we are going to need
+	vector <uint64_t> mixed (hashes.size ());
+	for (size_t i = 0; i < hashes.size (); i++) {
+		mixed[i] = mix (hashes[i]);
+		__builtin_prefetch (&slots[mixed[i] & mask], 1);
+	}
+
+	// and now do the inserts
+	for (size_t i = 0; i < hashes.size (); i++) {
+		insertAt (findSlot (hashes[i], mixed[i]), hashes[i], mixed[i], recs[i]);
+	}
+}
+
+long RecordHashTable :: find (size_t hashVal) {
+	return ((long) slots[findSlot (hashVal, mix (hashVal))].head) - 1;
+}
+
+void RecordHashTable :: findBatch (vector <size_t> &hashes, vector <long> &heads) {
+
+	// first, touch all of the slots that we are going to need
+	vector <uint64_t> mixed (hashes.size ());
+	for (size_t i = 0; i < hashes.size (); i++) {
+		mixed[i] = mix (hashes[i]);
+		__builtin_prefetch (&slots[mixed[i] & mask]);
+	}
+
+	// now find the first entry for each hash, and touch it, since the caller is going to need it
+	heads.resize (hashes.size ());
+	for (size_t i = 0; i < hashes.size (); i++) {
+		heads[i] = ((long) slots[findSlot (hashes[i], mixed[i])].head) - 1;
+		if (heads[i] != -1)
+			__builtin_prefetch (&entries[heads[i]]);
+	}
+}
+
+void RecordHashTable :: clear () {
+	vector <Entry> ().swap (entries);
+	vector <Slot> (16).swap (slots);
+	mask = 15;
+	numUsed = 0;
+}
+
+#endif
@@ -0,0 +1,67 @@
+
+#ifndef RUNTIME_FILTER_C
+#define RUNTIME_FILTER_C
+
+#include "KeyHash.h"
+#include "RuntimeFilter.h"
+
+using namespace std;
+
+RuntimeFilter :: RuntimeFilter (size_t expectedNumKeys) {
+
+	// about 10 bits per key, rounded up to a power of two number of words
+	size_t numWords = 1;
+	while (numWords * 64 < expectedNumKeys * 10)
+		numWords *= 2;
+
+	bits.resize (numWords, 0);
+	wordMask = numWords - 1;
+	haveRange = false;
+	low = 0;
+	high = 0;
+}
+
+function <double ()> RuntimeFilter :: buildRangeKey (MyDB_RecordPtr rec, vector <string> &keys) {
+
+	if (keys.size () != 1 || !rec->getType (keys[0])->promotableToDouble ())
+		return nullptr;
+
+	func f = rec->compileComputation (keys[0]);
+	return [f] {return f ()->toDouble ();};
+}
+
+function <bool ()> RuntimeFilter :: buildAdder (MyDB_RecordPtr rec, vector <string> &keys) {
+
+	function <size_t ()> hash = buildKeyHasher (rec, keys);
+	function <double ()> rangeKey = buildRangeKey (rec, keys);
+	if (rangeKey == nullptr) {
+		return [this, hash] {
+			addHash (hash ());
+			return true;
+		};
+	}
+
+	return [this, hash, rangeKey] {
+		addHash (hash ());
+		addToRange (rangeKey ());
+		return true;
+	};
+}
+
+function <bool ()> RuntimeFilter :: buildChecker (MyDB_RecordPtr rec, vector <string> &keys) {
+
+	function <size_t ()> hash = buildKeyHasher (rec, keys);
+	function <double ()> rangeKey = buildRangeKey (rec, keys);
+	if (rangeKey == nullptr) {
+		return [this, hash] {
+			return mayContainHash (hash ());
+		};
+	}
+
+	// the range check is cheaper, so do it first
+	return [this, hash, rangeKey] {
+		return inRange (rangeKey ()) && mayContainHash (hash ());
+	};
+}
+
+#endif
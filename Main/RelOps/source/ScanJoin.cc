@@ -2,11 +2,13 @@
 #ifndef SCAN_JOIN_C
 #define SCAN_JOIN_C
 
+#include "KeyHash.h"
 #include "MyDB_Record.h"
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_TableReaderWriter.h"
+#include "RecordHashTable.h"
+#include "RuntimeFilter.h"
 #include "ScanJoin.h"
-#include <unordered_map>
 
 using namespace std;
 
@@ -51,10 +53,10 @@ ScanJoin :: ScanJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWri
 
 void ScanJoin :: run () {
 
-	// this is the hash map we'll use to look up data... the key is the hashed value
-	// of all of the records' join keys, and the value is a list of pointers were all
+	// this is the hash table we'll use to look up data... the key is the hashed value
+	// of all of the records' join keys, and it gives us a list of pointers were all
 	// of the records with that hsah value are located
-	unordered_map <size_t, vector <void *>> myHash;
+	RecordHashTable myHash;
 
 	// get all of the pages
 	vector <MyDB_PageReaderWriter> allData;
@@ -68,45 +70,67 @@ void ScanJoin :: run () {
 	MyDB_RecordPtr leftInputRec = leftTable->getEmptyRecord ();
 
 	// and get the various functions whose output we'll hash
-	vector <func> leftEqualities;
+	vector <string> leftKeys;
 	for (auto &p : equalityChecks) {
-		leftEqualities.push_back (leftInputRec->compileComputation (p.first));
+		leftKeys.push_back (p.first);
 	}
+	function <size_t ()> leftHash = buildKeyHasher (leftInputRec, leftKeys);
 
 	// now get the predicate
 	func leftPred = leftInputRec->compileComputation (leftSelectionPredicate);
 
-	// add all of the records to the hash table
-	MyDB_RecordIteratorAltPtr myIter = getIteratorAlt (allData);
+	// add all of the records to the hash table... this is done a page at a time, so that
+	// the hash table can work on a whole batch of records at once
+	vector <size_t> hashes;
+	vector <void *> recs;
+	for (auto &page : allData) {
 
-	while (myIter->advance ()) {
+		hashes.clear ();
+		recs.clear ();
+		MyDB_RecordIteratorAltPtr myIter = page.getIteratorAlt ();
+		while (myIter->advance ()) {
 
-		// hash the current record
-		myIter->getCurrent (leftInputRec);
+			// hash the current record
+			myIter->getCurrent (leftInputRec);
 
-		// see if it is accepted by the preicate
-		if (!leftPred ()->toBool ()) {
-			continue;
-		}
+			// see if it is accepted by the preicate
+			if (!leftPred ()->toBool ()) {
+				continue;
+			}
 
-		// compute its hash
-		size_t hashVal = 0;
-		for (auto &f : leftEqualities) {
-			hashVal ^= f ()->hash ();
+			// compute its hash
+			size_t hashVal = leftHash ();
+
+			hashes.push_back (hashVal);
+			recs.push_back (myIter->getCurrentPointer ());
 		}
 
-		// see if it is in the hash table
-		myHash [hashVal].push_back (myIter->getCurrentPointer ());
+		// and put the page's records in the hash table
+		myHash.insertBatch (hashes, recs);
+	}
+
+	// now build a runtime filter from the keys in the hash table, which lets us throw out most
+	// of the records from the other table that cannot match, before we do any work on them
+	RuntimeFilter myFilter (myHash.size ());
+	function <double ()> leftRangeKey = RuntimeFilter :: buildRangeKey (leftInputRec, leftKeys);
+	for (size_t e = 0; e < myHash.size (); e++) {
+		myFilter.addHash (myHash.getHash (e));
+		if (leftRangeKey != nullptr) {
+			leftInputRec->fromBinary (myHash.getRecord (e));
+			myFilter.addToRange (leftRangeKey ());
+		}
 	}
 
 	// and now we iterate through the other table
 	
 	// get the right input record, and get the various functions over it
 	MyDB_RecordPtr rightInputRec = rightTable->getEmptyRecord ();
-	vector <func> rightEqualities;
+	vector <string> rightKeys;
 	for (auto &p : equalityChecks) {
-		rightEqualities.push_back (rightInputRec->compileComputation (p.second));
+		rightKeys.push_back (p.second);
 	}
+	function <size_t ()> rightHash = buildKeyHasher (rightInputRec, rightKeys);
+	function <double ()> rightRangeKey = RuntimeFilter :: buildRangeKey (rightInputRec, rightKeys);
 
 	// now get the predicate
 	func rightPred = rightInputRec->compileComputation (rightSelectionPredicate);
@@ -134,54 +158,77 @@ void ScanJoin :: run () {
 	// this is the output record
 	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
 	
-	// now, iterate through the right table
-	MyDB_RecordIteratorPtr myIterAgain = rightTable->getIterator (rightInputRec);
-	while (myIterAgain->hasNext ()) {
+	// now, iterate through the right table, a page at a time... the page is pinned while
+	// we work on it, so that we can go back to its records after the whole page has been
+	// looked up in the hash table
+	vector <long> heads;
+	for (int page = 0; page < rightTable->getNumPages (); page++) {
+
+		MyDB_PageReaderWriter curPage = rightTable->getPinned (page);
+		if (curPage.getType () != MyDB_PageType :: RegularPage)
+			continue;
 
-		myIterAgain->getNext ();
+		// hash all of the records on the page
+		hashes.clear ();
+		recs.clear ();
+		MyDB_RecordIteratorAltPtr myIterAgain = curPage.getIteratorAlt ();
+		while (myIterAgain->advance ()) {
 
-		// see if it is accepted by the preicate
-		if (!rightPred ()->toBool ()) {
-			continue;
-		}
+			myIterAgain->getCurrent (rightInputRec);
 
-		// hash the current record
-		size_t hashVal = 0;
-		for (auto &f : rightEqualities) {
-			hashVal ^= f ()->hash ();
-		}
+			// hash the current record, and see if it can possibly have a match
+			size_t hashVal = rightHash ();
+			if (rightRangeKey != nullptr && !myFilter.inRange (rightRangeKey ())) {
+				continue;
+			}
+			if (!myFilter.mayContainHash (hashVal)) {
+				continue;
+			}
 
-		// get the list of potential matches... first verify that there IS
-		// a match in there
-		if (myHash.count (hashVal) == 0) {
-			continue;
+			// see if it is accepted by the preicate
+			if (!rightPred ()->toBool ()) {
+				continue;
+			}
+
+			hashes.push_back (hashVal);
+			recs.push_back (myIterAgain->getCurrentPointer ());
 		}
 
-		// if there is a match, then get the list of matches
-		vector <void *> &potentialMatches = myHash [hashVal];
-		
-		// and iterate though the potential matches, checking each of them
-		for (auto &v : potentialMatches) {
+		// get the list of potential matches for all of them
+		myHash.findBatch (hashes, heads);
 
-			// build the combined record
-			leftInputRec->fromBinary (v);
+		for (size_t which = 0; which < heads.size (); which++) {
 
-			// check to see if it is accepted by the join predicate
-			if (finalPredicate ()->toBool ()) {
+			// if there is no match, skip this guy
+			if (heads[which] == -1) {
+				continue;
+			}
 
-				// run all of the computations
-				int i = 0;
-				for (auto &f : finalComputations) {
-					outputRec->getAtt (i++)->set (f());
-				}
+			rightInputRec->fromBinary (recs[which]);
 
-				// the record's content has changed because it 
-				// is now a composite of two records whose content
-				// has changed via a read... we have to tell it this,
-				// or else the record's internal buffer may cause it
-				// to write old values
-				outputRec->recordContentHasChanged ();
-				output->append (outputRec);	
+			// and iterate though the potential matches, checking each of them
+			for (long e = heads[which]; e != -1; e = myHash.getNext (e)) {
+
+				// build the combined record
+				leftInputRec->fromBinary (myHash.getRecord (e));
+
+				// check to see if it is accepted by the join predicate
+				if (finalPredicate ()->toBool ()) {
+
+					// run all of the computations
+					int i = 0;
+					for (auto &f : finalComputations) {
+						outputRec->getAtt (i++)->set (f());
+					}
+
+					// the record's content has changed because it 
+					// is now a composite of two records whose content
+					// has changed via a read... we have to tell it this,
+					// or else the record's internal buffer may cause it
+					// to write old values
+					outputRec->recordContentHasChanged ();
+					output->append (outputRec);	
+				}
 			}
 		}
 	}
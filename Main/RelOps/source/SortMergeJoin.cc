@@ -3,10 +3,12 @@
 #define SORTMERGE_CC
 
 #include "Aggregate.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
 #include "MyDB_Record.h"
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_TableReaderWriter.h"
 #include "SortMergeJoin.h"
+#include "RuntimeFilter.h"
 #include "Sorting.h"
 #include <unordered_map>
 
@@ -14,12 +16,20 @@ SortMergeJoin :: SortMergeJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_Tabl
                 MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn, 
                 vector <string> projectionsIn,
                 pair <string, string> equalityCheckIn, string leftSelectionPredicateIn,
+                string rightSelectionPredicateIn) : SortMergeJoin (leftInputIn, rightInputIn, outputIn,
+		finalSelectionPredicateIn, projectionsIn, vector <pair <string, string>> (1, equalityCheckIn),
+		leftSelectionPredicateIn, rightSelectionPredicateIn) {}
+
+SortMergeJoin :: SortMergeJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWriterPtr rightInputIn,
+                MyDB_TableReaderWriterPtr outputIn, string finalSelectionPredicateIn, 
+                vector <string> projectionsIn,
+                vector <pair <string, string>> equalityChecksIn, string leftSelectionPredicateIn,
                 string rightSelectionPredicateIn) {
 
 	output = outputIn;
 	finalSelectionPredicate = finalSelectionPredicateIn;
 	projections = projectionsIn;
-	equalityCheck = equalityCheckIn;
+	equalityChecks = equalityChecksIn;
 	leftTable = leftInputIn;
 	rightTable = rightInputIn; 
 	leftSelectionPredicate = leftSelectionPredicateIn;
@@ -27,26 +37,133 @@ SortMergeJoin :: SortMergeJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_Tabl
 	runSize = leftTable->getBufferMgr ()->numPages / 2;
 }
 
+// estimates the number of records in the table, by counting the records on its first page
+static size_t estimateNumRecords (MyDB_TableReaderWriterPtr forMe) {
+
+	size_t numOnPage = 0;
+	MyDB_RecordPtr temp = forMe->getEmptyRecord ();
+	for (int i = 0; i < forMe->getNumPages (); i++) {
+		if ((*forMe)[i].getType () != MyDB_PageType :: RegularPage)
+			continue;
+
+		MyDB_RecordIteratorAltPtr myIter = (*forMe)[i].getIteratorAlt ();
+		while (myIter->advance ()) {
+			myIter->getCurrent (temp);
+			numOnPage++;
+		}
+		break;
+	}
+
+	return numOnPage * forMe->getNumPages ();
+}
+
+// if the table is a B+-Tree that is ordered on one of the keys (one of the .first computations if isLeft
+// is true, and one of the .second computations otherwise), returns that key's index; otherwise returns -1
+static int findOrderedKey (MyDB_TableReaderWriterPtr forMe, vector <pair <string, string>> &keys, bool isLeft) {
+
+	MyDB_BPlusTreeReaderWriterPtr myTree = dynamic_pointer_cast <MyDB_BPlusTreeReaderWriter> (forMe);
+	if (myTree == nullptr || myTree->getNumPages () < 2)
+		return -1;
+
+	string orderedOn = "[" + myTree->getOrderingAttName () + "]";
+	for (size_t i = 0; i < keys.size (); i++) {
+		if ((isLeft ? keys[i].first : keys[i].second) == orderedOn)
+			return (int) i;
+	}
+	return -1;
+}
+
 void SortMergeJoin :: run () {
 
+	// if an input is a B+-Tree that is ordered on one of its join keys, then it is already sorted... in
+	// that case we merge on just that one pair of keys (the final predicate checks all of the others), so
+	// that the tree can be read in order rather than sorted.  Both inputs can only skip the sort if they
+	// are ordered on the same pair
+	int leftOrdered = findOrderedKey (leftTable, equalityChecks, true);
+	int rightOrdered = findOrderedKey (rightTable, equalityChecks, false);
+	int mergeOn = leftOrdered != -1 ? leftOrdered : rightOrdered;
+	bool leftIsSorted = mergeOn != -1 && leftOrdered == mergeOn;
+	bool rightIsSorted = mergeOn != -1 && rightOrdered == mergeOn;
+
+	vector <pair <string, string>> mergeChecks = equalityChecks;
+	if (mergeOn != -1)
+		mergeChecks = vector <pair <string, string>> (1, equalityChecks[mergeOn]);
+
+	// get the keys on each side
+	vector <string> leftKeys;
+	vector <string> rightKeys;
+	for (auto &p : mergeChecks) {
+		leftKeys.push_back (p.first);
+		rightKeys.push_back (p.second);
+	}
+
 	// get two left input records
 	MyDB_RecordPtr leftInputRec = leftTable->getEmptyRecord ();
 	MyDB_RecordPtr leftInputRecOther = leftTable->getEmptyRecord ();
 
-	// get two right input records
+	// get the right input record
 	MyDB_RecordPtr rightInputRec = rightTable->getEmptyRecord ();
-	MyDB_RecordPtr rightInputRecOther = rightTable->getEmptyRecord ();
 
 	// build comparators over them
-	function <bool ()> leftComp = buildRecordComparator (leftInputRec, leftInputRecOther, equalityCheck.first);
-	function <bool ()> leftCompRev = buildRecordComparator (leftInputRecOther, leftInputRec, equalityCheck.first);
-	function <bool ()> rightComp = buildRecordComparator (rightInputRec, rightInputRecOther, equalityCheck.second);
+	function <bool ()> leftComp = buildRecordComparator (leftInputRec, leftInputRecOther, leftKeys);
+	function <bool ()> leftCompRev = buildRecordComparator (leftInputRecOther, leftInputRec, leftKeys);
+
+	// the sorted iterators load records into the records that their comparators are built
+	// over every time that they advance, so they get their own records; otherwise, they
+	// would overwrite the records that we are in the middle of merging
+	MyDB_RecordPtr leftSortRec = leftTable->getEmptyRecord ();
+	MyDB_RecordPtr leftSortRecOther = leftTable->getEmptyRecord ();
+	MyDB_RecordPtr rightSortRec = rightTable->getEmptyRecord ();
+	MyDB_RecordPtr rightSortRecOther = rightTable->getEmptyRecord ();
+	function <bool ()> leftSortComp = buildRecordComparator (leftSortRec, leftSortRecOther, leftKeys);
+	function <bool ()> rightSortComp = buildRecordComparator (rightSortRec, rightSortRecOther, rightKeys);
+
+	// the smaller table is sorted first, and as it is, a runtime filter is built over its join keys;
+	// this is used to throw out records from the larger table that cannot match, before they are sorted.
+	// If either table is not being sorted, there is no filter, since we cannot build it or check it
+	bool leftIsSmaller = leftTable->getNumPages () <= rightTable->getNumPages ();
+	bool useFilter = !leftIsSorted && !rightIsSorted;
+	RuntimeFilter myFilter (useFilter ? estimateNumRecords (leftIsSmaller ? leftTable : rightTable) : 0);
+	function <bool ()> leftFilter = nullptr;
+	function <bool ()> rightFilter = nullptr;
+	if (useFilter) {
+		leftFilter = leftIsSmaller ? myFilter.buildAdder (leftSortRec, leftKeys) :
+			myFilter.buildChecker (leftSortRec, leftKeys);
+		rightFilter = leftIsSmaller ? myFilter.buildChecker (rightSortRec, rightKeys) :
+			myFilter.buildAdder (rightSortRec, rightKeys);
+	}
 
-	// now, sort the left and the right
-	MyDB_RecordIteratorAltPtr right = buildItertorOverSortedRuns (runSize, *rightTable, rightComp, rightInputRec, 
-		rightInputRecOther, rightSelectionPredicate);
-	MyDB_RecordIteratorAltPtr left = buildItertorOverSortedRuns (runSize, *leftTable, leftComp, leftInputRec, 
-		leftInputRecOther, leftSelectionPredicate);
+	// now, sort the left and the right (unless they are already sorted)... replacement selection gives
+	// us longer (and so fewer) runs, and if there is a single join key, we pass it in so that a fixed-width
+	// key can be sorted without the comparators (with more than one key, the comparators are always used)
+	string leftSortKey = mergeChecks.size () == 1 ? mergeChecks[0].first : "";
+	string rightSortKey = mergeChecks.size () == 1 ? mergeChecks[0].second : "";
+	MyDB_RecordIteratorAltPtr left;
+	MyDB_RecordIteratorAltPtr right;
+	auto sortLeft = [&] {
+		if (leftIsSorted) {
+			left = dynamic_pointer_cast <MyDB_BPlusTreeReaderWriter> (leftTable)->getSortedIteratorAlt (leftSelectionPredicate);
+		} else {
+			left = buildItertorOverSortedRuns (runSize, *leftTable, leftSortComp, leftSortRec, 
+				leftSortRecOther, leftSelectionPredicate, true, leftSortKey, leftFilter);
+		}
+	};
+	auto sortRight = [&] {
+		if (rightIsSorted) {
+			right = dynamic_pointer_cast <MyDB_BPlusTreeReaderWriter> (rightTable)->getSortedIteratorAlt (rightSelectionPredicate);
+		} else {
+			right = buildItertorOverSortedRuns (runSize, *rightTable, rightSortComp, rightSortRec, 
+				rightSortRecOther, rightSelectionPredicate, true, rightSortKey, rightFilter);
+		}
+	};
+
+	if (leftIsSmaller) {
+		sortLeft ();
+		sortRight ();
+	} else {
+		sortRight ();
+		sortLeft ();
+	}
 
 	// and get the schema that results from combining the left and right records
 	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
@@ -68,17 +185,103 @@ void SortMergeJoin :: run () {
 		finalComputations.push_back (combinedRec->compileComputation (s));
 	}
 	
-	// compares the two input recs
-	func leftSmaller = combinedRec->compileComputation (" < (" + equalityCheck.first + ", " + equalityCheck.second + ")");
-	func rightSmaller = combinedRec->compileComputation (" > (" + equalityCheck.first + ", " + equalityCheck.second + ")");
-	func areEqual = combinedRec->compileComputation (" == (" + equalityCheck.first + ", " + equalityCheck.second + ")");
+	// compares the two input recs, one pair of keys at a time
+	vector <func> lessThans;
+	vector <func> greaterThans;
+	for (auto &p : mergeChecks) {
+		lessThans.push_back (combinedRec->compileComputation (" < (" + p.first + ", " + p.second + ")"));
+		greaterThans.push_back (combinedRec->compileComputation (" > (" + p.first + ", " + p.second + ")"));
+	}
+
+	// the first pair of keys that differ decides which record is smaller
+	function <bool ()> leftSmaller = [&] {
+		for (size_t i = 0; i < lessThans.size (); i++) {
+			if (lessThans[i] ()->toBool ())
+				return true;
+			if (greaterThans[i] ()->toBool ())
+				return false;
+		}
+		return false;
+	};
+
+	function <bool ()> rightSmaller = [&] {
+		for (size_t i = 0; i < lessThans.size (); i++) {
+			if (greaterThans[i] ()->toBool ())
+				return true;
+			if (lessThans[i] ()->toBool ())
+				return false;
+		}
+		return false;
+	};
+
+	function <bool ()> areEqual = [&] {
+		for (size_t i = 0; i < lessThans.size (); i++) {
+			if (lessThans[i] ()->toBool () || greaterThans[i] ()->toBool ())
+				return false;
+		}
+		return true;
+	};
 	
 	// this is the output record
 	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
 
-	// it is time to run the merge!!
-	MyDB_PageReaderWriter lastPage (true, *(leftTable->getBufferMgr ()));
-	vector <MyDB_PageReaderWriter> allPages;
+	// the records from each side that have the same key are put into pinned pages, but we won't pin
+	// more than this many pages for each side... if there are more LHS records with the key than this,
+	// they are spilled to a temporary table, and if there are more RHS ones, they are joined with the
+	// LHS ones a block at a time
+	MyDB_BufferManagerPtr myMgr = leftTable->getBufferMgr ();
+	size_t maxGroupPages = myMgr->getNumPages () / 8;
+	if (maxGroupPages < 1)
+		maxGroupPages = 1;
+
+	vector <MyDB_PageReaderWriter> leftGroup;
+	vector <MyDB_PageReaderWriter> rightBlock;
+	MyDB_TableReaderWriterPtr leftSpill = nullptr;
+	string spillName = output->getTable ()->getStorageLoc () + "_smjGroup";
+
+	// the first LHS record with the key, which the RHS records are compared with
+	vector <char> groupKey;
+
+	// adds the record to the end of the pages, returning false if it would take too many
+	auto appendToPages = [&] (vector <MyDB_PageReaderWriter> &pages, MyDB_RecordPtr rec) {
+		if (pages.size () > 0 && pages.back ().append (rec))
+			return true;
+		if (pages.size () >= maxGroupPages)
+			return false;
+		pages.push_back (MyDB_PageReaderWriter (true, *myMgr));
+		pages.back ().append (rec);
+		return true;
+	};
+
+	auto iterateOver = [] (vector <MyDB_PageReaderWriter> &pages) {
+		if (pages.size () == 1)
+			return pages[0].getIteratorAlt ();
+		return getIteratorAlt (pages);
+	};
+
+	// joins all of the LHS records in the group with the block of RHS records... the LHS records are
+	// only read once for each block
+	auto joinBlock = [&] {
+		MyDB_RecordIteratorAltPtr leftIter = leftSpill != nullptr ? leftSpill->getIteratorAlt () : iterateOver (leftGroup);
+		while (leftIter->advance ()) {
+			leftIter->getCurrent (leftInputRec);
+			MyDB_RecordIteratorAltPtr rightIter = iterateOver (rightBlock);
+			while (rightIter->advance ()) {
+				rightIter->getCurrent (rightInputRec);
+				if (finalPredicate ()->toBool ()) {
+					// got one!!
+					int i = 0;
+					for (auto &f : finalComputations) {
+						outputRec->getAtt (i++)->set (f());
+					}
+					outputRec->recordContentHasChanged ();
+					output->append (outputRec);	
+				}
+			}
+		}
+		rightBlock.clear ();
+		leftInputRec->fromBinary (groupKey.data ());
+	};
 
 	// if we have no results...
 	if (!left->advance () || !right->advance ())
@@ -91,103 +294,91 @@ void SortMergeJoin :: run () {
 		left->getCurrent (leftInputRec);
 		right->getCurrent (rightInputRec);
 
-		if (leftSmaller ()->toBool ()) {
+		if (leftSmaller ()) {
 
 			// try to move the left forward
 			if (!left->advance ()) {
 				allDone = true;
 			}
 
-		} else if (rightSmaller ()->toBool ()) {
+		} else if (rightSmaller ()) {
 
 			// try to move the right forward
 			if (!right->advance ()) {
 				allDone = true;
 			}
 
-		} else if (areEqual ()->toBool ()) {
+		} else if (areEqual ()) {
 
-			lastPage.clear ();
-			allPages.clear ();
-			allPages.push_back (lastPage);
-			lastPage.append (leftInputRec);
+			groupKey.resize (leftInputRec->getBinarySize ());
+			leftInputRec->toBinary (groupKey.data ());
+			leftGroup.clear ();
+			appendToPages (leftGroup, leftInputRec);
 			
 			// get all of the LHS records that have the same key
-			int counter = 1;
 			while (true) {
 
 				if (!left->advance ()) {
-					//cout << "Got " << counter << " in the group.\n";
 					allDone = true;
 					break;
 				}
 
 				left->getCurrent (leftInputRecOther);
 
-				// it is the same!!
-				if (!leftComp () && !leftCompRev ()) {
-					if (!lastPage.append (leftInputRecOther)) {
-						MyDB_PageReaderWriter nextPage (true, *(leftTable->getBufferMgr ()));
-						lastPage = nextPage;
-						allPages.push_back (lastPage);
-						lastPage.append (leftInputRecOther);
-					}
-					counter++;
-
 				// it is not the same!!
-				} else {
-					//cout << "Got " << counter << " in the group.\n";
+				if (leftComp () || leftCompRev ())
 					break;
+
+				// it is the same!!
+				if (leftSpill != nullptr) {
+					leftSpill->append (leftInputRecOther);
+
+				// if the group has gotten too big to keep pinned, move it to disk
+				} else if (!appendToPages (leftGroup, leftInputRecOther)) {
+					leftSpill = make_shared <MyDB_TableReaderWriter> (make_shared <MyDB_Table> (spillName, spillName,
+						leftTable->getTable ()->getSchema ()), myMgr);
+					MyDB_RecordIteratorAltPtr groupIter = iterateOver (leftGroup);
+					while (groupIter->advance ()) {
+						groupIter->getCurrent (leftInputRec);
+						leftSpill->append (leftInputRec);
+					}
+					leftSpill->append (leftInputRecOther);
+					leftGroup.clear ();
+					leftInputRec->fromBinary (groupKey.data ());
 				}
 			}
 
-			// now, keep pulling off RHS records while we have the same key
-			counter = 0;
+			// now, keep pulling off RHS records while we have the same key, joining them a block at a time
 			while (true) {
 			
-				// the records are the same!!
-				if (areEqual ()->toBool ()) {
-
-					//cout << rightInputRec << "\n";
-					counter++;
-
-					// now we check all of the RHS records that have the same key
-					MyDB_RecordIteratorAltPtr myIterAgain;
-					if (allPages.size () == 1) {
-						myIterAgain = allPages[0].getIteratorAlt ();
-					} else {
-						myIterAgain = getIteratorAlt (allPages);
-					}
-
-					// check for a match
-					while (myIterAgain->advance ()) {
-						myIterAgain->getCurrent (leftInputRec);		
-						if (finalPredicate ()->toBool ()) {
-							// got one!!
-							int i = 0;
-							for (auto &f : finalComputations) {
-								outputRec->getAtt (i++)->set (f());
-							}
-							outputRec->recordContentHasChanged ();
-							output->append (outputRec);	
-						}
-					}
-					
-				// if not, we moved past the end
-				} else {
-					//cout << "\t" << counter << " matches.\n";
+				// we moved past the end of the group
+				if (!areEqual ())
 					break;
+
+				if (!appendToPages (rightBlock, rightInputRec)) {
+					joinBlock ();
+					right->getCurrent (rightInputRec);
+					appendToPages (rightBlock, rightInputRec);
 				}
 				
 				// and try to avance
 				if (!right->advance ()) {
-					//cout << "\t**" << counter << " matches.\n";
 					allDone = true;
 					break;
 				}
 				
 				right->getCurrent (rightInputRec);
 			}
+
+			// join the last block
+			if (rightBlock.size () > 0)
+				joinBlock ();
+
+			leftGroup.clear ();
+			if (leftSpill != nullptr) {
+				myMgr->killTable (leftSpill->getTable ());
+				leftSpill = nullptr;
+			}
 		}
 
 		// at this point, we check to see if we have completed
@@ -0,0 +1,207 @@
+
+#ifndef TASK_SCHEDULER_C
+#define TASK_SCHEDULER_C
+
+#include "TaskScheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// the tasks that one thread has not started yet; the thread takes them from the front, and a thief
+// takes them from the back
+struct TaskRange {
+	mutex lock;
+	size_t first = 0;
+	size_t last = 0;
+};
+
+// one batch of tasks
+struct TaskBatch {
+
+	TaskBatch (size_t numTasks, int numThreadsIn, function <void (int, size_t)> &runMeIn) :
+		runMe (runMeIn), numThreads (numThreadsIn), ranges (numThreadsIn) {
+
+		// to start with, each thread gets the same number of tasks
+		for (int i = 0; i < numThreads; i++) {
+			ranges[i].first = numTasks * i / numThreads;
+			ranges[i].last = numTasks * (i + 1) / numThreads;
+		}
+	}
+
+	function <void (int, size_t)> &runMe;
+	int numThreads;
+	vector <TaskRange> ranges;
+
+	// the next thread number to hand out to a worker, and the number of workers that are
+	// running this batch's tasks; these are protected by the pool's lock
+	int nextThread = 1;
+	int numWorking = 0;
+};
+
+// gets a task for the given thread to run; returns false if there are none left to start
+static bool getTask (TaskBatch &batch, int me, size_t &whichTask) {
+
+	TaskRange &mine = batch.ranges[me];
+	{
+		lock_guard <mutex> guard (mine.lock);
+		if (mine.first < mine.last) {
+			whichTask = mine.first++;
+			return true;
+		}
+	}
+
+	// we are out, so steal half of what someone else has left
+	for (int i = 1; i < batch.numThreads; i++) {
+
+		TaskRange &victim = batch.ranges[(me + i) % batch.numThreads];
+		size_t first, last;
+		{
+			lock_guard <mutex> guard (victim.lock);
+			if (victim.first == victim.last)
+				continue;
+			first = victim.last - (victim.last - victim.first + 1) / 2;
+			last = victim.last;
+			victim.last = first;
+		}
+
+		// run the first of them now, and keep the rest (someone may steal them back)
+		lock_guard <mutex> guard (mine.lock);
+		mine.first = first + 1;
+		mine.last = last;
+		whichTask = first;
+		return true;
+	}
+
+	return false;
+}
+
+// runs tasks as the given thread, until there are none left to start
+static void runTasks (TaskBatch &batch, int me) {
+	size_t whichTask;
+	while (getTask (batch, me, whichTask))
+		batch.runMe (me, whichTask);
+}
+
+// the worker threads, along with the batches that they can work on
+class WorkerPool {
+
+public:
+
+	WorkerPool () {
+		done = false;
+		maxThreads = thread :: hardware_concurrency ();
+		if (maxThreads < 1)
+			maxThreads = 1;
+	}
+
+	// tells the workers to stop, and waits for them
+	~WorkerPool () {
+		{
+			lock_guard <mutex> guard (lock);
+			done = true;
+		}
+		hasWork.notify_all ();
+		for (auto &w : workers)
+			w.join ();
+	}
+
+	// makes sure that there are at least this many workers; the caller has the lock
+	void addWorkers (int numWorkers) {
+		while ((int) workers.size () < numWorkers)
+			workers.push_back (thread ([this] {work ();}));
+	}
+
+	// what each worker does: it joins any batch that can use another thread, until it is told to stop
+	void work () {
+
+		unique_lock <mutex> guard (lock);
+		while (true) {
+
+			TaskBatch *batch = nullptr;
+			for (TaskBatch *b : batches) {
+				if (b->nextThread < b->numThreads) {
+					batch = b;
+					break;
+				}
+			}
+
+			if (batch == nullptr) {
+				if (done)
+					return;
+				hasWork.wait (guard);
+				continue;
+			}
+
+			int me = batch->nextThread++;
+			batch->numWorking++;
+			guard.unlock ();
+			runTasks (*batch, me);
+			guard.lock ();
+			if (--batch->numWorking == 0)
+				batchDone.notify_all ();
+		}
+	}
+
+	mutex lock;
+	condition_variable hasWork;
+	condition_variable batchDone;
+	list <TaskBatch *> batches;
+	vector <thread> workers;
+	bool done;
+	atomic <int> maxThreads;
+};
+
+static WorkerPool &getPool () {
+	static WorkerPool pool;
+	return pool;
+}
+
+void TaskScheduler :: run (size_t numTasks, int numThreads, function <void (int, size_t)> runMe) {
+
+	// there is no point in having more threads than tasks
+	if ((size_t) numThreads > numTasks)
+		numThreads = (int) numTasks;
+
+	if (numThreads <= 1) {
+		for (size_t i = 0; i < numTasks; i++)
+			runMe (0, i);
+		return;
+	}
+
+	// let the workers know about the batch
+	TaskBatch batch (numTasks, numThreads, runMe);
+	WorkerPool &pool = getPool ();
+	unique_lock <mutex> guard (pool.lock);
+	pool.addWorkers (numThreads - 1);
+	pool.batches.push_back (&batch);
+	guard.unlock ();
+	pool.hasWork.notify_all ();
+
+	// the calling thread is thread 0
+	runTasks (batch, 0);
+
+	// at this point, every task has been started, so no one else needs to join the batch... we just
+	// wait for the workers that are still running tasks
+	guard.lock ();
+	pool.batches.remove (&batch);
+	pool.batchDone.wait (guard, [&batch] {return batch.numWorking == 0;});
+}
+
+void TaskScheduler :: run (size_t numTasks, function <void (int, size_t)> runMe) {
+	run (numTasks, getMaxThreads (), runMe);
+}
+
+int TaskScheduler :: getMaxThreads () {
+	return getPool ().maxThreads;
+}
+
+void TaskScheduler :: setMaxThreads (int maxThreads) {
+	getPool ().maxThreads = maxThreads < 1 ? 1 : maxThreads;
+}
+
+#endif
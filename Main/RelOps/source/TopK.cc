@@ -0,0 +1,157 @@
+
+#ifndef TOP_K_C
+#define TOP_K_C
+
+#include <algorithm>
+#include <queue>
+#include "RecordComparator.h"
+#include "Sorting.h"
+#include "TopK.h"
+
+TopK :: TopK (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+	vector <pair <string, bool>> orderByIn, long limitIn) {
+
+	input = inputIn;
+	output = outputIn;
+	orderBy = orderByIn;
+	limit = limitIn;
+	runSize = input->getBufferMgr ()->getNumPages () / 2;
+}
+
+TopK :: TopK (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
+	vector <pair <string, bool>> orderByIn) : TopK (inputIn, outputIn, orderByIn, -1) {}
+
+function <bool ()> TopK :: buildOrderingComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	// build a "less than" and a "greater than" for each of the computations
+	vector <function <bool ()>> lessThans;
+	vector <function <bool ()>> greaterThans;
+	vector <bool> ascending;
+	for (auto &o : orderBy) {
+		lessThans.push_back (buildRecordComparator (lhs, rhs, o.first));
+		greaterThans.push_back (buildRecordComparator (rhs, lhs, o.first));
+		ascending.push_back (o.second);
+	}
+
+	// in the common case of one ascending key, there is nothing to do
+	if (orderBy.size () == 1 && ascending[0])
+		return lessThans[0];
+
+	// otherwise, the first computation where the two records differ decides the order
+	return [lessThans, greaterThans, ascending] {
+		for (size_t i = 0; i < lessThans.size (); i++) {
+			if (lessThans[i] ())
+				return (bool) ascending[i];
+			if (greaterThans[i] ())
+				return (bool) !ascending[i];
+		}
+		return false;
+	};
+}
+
+bool TopK :: runWithHeap () {
+
+	MyDB_RecordPtr lhs = input->getEmptyRecord ();
+	MyDB_RecordPtr rhs = input->getEmptyRecord ();
+	MyDB_RecordPtr inputRec = input->getEmptyRecord ();
+	function <bool ()> comparator = buildOrderingComparator (lhs, rhs);
+
+	// this is a max-heap, so the top of the heap is the worst of the best records found so far
+	RecordComparator myComparator (comparator, lhs, rhs);
+	priority_queue <void *, vector <void *>, RecordComparator> heap (myComparator);
+
+	// the records in the heap can use at most as much RAM as runSize pages
+	size_t bytesAllowed = ((size_t) runSize) * input->getBufferMgr ()->getPageSize ();
+	size_t bytesUsed = 0;
+	bool fits = true;
+
+	if (limit > 0) {
+		size_t maxRecs = (size_t) limit;
+		MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt ();
+		while (myIter->advance ()) {
+
+			// get the serialized version of the record
+			myIter->getCurrent (inputRec);
+			void *pos = myIter->getCurrentPointer ();
+			size_t recSize = inputRec->getBinarySize ();
+
+			// if the heap is full, see if this guy beats the worst guy in the heap
+			if (heap.size () == maxRecs) {
+				if (!myComparator (pos, heap.top ()))
+					continue;
+				void *evictMe = heap.top ();
+				heap.pop ();
+				bytesUsed -= ((char *) lhs->fromBinary (evictMe)) - ((char *) evictMe);
+				free (evictMe);
+			}
+
+			// remember this guy
+			void *copy = malloc (recSize);
+			memcpy (copy, pos, recSize);
+			heap.push (copy);
+			bytesUsed += recSize;
+
+			// see if we have run out of RAM
+			if (bytesUsed > bytesAllowed) {
+				fits = false;
+				break;
+			}
+		}
+	}
+
+	// empty out the heap; this gives the records from last to first
+	vector <void *> sorted;
+	while (heap.size () > 0) {
+		sorted.push_back (heap.top ());
+		heap.pop ();
+	}
+
+	// if we could not keep everyone in RAM, we'll have to do a real sort
+	if (fits) {
+		reverse (sorted.begin (), sorted.end ());
+		for (void *pos : sorted) {
+			lhs->fromBinary (pos);
+			output->append (lhs);
+		}
+	}
+
+	for (void *pos : sorted)
+		free (pos);
+
+	return fits;
+}
+
+void TopK :: runWithSort () {
+
+	MyDB_RecordPtr lhs = input->getEmptyRecord ();
+	MyDB_RecordPtr rhs = input->getEmptyRecord ();
+	MyDB_RecordPtr outputRec = input->getEmptyRecord ();
+	function <bool ()> comparator = buildOrderingComparator (lhs, rhs);
+
+	// if we are sorting on one ascending key, let the sort know so it can use a radix sort
+	string sortKey = "";
+	if (orderBy.size () == 1 && orderBy[0].second)
+		sortKey = orderBy[0].first;
+
+	MyDB_RecordIteratorAltPtr myIter = buildItertorOverSortedRuns (runSize, *input, comparator, lhs, rhs,
+		"bool[true]", true, sortKey);
+
+	// and write out the first limit guys
+	long numOut = 0;
+	while ((limit < 0 || numOut < limit) && myIter->advance ()) {
+		myIter->getCurrent (outputRec);
+		output->append (outputRec);
+		numOut++;
+	}
+}
+
+void TopK :: run () {
+
+	// with a limit, try to do the whole thing in RAM
+	if (limit >= 0 && runWithHeap ())
+		return;
+
+	runWithSort ();
+}
+
+#endif
@@ -26,17 +26,26 @@ public:
 	virtual bool isOr () {return false;}
 	virtual bool isComp () {return false;}
 	virtual bool isLTGT () {return false;}
+	virtual bool isLT () {return false;}
 	virtual bool isNotEq () {return false;}
 	virtual bool isSum () {return false;}
 	virtual bool isAvg () {return false;}
+	virtual bool isMin () {return false;}
+	virtual bool isMax () {return false;}
+	virtual bool isCount () {return false;}
+	virtual bool isCountDistinct () {return false;}
+	virtual bool isApproxCountDistinct () {return false;}
 	virtual string getId () {return "";}
 	virtual ExprTreePtr getLHS () {return nullptr;}
 	virtual ExprTreePtr getRHS () {return nullptr;}
 	virtual ExprTreePtr getChild () {return nullptr;}
 	virtual bool referencesTable (string alias) {return false;}
 	virtual bool referencesAtt (string alias, string attName) {return false;}
+	bool isAgg () {
+		return isSum () || isAvg () || isMin () || isMax () || isCount () || isCountDistinct () || isApproxCountDistinct ();
+	}
 	virtual bool hasAgg () {
-		if (isSum () || isAvg ())
+		if (isAgg ())
 			return true;
 		ExprTreePtr lhs = getLHS ();
 		ExprTreePtr rhs = getRHS ();
@@ -136,6 +145,11 @@ public:
 		attName = string (attNameIn);
 	}
 
+	Identifier (string tableNameIn, string attNameIn) {
+		tableName = tableNameIn;
+		attName = attNameIn;
+	}
+
 	string toString () {
 		return "[" + attName + "]";
 	}	
@@ -414,6 +428,10 @@ public:
 		return true;
 	}
 
+	bool isLT () {
+		return true;
+	}
+
 	bool isComp () {
 		return true;
 	}
@@ -698,4 +716,169 @@ public:
 	~AvgOp () {}
 };
 
+class MinOp : public ExprTree {
+
+private:
+
+	ExprTreePtr child;
+	
+public:
+
+	MinOp (ExprTreePtr childIn) {
+		child = childIn;
+	}
+
+	string toString () {
+		return "min(" + child->toString () + ")";
+	}	
+
+	bool isMin () {
+		return true;
+	}
+
+    ExprTreePtr getChild () {return child;}
+
+	bool referencesTable (string alias) {
+		return child->referencesTable (alias);
+	}
+
+	bool referencesAtt (string alias, string attNameToFind) {
+		return child->referencesAtt (alias, attNameToFind);
+	}
+
+	~MinOp () {}
+};
+
+class MaxOp : public ExprTree {
+
+private:
+
+	ExprTreePtr child;
+	
+public:
+
+	MaxOp (ExprTreePtr childIn) {
+		child = childIn;
+	}
+
+	string toString () {
+		return "max(" + child->toString () + ")";
+	}	
+
+	bool isMax () {
+		return true;
+	}
+
+    ExprTreePtr getChild () {return child;}
+
+	bool referencesTable (string alias) {
+		return child->referencesTable (alias);
+	}
+
+	bool referencesAtt (string alias, string attNameToFind) {
+		return child->referencesAtt (alias, attNameToFind);
+	}
+
+	~MaxOp () {}
+};
+
+class CountOp : public ExprTree {
+
+private:
+
+	ExprTreePtr child;
+	
+public:
+
+	CountOp (ExprTreePtr childIn) {
+		child = childIn;
+	}
+
+	string toString () {
+		return "count(" + child->toString () + ")";
+	}	
+
+	bool isCount () {
+		return true;
+	}
+
+    ExprTreePtr getChild () {return child;}
+
+	bool referencesTable (string alias) {
+		return child->referencesTable (alias);
+	}
+
+	bool referencesAtt (string alias, string attNameToFind) {
+		return child->referencesAtt (alias, attNameToFind);
+	}
+
+	~CountOp () {}
+};
+
+class CountDistinctOp : public ExprTree {
+
+private:
+
+	ExprTreePtr child;
+	
+public:
+
+	CountDistinctOp (ExprTreePtr childIn) {
+		child = childIn;
+	}
+
+	string toString () {
+		return "count(distinct " + child->toString () + ")";
+	}	
+
+	bool isCountDistinct () {
+		return true;
+	}
+
+    ExprTreePtr getChild () {return child;}
+
+	bool referencesTable (string alias) {
+		return child->referencesTable (alias);
+	}
+
+	bool referencesAtt (string alias, string attNameToFind) {
+		return child->referencesAtt (alias, attNameToFind);
+	}
+
+	~CountDistinctOp () {}
+};
+
+class ApproxCountDistinctOp : public ExprTree {
+
+private:
+
+	ExprTreePtr child;
+	
+public:
+
+	ApproxCountDistinctOp (ExprTreePtr childIn) {
+		child = childIn;
+	}
+
+	string toString () {
+		return "approx_count_distinct(" + child->toString () + ")";
+	}	
+
+	bool isApproxCountDistinct () {
+		return true;
+	}
+
+    ExprTreePtr getChild () {return child;}
+
+	bool referencesTable (string alias) {
+		return child->referencesTable (alias);
+	}
+
+	bool referencesAtt (string alias, string attNameToFind) {
+		return child->referencesAtt (alias, attNameToFind);
+	}
+
+	~ApproxCountDistinctOp () {}
+};
+
 #endif
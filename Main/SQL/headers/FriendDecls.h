@@ -2,6 +2,8 @@ friend struct SFWQuery *makeQueryWithGroupBy (struct ValueList *selectClause, st
 	struct CNF *cnf, struct ValueList *grouping);
 friend struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fromClause, struct CNF *cnf);
 friend struct SFWQuery *makeQueryNoWhere (struct ValueList *selectClause, struct FromList *fromClause);
+friend struct SFWQuery *addOrderBy (struct SFWQuery *addToMe, struct OrderList *orderBy);
+friend struct SFWQuery *addLimit (struct SFWQuery *addToMe, int limit);
 friend struct SQLStatement *makeSelectQuery (struct SFWQuery *fromMe);
 friend struct SQLStatement *makeCreateTable (struct CreateTable *fromMe);
 friend struct CreateTable *makeTableRegular (char *tableName, struct AttList *fromMe);
@@ -18,6 +20,11 @@ friend struct Value *neq (struct Value *lhs, struct Value *rhs);
 friend struct Value *eq (struct Value *lhs, struct Value *rhs);
 friend struct Value *sum (struct Value *ofMe);
 friend struct Value *avg (struct Value *ofMe);
+friend struct Value *minn (struct Value *ofMe);
+friend struct Value *maxx (struct Value *ofMe);
+friend struct Value *count (struct Value *ofMe);
+friend struct Value *countDistinct (struct Value *ofMe);
+friend struct Value *approxCountDistinct (struct Value *ofMe);
 friend struct Value *times (struct Value *lhs, struct Value *rhs);
 friend struct Value *plus (struct Value *lhs, struct Value *rhs);
 friend struct Value *divide (struct Value *lhs, struct Value *rhs);
@@ -31,3 +38,5 @@ friend struct ValueList *pushBackValue (struct ValueList *addToMe, struct Value
 friend struct ValueList *makeValueList (struct Value *addMe);
 friend struct CNF *makeCNF (struct Value *fromMe);
 friend struct CNF *pushBackDisjunction (struct CNF *ontoMe, struct Value *pushMe);
+friend struct OrderList *makeOrderList (struct Value *addMe, int ascending);
+friend struct OrderList *pushBackOrder (struct OrderList *addToMe, struct Value *addMe, int ascending);
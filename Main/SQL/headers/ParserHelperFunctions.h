@@ -40,6 +40,9 @@ struct AttList;
 // this is a set of table name, alias name pairs
 struct FromList;
 
+// a list of values to sort on, each with a direction... used to hold an ORDER BY clause
+struct OrderList;
+
 /******************************************************/
 // C FUNCTIONS TO MANIPULATE THE VARIOUS STRUCTURES
 /******************************************************/
@@ -50,6 +53,10 @@ struct SFWQuery *makeQueryWithGroupBy (struct ValueList *selectClause, struct Fr
 struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fromClause, struct CNF *cnf);
 struct SFWQuery *makeQueryNoWhere (struct ValueList *selectClause, struct FromList *fromClause);
 
+// add an ORDER BY or a LIMIT to a select query
+struct SFWQuery *addOrderBy (struct SFWQuery *addToMe, struct OrderList *orderBy);
+struct SFWQuery *addLimit (struct SFWQuery *addToMe, int limit);
+
 // builds an SQL statement out of a select query
 struct SQLStatement *makeSelectQuery (struct SFWQuery *fromMe);
 
@@ -87,6 +94,11 @@ struct Value *eq (struct Value *lhs, struct Value *rhs);
 // construct a new value using an aggregate function
 struct Value *sum (struct Value *ofMe);
 struct Value *avg (struct Value *ofMe);
+struct Value *minn (struct Value *ofMe);
+struct Value *maxx (struct Value *ofMe);
+struct Value *count (struct Value *ofMe);
+struct Value *countDistinct (struct Value *ofMe);
+struct Value *approxCountDistinct (struct Value *ofMe);
 
 // construct a new value using a binary arithmatic operation
 struct Value *times (struct Value *lhs, struct Value *rhs);
@@ -112,6 +124,12 @@ struct ValueList *makeValueList (struct Value *addMe);
 // makes a new CNF from a expression (hopefully a boolean!!)
 struct CNF *makeCNF (struct Value *fromMe);
 
+// makes a new ORDER BY list from a value; ascending is 1 if we sort ascending, 0 if descending
+struct OrderList *makeOrderList (struct Value *addMe, int ascending);
+
+// adds a new value to an ORDER BY list
+struct OrderList *pushBackOrder (struct OrderList *addToMe, struct Value *addMe, int ascending);
+
 // push a new CNF onto the back
 struct CNF *pushBackDisjunction (struct CNF *ontoMe, struct Value *pushMe);
 
@@ -40,6 +40,7 @@ public:
 	
 	friend struct CNF;
 	friend struct ValueList;
+	friend struct OrderList;
 	friend struct SFWQuery;
 	#include "FriendDecls.h"
 };
@@ -87,6 +88,27 @@ public:
 };
 
 
+// structure that encapsulates a parsed ORDER BY list
+struct OrderList {
+
+private:
+
+        // the values to sort on, each with a bool that is true if the sort is ascending
+        vector <pair <ExprTreePtr, bool>> valuesToSortOn;
+
+public:
+        ~OrderList () {}
+
+        OrderList (struct Value *useMe, bool ascending) {
+              	valuesToSortOn.push_back (make_pair (useMe->myVal, ascending)); 
+        }
+
+        OrderList () {}
+
+	friend struct SFWQuery;
+	#include "FriendDecls.h"
+};
+
 // structure to encapsulate a create table
 struct CreateTable {
 
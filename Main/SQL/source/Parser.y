@@ -19,6 +19,7 @@
 	struct Value *myValue;
 	struct ValueList *allValues;
 	struct CNF *myCNF;	
+	struct OrderList *myOrderList;
 	int myInt;
 	char *myChar;
 	double myDouble;
@@ -43,6 +44,11 @@
 %token NOT
 %token SUM
 %token AVG
+%token MIN
+%token MAX
+%token COUNT
+%token DISTINCT
+%token APPROX_COUNT_DISTINCT
 %token GROUP
 %token INT
 %token BOOL
@@ -52,6 +58,10 @@
 %token STRING
 %token ON
 %token TABLE
+%token ORDER
+%token LIMIT
+%token ASC
+%token DESC
 
 %type <myValue> Value
 %type <myValue> MultExp
@@ -66,6 +76,8 @@
 %type <myAttList> Att
 %type <myFromList> FromList
 %type <mySelectQuery> SelectQuery 
+%type <mySelectQuery> SelectFromWhere
+%type <myOrderList> OrderList
 
 %start SQLStatement
 
@@ -135,9 +147,30 @@ Att : IDENTIFIER INT
 	$$ = makeAttList ($1, BOOL);
 }
 
-//********* SELECT-FROM-WHERE Query
+//********* SELECT-FROM-WHERE Query, with an optional ORDER BY and LIMIT
 
-SelectQuery: SELECT ValueList
+SelectQuery: SelectFromWhere
+{
+	$$ = $1;
+}
+
+| SelectFromWhere ORDER BY OrderList
+{
+	$$ = addOrderBy ($1, $4);
+}
+
+| SelectFromWhere ORDER BY OrderList LIMIT INTEGER
+{
+	$$ = addLimit (addOrderBy ($1, $4), $6);
+}
+
+| SelectFromWhere LIMIT INTEGER
+{
+	$$ = addLimit ($1, $3);
+}
+;
+
+SelectFromWhere: SELECT ValueList
              FROM FromList
 	     WHERE CNF
 	     GROUP BY ValueList
@@ -159,6 +192,37 @@ SelectQuery: SELECT ValueList
 }
 ;
 
+OrderList: OrderList ',' Value
+{
+	$$ = pushBackOrder ($1, $3, 1);
+}
+
+| OrderList ',' Value ASC
+{
+	$$ = pushBackOrder ($1, $3, 1);
+}
+
+| OrderList ',' Value DESC
+{
+	$$ = pushBackOrder ($1, $3, 0);
+}
+
+| Value
+{
+	$$ = makeOrderList ($1, 1);
+}
+
+| Value ASC
+{
+	$$ = makeOrderList ($1, 1);
+}
+
+| Value DESC
+{
+	$$ = makeOrderList ($1, 0);
+}
+;
+
 FromList: IDENTIFIER AS IDENTIFIER ',' FromList
 {
 	$$ = appendFromList ($5, $1, $3);
@@ -263,6 +327,31 @@ Value: MultExp '+' Value
 {
 	$$ = avg ($3);
 }
+
+| MIN '(' Value ')'
+{
+	$$ = minn ($3);
+}
+
+| MAX '(' Value ')'
+{
+	$$ = maxx ($3);
+}
+
+| COUNT '(' Value ')'
+{
+	$$ = count ($3);
+}
+
+| COUNT '(' DISTINCT Value ')'
+{
+	$$ = countDistinct ($4);
+}
+
+| APPROX_COUNT_DISTINCT '(' Value ')'
+{
+	$$ = approxCountDistinct ($3);
+}
 ;
 
 MultExp: Literal '*' MultExp
@@ -67,6 +67,18 @@ struct ValueList *pushBackValue (struct ValueList *ontoMe, struct Value *withMe)
 	return ontoMe;
 }
 
+struct OrderList *makeOrderList (struct Value *fromMe, int ascending) {
+	auto returnVal = new OrderList (fromMe, ascending != 0);
+	delete fromMe;
+	return returnVal;
+}
+
+struct OrderList *pushBackOrder (struct OrderList *ontoMe, struct Value *withMe, int ascending) {
+	ontoMe->valuesToSortOn.push_back (make_pair (withMe->myVal, ascending != 0));
+	delete withMe;
+	return ontoMe;
+}
+
 struct CNF *pushBackDisjunction (struct CNF *ontoMe, struct Value *withMe) {
 	ontoMe->disjunctions.push_back (withMe->myVal);
 	delete withMe;
@@ -129,6 +141,31 @@ struct Value *avg (struct Value *ofMe) {
 	return ofMe;
 }
 
+struct Value *minn (struct Value *ofMe) {
+	ofMe->myVal = make_shared <MinOp> (ofMe->myVal);
+	return ofMe;
+}
+
+struct Value *maxx (struct Value *ofMe) {
+	ofMe->myVal = make_shared <MaxOp> (ofMe->myVal);
+	return ofMe;
+}
+
+struct Value *count (struct Value *ofMe) {
+	ofMe->myVal = make_shared <CountOp> (ofMe->myVal);
+	return ofMe;
+}
+
+struct Value *countDistinct (struct Value *ofMe) {
+	ofMe->myVal = make_shared <CountDistinctOp> (ofMe->myVal);
+	return ofMe;
+}
+
+struct Value *approxCountDistinct (struct Value *ofMe) {
+	ofMe->myVal = make_shared <ApproxCountDistinctOp> (ofMe->myVal);
+	return ofMe;
+}
+
 struct Value *nott (struct Value *ofMe) {
 	ofMe->myVal = make_shared <NotOp> (ofMe->myVal);		
 	return ofMe;
@@ -207,6 +244,17 @@ struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fro
 	return returnVal;
 }
 
+struct SFWQuery *addOrderBy (struct SFWQuery *addToMe, struct OrderList *orderBy) {
+	addToMe->orderingClauses = orderBy->valuesToSortOn;
+	delete orderBy;
+	return addToMe;
+}
+
+struct SFWQuery *addLimit (struct SFWQuery *addToMe, int limit) {
+	addToMe->limit = limit;
+	return addToMe;
+}
+
 struct CreateTable *makeTableRegular (char *tableName, struct AttList *fromMe) {
 	auto returnVal = new CreateTable (string (tableName), fromMe->atts);
 	free (tableName);
@@ -0,0 +1,187 @@
+
+
+#ifndef SCHEDULER_TEST_H
+#define SCHEDULER_TEST_H
+
+#include "QUnit.h"
+#include "TaskScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// how the cost of the tasks in a batch is skewed
+enum Skew {NoSkew, FirstTasksSlow, LastTasksSlow, OneTaskSlow};
+
+// how long, in microseconds, the given task takes
+int getCost (Skew skew, size_t whichTask, size_t numTasks) {
+	if (skew == FirstTasksSlow && whichTask < numTasks / 8)
+		return 2000;
+	if (skew == LastTasksSlow && whichTask >= numTasks - numTasks / 8)
+		return 2000;
+	if (skew == OneTaskSlow && whichTask == numTasks / 2)
+		return 50000;
+	return 10;
+}
+
+// runs a batch of tasks and checks it: every task has to run exactly once, whichThread has to be less than
+// numThreads and can never be used by two tasks at the same time, and all of the tasks have to be done by
+// the time that run () returns; returns true if all of this is OK
+bool runBatch (size_t numTasks, int numThreads, Skew skew) {
+
+	vector <atomic <int>> timesRun (numTasks);
+	for (auto &t : timesRun)
+		t = 0;
+	vector <atomic <int>> running (numThreads);
+	for (auto &r : running)
+		r = 0;
+	atomic <size_t> numDone (0);
+	atomic <int> numBad (0);
+
+	TaskScheduler :: run (numTasks, numThreads, [&] (int whichThread, size_t whichTask) {
+		if (whichThread < 0 || whichThread >= numThreads || running[whichThread]++ != 0) {
+			numBad++;
+			return;
+		}
+		this_thread :: sleep_for (chrono :: microseconds (getCost (skew, whichTask, numTasks)));
+		timesRun[whichTask]++;
+		running[whichThread]--;
+		numDone++;
+	});
+
+	// nothing can still be running at this point
+	if (numDone != numTasks)
+		return false;
+
+	for (auto &t : timesRun)
+		if (t != 1)
+			return false;
+
+	return numBad == 0;
+}
+
+int main (int argc, char *argv[]) {
+
+	int start = 1;
+	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
+		start = argv[1][0] - '0';
+	}
+
+	QUnit::UnitTest qunit(cerr, QUnit::normal);
+	int countCorrect;
+
+	switch (start) {
+	case 1:
+	cout << endl << "Test 1: Run batches:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Equal tasks.." << flush;
+	{
+		int numOK = 0;
+		for (int numThreads : {1, 2, 3, 4, 8})
+			for (size_t numTasks : {0, 1, 3, 100, 10000})
+				numOK += runBatch (numTasks, numThreads, NoSkew);
+		if (numOK == 25)
+			countCorrect++;
+	}
+
+	cout << "Skewed tasks.." << endl << flush;
+	{
+		// the slow tasks are all handed to the same thread at first, so the other threads have to steal them
+		int numOK = 0;
+		for (int numThreads : {2, 3, 4, 8})
+			for (Skew skew : {FirstTasksSlow, LastTasksSlow, OneTaskSlow})
+				numOK += runBatch (200, numThreads, skew);
+		if (numOK == 12)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 2:
+	cout << endl << "Test 2: Limit the number of threads:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Use the default limit.." << endl << flush;
+	{
+		int oldMax = TaskScheduler :: getMaxThreads ();
+		TaskScheduler :: setMaxThreads (3);
+		atomic <int> numBad (0);
+		TaskScheduler :: run (1000, [&] (int whichThread, size_t) {
+			if (whichThread < 0 || whichThread >= 3)
+				numBad++;
+		});
+		if (TaskScheduler :: getMaxThreads () == 3 && numBad == 0)
+			countCorrect++;
+
+		// the limit is never less than one
+		TaskScheduler :: setMaxThreads (0);
+		if (TaskScheduler :: getMaxThreads () == 1)
+			countCorrect++;
+		TaskScheduler :: setMaxThreads (oldMax);
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 3:
+	cout << endl << "Test 3: Run batches at the same time:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Two callers.." << flush;
+	{
+		// each caller's batches have to finish, even while the workers are busy with the other's
+		atomic <int> numOK (0);
+		auto caller = [&numOK] (Skew skew) {
+			for (int i = 0; i < 20; i++)
+				numOK += runBatch (100, 4, skew);
+		};
+		thread first (caller, FirstTasksSlow);
+		thread second (caller, LastTasksSlow);
+		first.join ();
+		second.join ();
+		if (numOK == 40)
+			countCorrect++;
+	}
+
+	cout << "Batches within a batch.." << endl << flush;
+	{
+		// a task that runs its own batch is the calling thread for that batch, so it always finishes
+		atomic <int> numOK (0);
+		TaskScheduler :: run (8, 4, [&numOK] (int, size_t) {
+			numOK += runBatch (50, 3, OneTaskSlow);
+		});
+		if (numOK == 8)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+	default:
+		break;
+	}
+}
+
+#endif
@@ -1045,6 +1045,238 @@ int main (int argc, char *argv[]) {
 		cout << endl << endl << "***FAIL****" << endl << endl << flush;
 	}		
 	
+	case 11:
+	cout << endl << "Test 11: Sort using replacement selection:" << endl << flush;
+	countCorrect = 0;		
+	cout << "Sort a table.."  << flush;
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+
+		// use the schema to create a table
+		MyDB_TablePtr outTable = make_shared <MyDB_Table> ("supplierSortedRS", "supplierSortedRS.bin", allTables["supplier"]->getSchema ());
+		MyDB_TableReaderWriter outputTable (outTable, myMgr);
+
+		// get two empty records
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+
+		// and get a comparator
+		function <bool ()> myComp = buildRecordComparator (rec1, rec2, "[acctbal]");
+
+		// and sort, generating the runs via replacement selection
+		MyDB_RecordIteratorAltPtr sortIter = buildItertorOverSortedRuns (7, supplierTable, myComp, rec1, rec2, "bool[true]", true);
+		while (sortIter->advance ()) {
+			sortIter->getCurrent (rec1);
+			outputTable.append (rec1);
+		}
+
+		MyDB_RecordIteratorAltPtr myIter = outputTable.getIteratorAlt ();
+
+		// there should be 320000 records
+		int counter = 0;
+		while (myIter->advance ()) {
+			myIter->getCurrent (rec1);
+			counter++;
+		}
+
+		//Check?
+		if (counter == 320000) {
+			countCorrect++;
+		}
+		
+		// put the supplier table into the catalog
+		outTable->putInCatalog (myCatalog);
+	}	
+	
+	cout << "Compare Sorted Table.." << endl << flush;
+	{
+		// load up the two tables from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSortedRS"], myMgr);
+		MyDB_TableReaderWriter otherSortedTable (allTables["supplier"], myMgr);
+
+		// load up the sorted text file
+		otherSortedTable.loadFromTextFile ("supplierBigSorted.tbl");
+
+		// get two empty records
+		MyDB_RecordPtr rec1 = sortedTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = otherSortedTable.getEmptyRecord ();
+
+		// and get a comparator
+		function <bool ()> myComp = buildRecordComparator (rec1, rec2, "[acctbal]");
+
+		// get two iterators
+		MyDB_RecordIteratorAltPtr myIterOne = sortedTable.getIteratorAlt ();
+		MyDB_RecordIteratorAltPtr myIterTwo = otherSortedTable.getIteratorAlt ();
+
+		// make sure the results are the same
+		int matches = 0;
+        while (myIterOne->advance ()) {
+			myIterTwo->advance ();
+
+			// get the two records
+			myIterOne->getCurrent (rec1);
+			myIterTwo->getCurrent (rec2);
+
+			if (!myComp ()) {
+				myIterOne->getCurrent (rec2);
+				myIterTwo->getCurrent (rec1);
+				if (!myComp ())
+					matches++;
+			}
+        }
+
+		//Check?
+		if (matches == 320000) {
+			countCorrect++;
+		}
+	}	
+	
+	cout << "Count Runs on Sorted Input.." << endl << flush;
+	{
+		// load the sorted text file into its own table
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TablePtr sortedTable = make_shared <MyDB_Table> ("supplierPreSorted", "supplierPreSorted.bin", allTables["supplier"]->getSchema ());
+		MyDB_TableReaderWriter preSortedTable (sortedTable, myMgr);
+		preSortedTable.loadFromTextFile ("supplierBigSorted.tbl");
+
+		// get two empty records
+		MyDB_RecordPtr rec1 = preSortedTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = preSortedTable.getEmptyRecord ();
+
+		// and get a comparator
+		function <bool ()> myComp = buildRecordComparator (rec1, rec2, "[acctbal]");
+
+		// the input is already in order, so replacement selection should never have to start a new
+		// run, while fixed-size runs give one run for every 7 pages
+		size_t fixedRuns = buildSortedRuns (7, preSortedTable, myComp, rec1, rec2, "bool[true]", false).size ();
+		size_t rsRuns = buildSortedRuns (7, preSortedTable, myComp, rec1, rec2, "bool[true]", true).size ();
+		cout << "fixed-size runs: " << fixedRuns << ", replacement selection runs: " << rsRuns << endl << flush;
+
+		//Check?
+		QUNIT_IS_TRUE (rsRuns < fixedRuns);
+		if (rsRuns < fixedRuns) {
+			countCorrect++;
+		}
+	}	
+	
+	QUNIT_IS_EQUAL (countCorrect, 3);
+	if (countCorrect == 3) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}		
+	
+	case 12:
+	cout << endl << "Test 12: Sort using a radix sort on the key:" << endl << flush;
+	countCorrect = 0;		
+	cout << "Sort a table.."  << flush;
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+
+		// use the schema to create a table
+		MyDB_TablePtr outTable = make_shared <MyDB_Table> ("supplierSortedRadix", "supplierSortedRadix.bin", allTables["supplier"]->getSchema ());
+		MyDB_TableReaderWriter outputTable (outTable, myMgr);
+
+		// get two empty records
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+
+		// and get a comparator
+		function <bool ()> myComp = buildRecordComparator (rec1, rec2, "[acctbal]");
+
+		// and sort, giving the key so that the pages are radix sorted
+		MyDB_RecordIteratorAltPtr sortIter = buildItertorOverSortedRuns (7, supplierTable, myComp, rec1, rec2, "bool[true]", false, "[acctbal]");
+		while (sortIter->advance ()) {
+			sortIter->getCurrent (rec1);
+			outputTable.append (rec1);
+		}
+
+		MyDB_RecordIteratorAltPtr myIter = outputTable.getIteratorAlt ();
+
+		// there should be 320000 records
+		int counter = 0;
+		while (myIter->advance ()) {
+			myIter->getCurrent (rec1);
+			counter++;
+		}
+
+		//Check?
+		if (counter == 320000) {
+			countCorrect++;
+		}
+		
+		// put the supplier table into the catalog
+		outTable->putInCatalog (myCatalog);
+	}	
+	
+	cout << "Compare Sorted Table.." << endl << flush;
+	{
+		// load up the two tables from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSortedRadix"], myMgr);
+		MyDB_TableReaderWriter otherSortedTable (allTables["supplier"], myMgr);
+
+		// load up the sorted text file
+		otherSortedTable.loadFromTextFile ("supplierBigSorted.tbl");
+
+		// get two empty records
+		MyDB_RecordPtr rec1 = sortedTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = otherSortedTable.getEmptyRecord ();
+
+		// and get a comparator
+		function <bool ()> myComp = buildRecordComparator (rec1, rec2, "[acctbal]");
+
+		// get two iterators
+		MyDB_RecordIteratorAltPtr myIterOne = sortedTable.getIteratorAlt ();
+		MyDB_RecordIteratorAltPtr myIterTwo = otherSortedTable.getIteratorAlt ();
+
+		// make sure the results are the same
+		int matches = 0;
+        while (myIterOne->advance ()) {
+			myIterTwo->advance ();
+
+			// get the two records
+			myIterOne->getCurrent (rec1);
+			myIterTwo->getCurrent (rec2);
+
+			if (!myComp ()) {
+				myIterOne->getCurrent (rec2);
+				myIterTwo->getCurrent (rec1);
+				if (!myComp ())
+					matches++;
+			}
+        }
+
+		//Check?
+		if (matches == 320000) {
+			countCorrect++;
+		}
+	}	
+	
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}		
+	
 	default:
 		break;
   }
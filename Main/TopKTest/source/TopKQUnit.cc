@@ -0,0 +1,220 @@
+
+#ifndef TOP_K_TEST_H
+#define TOP_K_TEST_H
+
+#include "MyDB_AttType.h"
+#include "MyDB_BufferManager.h"
+#include "MyDB_Record.h"
+#include "MyDB_Table.h"
+#include "MyDB_TableReaderWriter.h"
+#include "MyDB_Schema.h"
+#include "QUnit.h"
+#include "TopK.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Each of the tests below runs a TopK over a table, and checks that the records come out in exactly
+// the same order as they do when the generated records are put through std::sort.
+
+// one of the records in the test table
+struct TestRec {
+	int key;
+	double score;
+	int id;
+};
+
+// writes a text file for a table with four atts: a key (from 0 up to 9), a score (from 0 up to 99.5),
+// a unique id, and some padding so that there are not too many records on a page; returns the records,
+// so that the output can be checked
+vector <TestRec> makeTable (string fileName, int numRecs, int seed) {
+	srand (seed);
+	vector <TestRec> allRecs;
+	ofstream out (fileName);
+	for (int i = 0; i < numRecs; i++) {
+		TestRec rec;
+		rec.key = rand () % 10;
+		rec.score = (rand () % 200) / 2.0;
+		rec.id = i;
+		allRecs.push_back (rec);
+		out << rec.key << "|" << rec.score << "|" << rec.id << "|padding" << string (40, 'x') << "|\n";
+	}
+	return allRecs;
+}
+
+// runs a TopK over the table, with a buffer pool of the given number of pages, and returns the ids of
+// the records that it wrote out, in order
+vector <int> runTopK (string fileName, int numPages, vector <pair <string, bool>> orderBy, long limit) {
+
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair ("t_key", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("t_score", make_shared <MyDB_DoubleAttType> ()));
+	mySchema->appendAtt (make_pair ("t_id", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("t_pad", make_shared <MyDB_StringAttType> ()));
+
+	MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (1024, numPages, "tempFile");
+	MyDB_TableReaderWriterPtr inTable = make_shared <MyDB_TableReaderWriter> (
+		make_shared <MyDB_Table> ("topKIn", "topKIn.bin", mySchema), myMgr);
+	inTable->loadFromTextFile (fileName);
+	MyDB_TableReaderWriterPtr outTable = make_shared <MyDB_TableReaderWriter> (
+		make_shared <MyDB_Table> ("topKOut", "topKOut.bin", mySchema), myMgr);
+
+	if (limit < 0) {
+		TopK myOp (inTable, outTable, orderBy);
+		myOp.run ();
+	} else {
+		TopK myOp (inTable, outTable, orderBy, limit);
+		myOp.run ();
+	}
+
+	vector <int> ids;
+	MyDB_RecordPtr rec = outTable->getEmptyRecord ();
+	MyDB_RecordIteratorAltPtr myIter = outTable->getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (rec);
+		ids.push_back (rec->getAtt (2)->toInt ());
+	}
+	return ids;
+}
+
+// sorts the records with the given comparator, and returns the ids of the first limit of them (or all of
+// them, if limit is negative)
+vector <int> getExpected (vector <TestRec> allRecs, function <bool (const TestRec &, const TestRec &)> comp,
+	long limit) {
+
+	sort (allRecs.begin (), allRecs.end (), comp);
+	vector <int> ids;
+	for (TestRec &rec : allRecs) {
+		if (limit >= 0 && (long) ids.size () >= limit)
+			break;
+		ids.push_back (rec.id);
+	}
+	return ids;
+}
+
+int main (int argc, char *argv[]) {
+
+	int start = 1;
+	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
+		start = argv[1][0] - '0';
+	}
+
+	QUnit::UnitTest qunit(cerr, QUnit::normal);
+	int countCorrect;
+
+	vector <TestRec> allRecs = makeTable ("topKIn.tbl", 5000, 1);
+
+	// ORDER BY key ASC, score DESC, id ASC... the id breaks all of the ties, so there is only one right order
+	vector <pair <string, bool>> mixedOrder;
+	mixedOrder.push_back (make_pair (string ("[t_key]"), true));
+	mixedOrder.push_back (make_pair (string ("[t_score]"), false));
+	mixedOrder.push_back (make_pair (string ("[t_id]"), true));
+	auto mixedComp = [] (const TestRec &lhs, const TestRec &rhs) {
+		if (lhs.key != rhs.key)
+			return lhs.key < rhs.key;
+		if (lhs.score != rhs.score)
+			return lhs.score > rhs.score;
+		return lhs.id < rhs.id;
+	};
+
+	switch (start) {
+	case 1:
+	cout << endl << "Test 1: ORDER BY on several keys:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "No limit.." << flush;
+	if (runTopK ("topKIn.tbl", 16, mixedOrder, -1) == getExpected (allRecs, mixedComp, -1))
+		countCorrect++;
+
+	cout << "Limit that fits in RAM.." << flush;
+	if (runTopK ("topKIn.tbl", 16, mixedOrder, 25) == getExpected (allRecs, mixedComp, 25))
+		countCorrect++;
+
+	cout << "Limit that does not fit in RAM.." << endl << flush;
+	{
+		// a thousand records are a lot more than 8 pages, so the heap gives up and the table is sorted
+		vector <int> expected = getExpected (allRecs, mixedComp, 1000);
+		if (expected.size () == 1000 && runTopK ("topKIn.tbl", 16, mixedOrder, 1000) == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 3);
+	if (countCorrect == 3) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 2:
+	cout << endl << "Test 2: ORDER BY on one key:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "Ascending.." << flush;
+	{
+		// this is the case that gets the radix sort
+		vector <pair <string, bool>> idOrder;
+		idOrder.push_back (make_pair (string ("[t_id]"), true));
+		auto idComp = [] (const TestRec &lhs, const TestRec &rhs) {
+			return lhs.id < rhs.id;
+		};
+		if (runTopK ("topKIn.tbl", 16, idOrder, -1) == getExpected (allRecs, idComp, -1))
+			countCorrect++;
+	}
+
+	cout << "Descending.." << endl << flush;
+	{
+		vector <pair <string, bool>> idOrder;
+		idOrder.push_back (make_pair (string ("- (int[0], [t_id])"), false));
+		auto idComp = [] (const TestRec &lhs, const TestRec &rhs) {
+			return lhs.id < rhs.id;
+		};
+		if (runTopK ("topKIn.tbl", 16, idOrder, 40) == getExpected (allRecs, idComp, 40))
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+
+	case 3:
+	cout << endl << "Test 3: Unusual limits:" << endl << flush;
+	countCorrect = 0;
+
+	cout << "LIMIT 0.." << flush;
+	if (runTopK ("topKIn.tbl", 16, mixedOrder, 0).size () == 0)
+		countCorrect++;
+
+	cout << "LIMIT bigger than the input.." << endl << flush;
+	{
+		// this is done with a big pool, so that the heap holds all of the records
+		vector <int> expected = getExpected (allRecs, mixedComp, 100000);
+		if (expected.size () == allRecs.size () && runTopK ("topKIn.tbl", 2048, mixedOrder, 100000) == expected)
+			countCorrect++;
+	}
+
+	QUNIT_IS_EQUAL (countCorrect, 2);
+	if (countCorrect == 2) {
+		cout << "PASS" << endl << flush;
+	}
+	else {
+		cout << endl << endl << "***FAIL****" << endl << endl << flush;
+	}
+
+	default:
+		break;
+	}
+}
+
+#endif